@@ -0,0 +1,85 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "arena.h"
+
+Arena::Arena()
+	: _blocksCount(0), _currentBlock(0) {
+	memset(_blocks, 0, sizeof(_blocks));
+}
+
+Arena::~Arena() {
+	for (int i = 0; i < _blocksCount; ++i) {
+		free(_blocks[i].data);
+	}
+}
+
+void *Arena::allocate(uint32_t size) {
+	size = (size + 7) & ~7;
+	while (_currentBlock < _blocksCount) {
+		Block *b = &_blocks[_currentBlock];
+		if (b->used + size <= b->size) {
+			void *p = b->data + b->used;
+			b->used += size;
+			return p;
+		}
+		if (_currentBlock + 1 < _blocksCount && _blocks[_currentBlock + 1].size < size) {
+			// the next block is unused and too small, replace it
+			Block *next = &_blocks[_currentBlock + 1];
+			free(next->data);
+			next->data = (uint8_t *)malloc(size);
+			if (!next->data) {
+				error("Unable to allocate arena block (%d bytes)", size);
+			}
+			next->size = size;
+		}
+		if (_currentBlock + 1 == _blocksCount) {
+			break;
+		}
+		++_currentBlock;
+		_blocks[_currentBlock].used = 0;
+	}
+	if (_blocksCount >= kMaxBlocks) {
+		error("Arena blocks table is full");
+	}
+	Block *b = &_blocks[_blocksCount];
+	b->size = MAX((uint32_t)kBlockSize, size);
+	b->data = (uint8_t *)malloc(b->size);
+	if (!b->data) {
+		error("Unable to allocate arena block (%d bytes)", b->size);
+	}
+	b->used = size;
+	if (_blocksCount != 0) {
+		_currentBlock = _blocksCount;
+	}
+	++_blocksCount;
+	return b->data;
+}
+
+ArenaMark Arena::mark() const {
+	ArenaMark m;
+	m.block = _currentBlock;
+	m.offset = (_currentBlock < _blocksCount) ? _blocks[_currentBlock].used : 0;
+	return m;
+}
+
+void Arena::release(const ArenaMark &m) {
+	assert(m.block <= _currentBlock);
+	for (int i = m.block + 1; i <= _currentBlock && i < _blocksCount; ++i) {
+		_blocks[i].used = 0;
+	}
+	_currentBlock = m.block;
+	if (_currentBlock < _blocksCount) {
+		assert(m.offset <= _blocks[_currentBlock].used);
+		_blocks[_currentBlock].used = m.offset;
+	}
+}
+
+void Arena::clear() {
+	ArenaMark m;
+	m.block = 0;
+	m.offset = 0;
+	release(m);
+}
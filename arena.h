@@ -0,0 +1,42 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef ARENA_H__
+#define ARENA_H__
+
+#include "intern.h"
+
+struct ArenaMark {
+	int block;
+	uint32_t offset;
+};
+
+// stack allocator, memory is returned with release() in the reverse order of the allocations
+struct Arena {
+	enum {
+		kBlockSize = 1024 * 1024,
+		kMaxBlocks = 64
+	};
+
+	struct Block {
+		uint8_t *data;
+		uint32_t size;
+		uint32_t used;
+	};
+
+	Arena();
+	~Arena();
+
+	void *allocate(uint32_t size);
+	ArenaMark mark() const;
+	void release(const ArenaMark &m);
+	void clear();
+
+	Block _blocks[kMaxBlocks];
+	int _blocksCount;
+	int _currentBlock;
+};
+
+#endif // ARENA_H__
@@ -329,21 +329,30 @@ void Cinepak_Decoder::decode(const uint8_t *data, int dataSize) {
 }
 
 AVI_Player::AVI_Player(Mixer *mixer, SystemStub *stub)
-	: _soundQueue(0), _soundTailQueue(0), _mixer(mixer), _stub(stub) {
+	: _soundBuffer(0), _soundQueuePreloadSize(0), _mixer(mixer), _stub(stub) {
 }
 
 AVI_Player::~AVI_Player() {
-	while (_soundQueue) {
-		AVI_SoundBufferQueue *next = _soundQueue->next;
-		free(_soundQueue->buffer);
-		free(_soundQueue);
-		_soundQueue = next;
+	clearSoundQueue();
+}
+
+// the audio callback must not be running
+void AVI_Player::clearSoundQueue() {
+	if (_soundBuffer) {
+		free(_soundBuffer->buffer);
+		free(_soundBuffer);
+		_soundBuffer = 0;
 	}
+	AVI_SoundBuffer *sb;
+	while (_soundQueue.pop(&sb)) {
+		free(sb->buffer);
+		free(sb);
+	}
+	_soundQueuePreloadSize = 0;
 }
 
 void AVI_Player::play(File *f) {
-	_soundQueue = 0;
-	_soundQueuePreloadSize = 0;
+	clearSoundQueue();
 	if (_demux.open(f)) {
 		_stub->setYUV(true, _demux._width, _demux._height);
 		_mixer->setMusicMix(this, AVI_Player::mixCallback);
@@ -371,40 +380,37 @@ void AVI_Player::play(File *f) {
 			}
 		}
 		_mixer->setMusicMix(0, 0);
+		clearSoundQueue();
 		_stub->setYUV(false, 0, 0);
 		_demux.close();
 	}
 }
 
 void AVI_Player::decodeAudioChunk(AVI_Chunk &c) {
-	AVI_SoundBufferQueue *sbq = (AVI_SoundBufferQueue *)malloc(sizeof(AVI_SoundBufferQueue));
-	if (sbq) {
-		sbq->buffer = (uint8_t *)malloc(c.dataSize);
-		if (sbq->buffer) {
-			memcpy(sbq->buffer, c.data, c.dataSize);
-			sbq->size = c.dataSize;
-			sbq->offset = 0;
-			sbq->next = 0;
+	AVI_SoundBuffer *sb = (AVI_SoundBuffer *)malloc(sizeof(AVI_SoundBuffer));
+	if (sb) {
+		sb->buffer = (uint8_t *)malloc(c.dataSize);
+		if (sb->buffer) {
+			memcpy(sb->buffer, c.data, c.dataSize);
+			sb->size = c.dataSize;
+			sb->offset = 0;
 		} else {
-			free(sbq);
-			sbq = 0;
+			free(sb);
+			sb = 0;
 		}
 	}
-	_stub->lockAudio();
-	if (sbq) {
-		if (!_soundQueue) {
-			_soundQueue = sbq;
-		} else {
-			AVI_SoundBufferQueue *p = _soundTailQueue;
-			assert(!p->next);
-			p->next = sbq;
+	if (sb) {
+		if (!_soundQueue.push(sb)) {
+			warning("AVI_Player::decodeAudioChunk() soundQueue overrun");
+			free(sb->buffer);
+			free(sb);
+			return;
 		}
-		_soundTailQueue = sbq;
+		// the audio callback starts once a few buffers are queued
 		if (_soundQueuePreloadSize < kSoundPreloadSize) {
-			++_soundQueuePreloadSize;
+			atomicStore(&_soundQueuePreloadSize, _soundQueuePreloadSize + 1);
 		}
 	}
-	_stub->unlockAudio();
 }
 
 void AVI_Player::decodeVideoChunk(AVI_Chunk &c) {
@@ -416,25 +422,24 @@ void AVI_Player::decodeVideoChunk(AVI_Chunk &c) {
 }
 
 void AVI_Player::mix(int16_t *buf, int samples) {
-	if (_soundQueuePreloadSize < kSoundPreloadSize) {
+	if (atomicLoad(&_soundQueuePreloadSize) < kSoundPreloadSize) {
 		return;
 	}
-	while (_soundQueue && samples > 0) {
-		int sample = (_soundQueue->buffer[_soundQueue->offset] << 8) ^ 0x8000;
+	while (samples > 0) {
+		if (!_soundBuffer && !_soundQueue.pop(&_soundBuffer)) {
+			break;
+		}
+		int sample = (_soundBuffer->buffer[_soundBuffer->offset] << 8) ^ 0x8000;
 		*buf++ = (int16_t)sample;
 		*buf++ = (int16_t)sample;
-		_soundQueue->offset += 2; // skip every second sample (44Khz stream vs 22Khz mixer)
-		if (_soundQueue->offset >= _soundQueue->size) {
-			AVI_SoundBufferQueue *next = _soundQueue->next;
-			free(_soundQueue->buffer);
-			free(_soundQueue);
-			_soundQueue = next;
+		_soundBuffer->offset += 2; // skip every second sample (44Khz stream vs 22Khz mixer)
+		if (_soundBuffer->offset >= _soundBuffer->size) {
+			free(_soundBuffer->buffer);
+			free(_soundBuffer);
+			_soundBuffer = 0;
 		}
 		--samples;
 	}
-	if (!_soundQueue) {
-		_soundTailQueue = 0;
-	}
 	if (samples > 0) {
 		warning("AVI_Player::mix() soundQueue underrun %d", samples);
 	}
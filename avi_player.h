@@ -7,6 +7,7 @@
 #define AVI_PLAYER_H__
 
 #include "intern.h"
+#include "thread.h"
 
 enum AVI_ChunkType {
 	kChunkAudioType,
@@ -100,11 +101,10 @@ struct Cinepak_Decoder {
 	int _yuvPitch;
 };
 
-struct AVI_SoundBufferQueue {
+struct AVI_SoundBuffer {
 	uint8_t *buffer;
 	int size;
 	int offset;
-	AVI_SoundBufferQueue *next;
 };
 
 struct AVI_Player {
@@ -112,6 +112,7 @@ struct AVI_Player {
 		kDefaultFrameWidth = 320,
 		kDefaultFrameHeight = 200,
 		kSoundPreloadSize = 4,
+		kSoundQueueSize = 64
 	};
 
 	AVI_Player(Mixer *mixer, SystemStub *stub);
@@ -123,9 +124,12 @@ struct AVI_Player {
 	void decodeVideoChunk(AVI_Chunk &c);
 	void mix(int16_t *buf, int samples);
 	static void mixCallback(void *param, uint8_t *buf, int len);
+	void clearSoundQueue();
 
 	AVI_Demuxer _demux;
-	AVI_SoundBufferQueue *_soundQueue, *_soundTailQueue;
+	// filled by decodeAudioChunk, emptied by the audio callback
+	SpscQueue<AVI_SoundBuffer *, kSoundQueueSize> _soundQueue;
+	AVI_SoundBuffer *_soundBuffer; // being played by the audio callback
 	int _soundQueuePreloadSize;
 	Cinepak_Decoder _cinepak;
 	Mixer *_mixer;
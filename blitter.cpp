@@ -0,0 +1,253 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "blitter.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define BLITTER_X86
+#include <immintrin.h>
+#endif
+
+static void expandPalette_scalar(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	for (int i = 0; i < w; ++i) {
+		dst[i] = pal[src[i]];
+	}
+}
+
+static void expandPaletteTransparent_scalar(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	for (int i = 0; i < w; ++i) {
+		if (src[i] != 0) {
+			dst[i] = pal[src[i]];
+		}
+	}
+}
+
+static void fill32_scalar(uint32_t *dst, int w, uint32_t color) {
+	for (int i = 0; i < w; ++i) {
+		dst[i] = color;
+	}
+}
+
+static void darken32_scalar(uint32_t *dst, int w, uint32_t mask) {
+	for (int i = 0; i < w; ++i) {
+		dst[i] = (dst[i] >> 1) & mask;
+	}
+}
+
+static void clipS16_scalar(int16_t *dst, const int32_t *src, int count) {
+	for (int i = 0; i < count; ++i) {
+		dst[i] = (int16_t)CLIP(src[i], -32768, 32767);
+	}
+}
+
+static const Blitter _scalarBlitter = {
+	"scalar",
+	expandPalette_scalar,
+	expandPaletteTransparent_scalar,
+	fill32_scalar,
+	darken32_scalar,
+	clipS16_scalar
+};
+
+#ifdef BLITTER_X86
+
+// SSE2 has no gather instruction, the palette lookups are done 4 pixels at a
+// time and written with a single unaligned store
+
+__attribute__((target("sse2")))
+static inline __m128i lookup4_sse2(const uint8_t *src, const uint32_t *pal) {
+	return _mm_set_epi32(pal[src[3]], pal[src[2]], pal[src[1]], pal[src[0]]);
+}
+
+__attribute__((target("sse2")))
+static void expandPalette_sse2(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	int i = 0;
+	for (; i + 16 <= w; i += 16) {
+		_mm_storeu_si128((__m128i *)(dst + i), lookup4_sse2(src + i, pal));
+		_mm_storeu_si128((__m128i *)(dst + i + 4), lookup4_sse2(src + i + 4, pal));
+		_mm_storeu_si128((__m128i *)(dst + i + 8), lookup4_sse2(src + i + 8, pal));
+		_mm_storeu_si128((__m128i *)(dst + i + 12), lookup4_sse2(src + i + 12, pal));
+	}
+	expandPalette_scalar(dst + i, src + i, w - i, pal);
+}
+
+__attribute__((target("sse2")))
+static void expandPaletteTransparent_sse2(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 16 <= w; i += 16) {
+		const __m128i indexes = _mm_loadu_si128((const __m128i *)(src + i));
+		const int transparentMask = _mm_movemask_epi8(_mm_cmpeq_epi8(indexes, zero));
+		if (transparentMask == 0xFFFF) {
+			continue;
+		}
+		for (int j = 0; j < 16; j += 4) {
+			const int mask = (transparentMask >> j) & 15;
+			if (mask == 15) {
+				continue;
+			}
+			__m128i color = lookup4_sse2(src + i + j, pal);
+			if (mask != 0) {
+				// keep the destination pixels where the index is 0
+				int indexes4;
+				memcpy(&indexes4, src + i + j, sizeof(indexes4));
+				const __m128i bytes = _mm_cvtsi32_si128(indexes4);
+				const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+				const __m128i keep = _mm_cmpeq_epi32(_mm_unpacklo_epi16(words, zero), zero);
+				const __m128i prev = _mm_loadu_si128((const __m128i *)(dst + i + j));
+				color = _mm_or_si128(_mm_and_si128(keep, prev), _mm_andnot_si128(keep, color));
+			}
+			_mm_storeu_si128((__m128i *)(dst + i + j), color);
+		}
+	}
+	expandPaletteTransparent_scalar(dst + i, src + i, w - i, pal);
+}
+
+__attribute__((target("sse2")))
+static void fill32_sse2(uint32_t *dst, int w, uint32_t color) {
+	const __m128i c = _mm_set1_epi32(color);
+	int i = 0;
+	for (; i + 8 <= w; i += 8) {
+		_mm_storeu_si128((__m128i *)(dst + i), c);
+		_mm_storeu_si128((__m128i *)(dst + i + 4), c);
+	}
+	fill32_scalar(dst + i, w - i, color);
+}
+
+__attribute__((target("sse2")))
+static void darken32_sse2(uint32_t *dst, int w, uint32_t mask) {
+	const __m128i m = _mm_set1_epi32(mask);
+	int i = 0;
+	for (; i + 4 <= w; i += 4) {
+		const __m128i p = _mm_loadu_si128((const __m128i *)(dst + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_and_si128(_mm_srli_epi32(p, 1), m));
+	}
+	darken32_scalar(dst + i, w - i, mask);
+}
+
+__attribute__((target("sse2")))
+static void clipS16_sse2(int16_t *dst, const int32_t *src, int count) {
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i lo = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(src + i + 4));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+	clipS16_scalar(dst + i, src + i, count - i);
+}
+
+static const Blitter _sse2Blitter = {
+	"sse2",
+	expandPalette_sse2,
+	expandPaletteTransparent_sse2,
+	fill32_sse2,
+	darken32_sse2,
+	clipS16_sse2
+};
+
+__attribute__((target("avx2")))
+static inline __m256i lookup8_avx2(const uint8_t *src, const uint32_t *pal) {
+	const __m256i indexes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+	return _mm256_i32gather_epi32((const int *)pal, indexes, 4);
+}
+
+__attribute__((target("avx2")))
+static void expandPalette_avx2(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	int i = 0;
+	for (; i + 16 <= w; i += 16) {
+		_mm256_storeu_si256((__m256i *)(dst + i), lookup8_avx2(src + i, pal));
+		_mm256_storeu_si256((__m256i *)(dst + i + 8), lookup8_avx2(src + i + 8, pal));
+	}
+	expandPalette_scalar(dst + i, src + i, w - i, pal);
+}
+
+__attribute__((target("avx2")))
+static void expandPaletteTransparent_avx2(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal) {
+	const __m256i zero = _mm256_setzero_si256();
+	int i = 0;
+	for (; i + 8 <= w; i += 8) {
+		const __m256i indexes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+		const __m256i opaque = _mm256_xor_si256(_mm256_cmpeq_epi32(indexes, zero), _mm256_set1_epi32(-1));
+		if (_mm256_testz_si256(opaque, opaque)) {
+			continue;
+		}
+		const __m256i color = _mm256_i32gather_epi32((const int *)pal, indexes, 4);
+		_mm256_maskstore_epi32((int *)(dst + i), opaque, color);
+	}
+	expandPaletteTransparent_scalar(dst + i, src + i, w - i, pal);
+}
+
+__attribute__((target("avx2")))
+static void fill32_avx2(uint32_t *dst, int w, uint32_t color) {
+	const __m256i c = _mm256_set1_epi32(color);
+	int i = 0;
+	for (; i + 8 <= w; i += 8) {
+		_mm256_storeu_si256((__m256i *)(dst + i), c);
+	}
+	fill32_scalar(dst + i, w - i, color);
+}
+
+__attribute__((target("avx2")))
+static void darken32_avx2(uint32_t *dst, int w, uint32_t mask) {
+	const __m256i m = _mm256_set1_epi32(mask);
+	int i = 0;
+	for (; i + 8 <= w; i += 8) {
+		const __m256i p = _mm256_loadu_si256((const __m256i *)(dst + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_and_si256(_mm256_srli_epi32(p, 1), m));
+	}
+	darken32_scalar(dst + i, w - i, mask);
+}
+
+__attribute__((target("avx2")))
+static void clipS16_avx2(int16_t *dst, const int32_t *src, int count) {
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i lo = _mm256_loadu_si256((const __m256i *)(src + i));
+		const __m256i hi = _mm256_loadu_si256((const __m256i *)(src + i + 8));
+		// the pack works on 128 bits lanes, reorder the 64 bits quarters
+		const __m256i packed = _mm256_packs_epi32(lo, hi);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+	}
+	clipS16_scalar(dst + i, src + i, count - i);
+}
+
+static const Blitter _avx2Blitter = {
+	"avx2",
+	expandPalette_avx2,
+	expandPaletteTransparent_avx2,
+	fill32_avx2,
+	darken32_avx2,
+	clipS16_avx2
+};
+
+#endif
+
+const Blitter *findBlitter(const char *name) {
+	if (strcmp(name, _scalarBlitter.name) == 0) {
+		return &_scalarBlitter;
+	}
+#ifdef BLITTER_X86
+	__builtin_cpu_init();
+	if (strcmp(name, _sse2Blitter.name) == 0 && __builtin_cpu_supports("sse2")) {
+		return &_sse2Blitter;
+	}
+	if (strcmp(name, _avx2Blitter.name) == 0 && __builtin_cpu_supports("avx2")) {
+		return &_avx2Blitter;
+	}
+#endif
+	return 0;
+}
+
+const Blitter *getBlitter() {
+	static const Blitter *blitter = 0;
+	if (!blitter) {
+		static const char *names[] = { "avx2", "sse2", "scalar", 0 };
+		for (int i = 0; names[i] && !blitter; ++i) {
+			blitter = findBlitter(names[i]);
+		}
+		debug(DBG_INFO, "Using '%s' blitter", blitter->name);
+	}
+	return blitter;
+}
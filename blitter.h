@@ -0,0 +1,33 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef BLITTER_H__
+#define BLITTER_H__
+
+#include "intern.h"
+
+struct Blitter {
+	const char *name;
+	// converts w 8 bits indexed pixels to 32 bits colors
+	void (*expandPalette)(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal);
+	// same as expandPalette, skipping the pixels with color index 0
+	void (*expandPaletteTransparent)(uint32_t *dst, const uint8_t *src, int w, const uint32_t *pal);
+	void (*fill32)(uint32_t *dst, int w, uint32_t color);
+	// halves each color component, mask has the bits kept after the shift
+	void (*darken32)(uint32_t *dst, int w, uint32_t mask);
+	// saturates the mixed 32 bits samples to 16 bits
+	void (*clipS16)(int16_t *dst, const int32_t *src, int count);
+};
+
+// returns the fastest implementation supported by the cpu
+extern const Blitter *getBlitter();
+// returns the named implementation ('scalar', 'sse2', 'avx2') or 0 if not supported
+extern const Blitter *findBlitter(const char *name);
+
+static inline uint32_t getDarkenMask(uint32_t redBlueMask, uint32_t greenMask) {
+	return ((redBlueMask >> 1) & redBlueMask) | ((greenMask >> 1) & greenMask);
+}
+
+#endif // BLITTER_H__
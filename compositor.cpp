@@ -0,0 +1,343 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "compositor.h"
+#include "game.h"
+#include "systemstub.h"
+
+void drawObject(int x, int y, const uint8_t *src, SceneBitmap *dst, const uint8_t *depthMask, int depthLevel) {
+	int w = READ_LE_UINT16(src) + 1; src += 2;
+	int h = READ_LE_UINT16(src) + 1; src += 2;
+
+	int clippedW = w;
+	if (x > dst->w || x + clippedW <= 0) {
+		return;
+	}
+	if (x < 0) {
+		clippedW += x;
+		src -= x;
+		x = 0;
+	}
+	if (x + clippedW > dst->w) {
+		clippedW = dst->w + 1 - x;
+	}
+
+	int clippedH = h;
+	if (y > dst->h || y + clippedH <= 0) {
+		return;
+	}
+	if (y < 0) {
+		clippedH += y;
+		src -= y * w;
+		y = 0;
+	}
+	if (y + clippedH > dst->h) {
+		clippedH = dst->h + 1 - y;
+	}
+
+	for (int j = 0; j < clippedH; ++j) {
+		if (depthMask) {
+			const uint8_t *mask = depthMask + dst->pitch * (y + j) + x;
+			for (int i = 0; i < clippedW; ++i) {
+				if (src[i] && mask[i] >= depthLevel) {
+					dst->bits[dst->pitch * (y + j) + (x + i)] = src[i];
+				}
+			}
+		} else {
+			for (int i = 0; i < clippedW; ++i) {
+				if (src[i]) {
+					dst->bits[dst->pitch * (y + j) + (x + i)] = src[i];
+				}
+			}
+		}
+		src += w;
+	}
+}
+
+void drawObjectVerticalFlip(int x, int y, const uint8_t *src, SceneBitmap *dst, const uint8_t *depthMask, int depthLevel) {
+	int w = READ_LE_UINT16(src) + 1; src += 2;
+	int h = READ_LE_UINT16(src) + 1; src += 2;
+
+	src += w - 1;
+
+	int clippedW = w;
+	if (x > dst->w || x + clippedW <= 0) {
+		return;
+	}
+	if (x < 0) {
+		clippedW += x;
+		src += x;
+		x = 0;
+	}
+	if (x + clippedW > dst->w) {
+		clippedW = dst->w + 1 - x;
+	}
+
+	int clippedH = h;
+	if (y > dst->h || y + clippedH <= 0) {
+		return;
+	}
+	if (y < 0) {
+		clippedH += y;
+		src -= y * w;
+		y = 0;
+	}
+	if (y + clippedH > dst->h) {
+		clippedH = dst->h + 1 - y;
+	}
+
+	for (int j = 0; j < clippedH; ++j) {
+		if (depthMask) {
+			const uint8_t *mask = depthMask + dst->pitch * (y + j) + x;
+			for (int i = 0; i < clippedW; ++i) {
+				if (src[-i] && mask[i] >= depthLevel) {
+					dst->bits[dst->pitch * (y + j) + (x + i)] = src[-i];
+				}
+			}
+		} else {
+			for (int i = 0; i < clippedW; ++i) {
+				if (src[-i]) {
+					dst->bits[dst->pitch * (y + j) + (x + i)] = src[-i];
+				}
+			}
+		}
+		src += w;
+	}
+}
+
+int encodeObjectSpans(const uint8_t *src, uint16_t *spans) {
+	const int w = getBitmapWidth(src);
+	const int h = getBitmapHeight(src);
+	src = getBitmapData(src);
+	int size = 0;
+	for (int j = 0; j < h; ++j) {
+		const int countOffset = size++;
+		int count = 0;
+		for (int i = 0; i < w; ) {
+			if (src[i] == 0) {
+				++i;
+				continue;
+			}
+			const int start = i;
+			while (i < w && src[i] != 0) {
+				++i;
+			}
+			if (spans) {
+				spans[size] = start;
+				spans[size + 1] = i - start;
+			}
+			size += 2;
+			++count;
+		}
+		if (spans) {
+			spans[countOffset] = count;
+		}
+		src += w;
+	}
+	return size;
+}
+
+void drawObjectSpans(int x, int y, const uint8_t *src, const uint16_t *spans, SceneBitmap *dst, bool flip, const uint8_t *depthMask, int depthLevel) {
+	const int w = getBitmapWidth(src);
+	const int h = getBitmapHeight(src);
+	src = getBitmapData(src);
+
+	if (x > dst->w || x + w <= 0) {
+		return;
+	}
+	if (y > dst->h || y + h <= 0) {
+		return;
+	}
+	// visible source columns and rows
+	int xmin = MAX(0, -x);
+	int xmax = MIN(w, dst->w + 1 - x);
+	if (flip) {
+		xmin = MAX(0, w - 1 - dst->w + x);
+		xmax = MIN(w, w + x);
+	}
+	const int ymin = MAX(0, -y);
+	const int ymax = MIN(h, dst->h + 1 - y);
+
+	for (int j = 0; j < ymin; ++j) {
+		spans += 1 + spans[0] * 2;
+	}
+	src += ymin * w;
+	uint8_t *dstRow = dst->bits + dst->pitch * (y + ymin);
+	const uint8_t *maskRow = depthMask ? depthMask + dst->pitch * (y + ymin) : 0;
+	for (int j = ymin; j < ymax; ++j) {
+		const int count = *spans++;
+		for (int k = 0; k < count; ++k, spans += 2) {
+			const int x1 = MAX(xmin, (int)spans[0]);
+			const int x2 = MIN(xmax, spans[0] + spans[1]);
+			if (x1 >= x2) {
+				continue;
+			}
+			if (flip) {
+				const int offset = x + w - 1 - x1;
+				uint8_t *p = dstRow + offset;
+				if (maskRow) {
+					const uint8_t *mask = maskRow + offset;
+					for (int i = x1; i < x2; ++i, --p, --mask) {
+						if (*mask >= depthLevel) {
+							*p = src[i];
+						}
+					}
+				} else {
+					for (int i = x1; i < x2; ++i) {
+						*p-- = src[i];
+					}
+				}
+			} else if (maskRow) {
+				uint8_t *p = dstRow + x;
+				const uint8_t *mask = maskRow + x;
+				for (int i = x1; i < x2; ++i) {
+					if (mask[i] >= depthLevel) {
+						p[i] = src[i];
+					}
+				}
+			} else {
+				memcpy(dstRow + x + x1, src + x1, x2 - x1);
+			}
+		}
+		src += w;
+		dstRow += dst->pitch;
+		if (maskRow) {
+			maskRow += dst->pitch;
+		}
+	}
+}
+
+Compositor::Compositor()
+	: _threadPool(0), _bandsCount(1), _spritesCount(0), _dst(0), _depthMask(0) {
+}
+
+void Compositor::init(ThreadPool *threadPool, int bandsCount) {
+	_threadPool = threadPool;
+	_bandsCount = CLIP(bandsCount, 1, (int)kMaxBands);
+	_spritesCount = 0;
+	debug(DBG_INFO, "Compositor::init() %d bands", _bandsCount);
+}
+
+void Compositor::getBand(int num, int h, int *y, int *count) const {
+	const int y1 = h * num / _bandsCount;
+	const int y2 = h * (num + 1) / _bandsCount;
+	*y = y1;
+	*count = y2 - y1;
+}
+
+void Compositor::runBands(ThreadPool::JobProc proc) {
+	if (_bandsCount > 1 && _threadPool) {
+		_threadPool->run(proc, this, _bandsCount);
+	} else {
+		proc(this, 0);
+	}
+}
+
+void Compositor::beginSprites(SceneBitmap *dst, const uint8_t *depthMask) {
+	_dst = dst;
+	_depthMask = depthMask;
+	_spritesCount = 0;
+}
+
+void Compositor::addSprite(int x, int y, const uint8_t *data, const uint16_t *spans, bool flip, int depthLevel) {
+	if (_spritesCount >= kMaxSprites) {
+		flushSprites();
+	}
+	CompositorSprite *spr = &_spritesTable[_spritesCount++];
+	spr->x = x;
+	spr->y = y;
+	spr->data = data;
+	spr->spans = spans;
+	spr->flip = flip;
+	spr->depthLevel = depthLevel;
+}
+
+void Compositor::flushSprites() {
+	if (_spritesCount != 0) {
+		runBands(drawSpritesBand);
+		_spritesCount = 0;
+	}
+}
+
+void Compositor::drawSpritesBand(void *param, int num) {
+	Compositor *c = (Compositor *)param;
+	int y, count;
+	c->getBand(num, c->_dst->h + 1, &y, &count);
+	if (count <= 0) {
+		return;
+	}
+	// the drawing routines clip against the band rows
+	SceneBitmap band;
+	band.w = c->_dst->w;
+	band.h = count - 1;
+	band.pitch = c->_dst->pitch;
+	band.bits = c->_dst->bits + y * c->_dst->pitch;
+	for (int i = 0; i < c->_spritesCount; ++i) {
+		const CompositorSprite *spr = &c->_spritesTable[i];
+		const uint8_t *depthMask = (spr->depthLevel != 0 && c->_depthMask) ? c->_depthMask + y * c->_dst->pitch : 0;
+		if (spr->spans) {
+			drawObjectSpans(spr->x, spr->y - y, spr->data, spr->spans, &band, spr->flip, depthMask, spr->depthLevel);
+		} else if (spr->flip) {
+			drawObjectVerticalFlip(spr->x, spr->y - y, spr->data, &band, depthMask, spr->depthLevel);
+		} else {
+			drawObject(spr->x, spr->y - y, spr->data, &band, depthMask, spr->depthLevel);
+		}
+	}
+}
+
+void Compositor::updateRects(SystemStub *stub, SceneBitmap *dst, const SceneBitmap *background, const Rect *copyRects, int copyRectsCount, const Rect *restoreRects, int restoreRectsCount) {
+	_stub = stub;
+	_dst = dst;
+	_background = background;
+	_copyRects = copyRects;
+	_copyRectsCount = copyRectsCount;
+	_restoreRects = restoreRects;
+	_restoreRectsCount = restoreRectsCount;
+	runBands(updateRectsBand);
+}
+
+void Compositor::updateRectsBand(void *param, int num) {
+	Compositor *c = (Compositor *)param;
+	const SceneBitmap *dst = c->_dst;
+	const int h = dst->h + 1;
+	int y1, count;
+	c->getBand(num, h, &y1, &count);
+	const int y2 = y1 + count;
+	for (int i = 0; i < c->_copyRectsCount; ++i) {
+		const Rect *r = &c->_copyRects[i];
+		const int srcY = MAX(r->y, y1);
+		const int srcH = MIN(r->y + r->h, y2) - srcY;
+		if (srcH <= 0) {
+			continue;
+		}
+		// bitmap rows are stored bottom-up, same clipping as Game::win16_stretchBits
+		const int dstY = h - srcY - srcH;
+		int dstW = r->w;
+		int dstH = srcH;
+		if (r->x >= kGameScreenWidth || dstY >= kGameScreenHeight) {
+			continue;
+		}
+		if (r->x + dstW > kGameScreenWidth) {
+			dstW = kGameScreenWidth - r->x;
+		}
+		if (dstY + dstH > kGameScreenHeight) {
+			dstH = kGameScreenHeight - dstY;
+		}
+		c->_stub->copyRect(r->x, dstY, dstW, dstH, dst->bits + srcY * dst->pitch + r->x, dst->pitch);
+	}
+	const SceneBitmap *background = c->_background;
+	for (int i = 0; i < c->_restoreRectsCount; ++i) {
+		const Rect *r = &c->_restoreRects[i];
+		const int y = MAX(r->y, y1);
+		const int rows = MIN(r->y + r->h, y2) - y;
+		const uint8_t *src = background->bits + y * background->pitch + r->x;
+		uint8_t *p = dst->bits + y * dst->pitch + r->x;
+		for (int j = 0; j < rows; ++j) {
+			memcpy(p, src, r->w);
+			src += background->pitch;
+			p += dst->pitch;
+		}
+	}
+}
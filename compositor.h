@@ -0,0 +1,75 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef COMPOSITOR_H__
+#define COMPOSITOR_H__
+
+#include "intern.h"
+#include "thread.h"
+
+struct SystemStub;
+
+struct SceneBitmap {
+	uint16_t w; // x2
+	uint16_t h; // y2
+	uint16_t pitch;
+	uint8_t *bits;
+};
+
+extern void drawObject(int x, int y, const uint8_t *src, SceneBitmap *dst, const uint8_t *depthMask = 0, int depthLevel = 0);
+extern void drawObjectVerticalFlip(int x, int y, const uint8_t *src, SceneBitmap *dst, const uint8_t *depthMask = 0, int depthLevel = 0);
+// writes the opaque runs of each row as count, then (start, length) pairs, returns the size in words
+extern int encodeObjectSpans(const uint8_t *src, uint16_t *spans);
+extern void drawObjectSpans(int x, int y, const uint8_t *src, const uint16_t *spans, SceneBitmap *dst, bool flip, const uint8_t *depthMask = 0, int depthLevel = 0);
+
+struct CompositorSprite {
+	int x, y;
+	const uint8_t *data;
+	const uint16_t *spans;
+	bool flip;
+	int depthLevel;
+};
+
+// Splits the screen in horizontal bands, each band drawing the sprites list
+// and uploading the dirty rectangles for its rows. With a single band, the
+// jobs run on the calling thread.
+struct Compositor {
+	enum {
+		kMaxSprites = 128,
+		kMaxBands = ThreadPool::kMaxThreads
+	};
+
+	Compositor();
+
+	void init(ThreadPool *threadPool, int bandsCount);
+
+	void beginSprites(SceneBitmap *dst, const uint8_t *depthMask);
+	void addSprite(int x, int y, const uint8_t *data, const uint16_t *spans, bool flip, int depthLevel);
+	void flushSprites();
+
+	// uploads the rectangles to the screen, then restores them from the background
+	void updateRects(SystemStub *stub, SceneBitmap *dst, const SceneBitmap *background, const Rect *copyRects, int copyRectsCount, const Rect *restoreRects, int restoreRectsCount);
+
+	void getBand(int num, int h, int *y, int *count) const;
+	void runBands(ThreadPool::JobProc proc);
+
+	static void drawSpritesBand(void *param, int num);
+	static void updateRectsBand(void *param, int num);
+
+	ThreadPool *_threadPool;
+	int _bandsCount;
+	CompositorSprite _spritesTable[kMaxSprites];
+	int _spritesCount;
+	SceneBitmap *_dst;
+	const uint8_t *_depthMask;
+	SystemStub *_stub;
+	const SceneBitmap *_background;
+	const Rect *_copyRects;
+	int _copyRectsCount;
+	const Rect *_restoreRects;
+	int _restoreRectsCount;
+};
+
+#endif // COMPOSITOR_H__
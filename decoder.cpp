@@ -43,7 +43,19 @@ struct BitStream {
 
 static const bool kCheckCompressedData = true;
 
-int decodeLzss(const uint8_t *src, uint8_t *dst) {
+static void checkCompressedBlock(const uint8_t *src, int decodeSize) {
+	const uint16_t crc = READ_LE_UINT16(src); src += 2;
+	uint16_t sum = 0;
+	for (int i = 0; i < decodeSize * 8 - 1; ++i) {
+		sum = ((sum & 1) << 15) | (sum >> 1);
+		sum ^= READ_LE_UINT16(src); src += 2;
+	}
+	if (sum != crc) {
+		error("Invalid checksum, expected 0x%X got 0x%X", crc, sum);
+	}
+}
+
+int decodeLzssReference(const uint8_t *src, uint8_t *dst) {
 	BitStream stream;
 	int outputSize = READ_LE_UINT32(src); src += 4;
 	int inputSize = READ_LE_UINT32(src); src += 4;
@@ -54,16 +66,7 @@ int decodeLzss(const uint8_t *src, uint8_t *dst) {
 		}
 		inputSize -= decodeSize;
 		if (kCheckCompressedData) {
-			src = compressedData;
-			const uint16_t crc = READ_LE_UINT16(src); src += 2;
-			uint16_t sum = 0;
-			for (int i = 0; i < decodeSize * 8 - 1; ++i) {
-				sum = ((sum & 1) << 15) | (sum >> 1);
-				sum ^= READ_LE_UINT16(src); src += 2;
-			}
-			if (sum != crc) {
-				error("Invalid checksum, expected 0x%X got 0x%X", crc, sum);
-			}
+			checkCompressedBlock(compressedData, decodeSize);
 		}
 		src = compressedData + 2;
 		stream.reset(src);
@@ -110,6 +113,148 @@ int decodeLzss(const uint8_t *src, uint8_t *dst) {
 	return outputSize;
 }
 
+static inline int countTrailingZeros(uint32_t x) {
+#ifdef __GNUC__
+	return __builtin_ctz(x);
+#else
+	int count = 0;
+	while ((x & 1) == 0) {
+		x >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+// The control words are interleaved with the literal and offset bytes and the
+// next word is fetched as soon as the last bit of the current one is consumed.
+// The reservoir holds the remaining bits of the current word (LSB first), runs
+// of literal bits are counted at once and copied with a single memcpy.
+struct BitReservoir {
+	const uint8_t *_src;
+	uint32_t _bits;
+	int _len;
+
+	void reset(const uint8_t *src) {
+		_src = src;
+		refill();
+	}
+
+	void refill() {
+		_bits = READ_LE_UINT16(_src); _src += 2;
+		_len = 16;
+	}
+
+	bool getNextBit() {
+		const bool bit = (_bits & 1) != 0;
+		_bits >>= 1;
+		--_len;
+		if (_len == 0) {
+			refill();
+		}
+		return bit;
+	}
+
+	int getLiteralsCount() const {
+		// bits above _len are zero, the count is bounded by _len
+		return countTrailingZeros(~_bits);
+	}
+
+	void copyLiterals(uint8_t *dst, int count) {
+		if (count < _len) {
+			memcpy(dst, _src, count);
+			_src += count;
+			_bits >>= count;
+			_len -= count;
+		} else {
+			// the last literal byte follows the next control word
+			--count;
+			memcpy(dst, _src, count);
+			_src += count;
+			refill();
+			dst[count] = *_src++;
+		}
+	}
+
+	uint8_t getNextByte() {
+		uint8_t b = *_src++;
+		return b;
+	}
+
+	uint16_t getNextWord() {
+		uint16_t w = READ_LE_UINT16(_src); _src += 2;
+		return w;
+	}
+};
+
+static inline uint8_t *copyMatch(uint8_t *dst, int distance, int size) {
+	if (size <= distance) {
+		memcpy(dst, dst - distance, size);
+	} else if (distance == 1) {
+		memset(dst, dst[-1], size);
+	} else {
+		const uint8_t *src = dst - distance;
+		for (int i = 0; i < size; ++i) {
+			dst[i] = src[i];
+		}
+	}
+	return dst + size;
+}
+
+int decodeLzss(const uint8_t *src, uint8_t *dst) {
+	BitReservoir stream;
+	int outputSize = READ_LE_UINT32(src); src += 4;
+	int inputSize = READ_LE_UINT32(src); src += 4;
+	for (const uint8_t *compressedData = src; inputSize != 0; compressedData += 0x1000) {
+		int decodeSize = inputSize;
+		if (decodeSize > 256) {
+			decodeSize = 256;
+		}
+		inputSize -= decodeSize;
+		if (kCheckCompressedData) {
+			checkCompressedBlock(compressedData, decodeSize);
+		}
+		stream.reset(compressedData + 2);
+		while (1) {
+			const int count = stream.getLiteralsCount();
+			if (count != 0) {
+				stream.copyLiterals(dst, count);
+				dst += count;
+				continue;
+			}
+			stream.getNextBit();
+			int size, distance;
+			if (stream.getNextBit()) {
+				int code = stream.getNextWord();
+				distance = 0x2000 - (((code >> 3) & 0x1F00) | (code & 0xFF));
+				if (code & 0x700) {
+					size = ((code >> 8) & 7) + 2;
+				} else {
+					code = stream.getNextByte();
+					if (code == 0) {
+						return outputSize;
+					} else if (code == 1) {
+						continue;
+					} else if (code == 2) {
+						break;
+					} else {
+						size = code + 1;
+					}
+				}
+			} else {
+				size = stream.getNextBit() ? 2 : 0;
+				if (stream.getNextBit()) {
+					size |= 1;
+				}
+				size += 2;
+				distance = 0x100 - stream.getNextByte();
+			}
+			dst = copyMatch(dst, distance, size);
+		}
+	}
+	return outputSize;
+}
+
 int decodeZlib(const uint8_t *src, uint8_t *dst) {
 #ifdef BERMUDA_ZLIB
 	z_stream s;
@@ -9,6 +9,8 @@
 #include "intern.h"
 
 extern int decodeLzss(const uint8_t *src, uint8_t *dst);
+// bit by bit decoder, tools/test_lzss checks decodeLzss against it
+extern int decodeLzssReference(const uint8_t *src, uint8_t *dst);
 extern int decodeZlib(const uint8_t *src, uint8_t *dst);
 
 #endif // DECODER_H__
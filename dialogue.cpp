@@ -380,28 +380,27 @@ void Game::redrawDialogueSprite(int num) {
 void Game::redrawDialogueBackground() {
 	debug(DBG_DIALOGUE, "Game::redrawDialogueBackground()");
 	sortObjects();
-	int previousObject = -1;
+	updateRenderBoxes();
 	for (int i = 0; i < _sceneObjectsCount; ++i) {
 		SceneObject *so = _sortedSceneObjectsTable[i];
 		if (so->statePrev == 1 || so->statePrev == 2) {
-			if (previousObject >= 0) {
-				redrawObjectBoxes(previousObject, i);
-			}
-			previousObject = i;
-			decodeLzss(_sceneObjectFramesTable[so->frameNumPrev].data, _tempDecodeBuffer);
+			const int depthLevel = getDepthMaskLevel(so->z);
+			const uint8_t *depthMask = (depthLevel != 0) ? _depthMask : 0;
+			const uint16_t *frameSpans;
+			const uint8_t *frameData = decodeSceneObjectFrame(so->frameNumPrev, &frameSpans);
 			SceneObjectFrame *sof = &_sceneObjectFramesTable[so->frameNumPrev];
-			if (so->flipPrev == 2) {
+			if (frameSpans) {
+				int y = _bitmapBuffer1.h + 1 - so->yPrev - sof->hdr.h;
+				drawObjectSpans(so->xPrev, y, frameData, frameSpans, &_bitmapBuffer1, so->flipPrev == 2, depthMask, depthLevel);
+			} else if (so->flipPrev == 2) {
 				int y = _bitmapBuffer1.h + 1 - so->yPrev - sof->hdr.h;
-				drawObjectVerticalFlip(so->xPrev, y, _tempDecodeBuffer, &_bitmapBuffer1);
+				drawObjectVerticalFlip(so->xPrev, y, frameData, &_bitmapBuffer1, depthMask, depthLevel);
 			} else {
 				int y = _bitmapBuffer1.h + 1 - so->yPrev - sof->hdr.h;
-				drawObject(so->xPrev, y, _tempDecodeBuffer, &_bitmapBuffer1);
+				drawObject(so->xPrev, y, frameData, &_bitmapBuffer1, depthMask, depthLevel);
 			}
 		}
 	}
-	if (previousObject >= 0) {
-		redrawObjectBoxes(previousObject, previousObject);
-	}
 
 	const uint8_t *src = _bitmapBuffer1.bits + _dialogueBackgroundRect.y * _bitmapBuffer1.pitch + _dialogueBackgroundRect.x;
 	_stub->copyRect(_dialogueBackgroundRect.x, _dialogueBackgroundRect.y, _dialogueBackgroundRect.w, _dialogueBackgroundRect.h, src, _bitmapBuffer1.pitch);
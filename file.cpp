@@ -4,6 +4,7 @@
  */
 
 #include "file.h"
+#include "thread.h"
 
 struct File_impl {
 	bool _ioErr;
@@ -18,15 +19,31 @@ struct File_impl {
 	virtual uint32_t write(void *ptr, uint32_t len) = 0;
 };
 
+uint32_t File::_readsCount = 0;
+uint32_t File::_ioReadsCount = 0;
+uint32_t File::_readBufferSize = 64 * 1024;
+
 struct StdioFile : File_impl {
 	FILE *_fp;
 	uint32_t _offset, _size;
-	StdioFile() : _fp(0), _offset(0), _size(0) {}
-	StdioFile(uint32_t offset, uint32_t size) : _fp(0), _offset(offset), _size(size) {}
+	bool _buffered;
+	uint8_t *_buf;
+	uint32_t _bufSize, _bufPos, _bufLen;
+	StdioFile() : _fp(0), _offset(0), _size(0), _buffered(false), _buf(0), _bufSize(0), _bufPos(0), _bufLen(0) {}
+	StdioFile(uint32_t offset, uint32_t size) : _fp(0), _offset(offset), _size(size), _buffered(false), _buf(0), _bufSize(0), _bufPos(0), _bufLen(0) {}
+	~StdioFile() {
+		free(_buf);
+	}
 	bool open(const char *path, const char *mode) {
 		_ioErr = false;
 		_fp = fopen(path, mode);
 		if (_fp != 0) {
+			// read only files are read ahead in our buffer, files smaller than the buffer are read at once
+			_buffered = File::_readBufferSize != 0 && (strcmp(mode, "rb") == 0 || strcmp(mode, "r") == 0);
+			if (_buffered) {
+				setvbuf(_fp, 0, _IONBF, 0);
+			}
+			_bufPos = _bufLen = 0;
 			if (_offset != 0) {
 				fseek(_fp, _offset, SEEK_SET);
 			}
@@ -39,6 +56,7 @@ struct StdioFile : File_impl {
 			fclose(_fp);
 			_fp = 0;
 		}
+		_bufPos = _bufLen = 0;
 	}
 	uint32_t size() {
 		if (_size != 0) {
@@ -55,19 +73,72 @@ struct StdioFile : File_impl {
 	uint32_t tell() {
 		uint32_t pos = 0;
 		if (_fp) {
-			pos = ftell(_fp) - _offset;
+			pos = ftell(_fp) - _offset - (_bufLen - _bufPos);
 		}
 		return pos;
 	}
 	void seek(int offs, int origin) {
 		if (_fp) {
+			if (origin == SEEK_CUR) {
+				offs += tell();
+				origin = SEEK_SET;
+			}
+			if (origin == SEEK_SET && _bufLen != 0) {
+				// seek within the buffered data
+				const uint32_t bufStart = ftell(_fp) - _offset - _bufLen;
+				if ((uint32_t)offs >= bufStart && (uint32_t)offs <= bufStart + _bufLen) {
+					_bufPos = offs - bufStart;
+					return;
+				}
+			}
+			_bufPos = _bufLen = 0;
 			fseek(_fp, _offset + offs, origin);
 		}
 	}
+	uint32_t fillBuffer() {
+		if (!_buf) {
+			_bufSize = MIN(File::_readBufferSize, size());
+			if (_bufSize == 0) {
+				_bufSize = File::_readBufferSize;
+			}
+			_buf = (uint8_t *)malloc(_bufSize);
+			if (!_buf) {
+				_buffered = false;
+				return 0;
+			}
+		}
+		atomicAdd(&File::_ioReadsCount, 1);
+		_bufPos = 0;
+		_bufLen = fread(_buf, 1, _bufSize, _fp);
+		return _bufLen;
+	}
 	uint32_t read(void *ptr, uint32_t len) {
 		uint32_t r = 0;
 		if (_fp) {
-			r = fread(ptr, 1, len, _fp);
+			if (_buffered) {
+				uint8_t *dst = (uint8_t *)ptr;
+				while (r < len) {
+					if (_bufPos == _bufLen) {
+						if (len - r >= _bufSize && _buf) {
+							// large reads go straight to the destination
+							_bufPos = _bufLen = 0;
+							atomicAdd(&File::_ioReadsCount, 1);
+							r += fread(dst + r, 1, len - r, _fp);
+							break;
+						}
+						if (fillBuffer() == 0) {
+							break;
+						}
+					}
+					const uint32_t count = MIN(len - r, _bufLen - _bufPos);
+					memcpy(dst + r, _buf + _bufPos, count);
+					_bufPos += count;
+					r += count;
+				}
+			} else {
+				atomicAdd(&File::_ioReadsCount, 1);
+				r = fread(ptr, 1, len, _fp);
+			}
 			if (r != len) {
 				_ioErr = true;
 			}
@@ -99,13 +170,22 @@ struct ReadMemoryFile: File_impl {
 		return _offset;
 	}
 	void seek(int offs, int origin) {
-		assert(origin == SEEK_SET);
-		_offset = offs;
+		switch (origin) {
+		case SEEK_SET:
+			_offset = offs;
+			break;
+		case SEEK_CUR:
+			_offset += offs;
+			break;
+		case SEEK_END:
+			_offset = _len + offs;
+			break;
+		}
 	}
 	uint32_t read(void *ptr, uint32_t len) {
 		int count = len;
 		if (_offset + count > _len) {
-			count = _len - _offset;
+			count = (_offset < _len) ? _len - _offset : 0;
 			_ioErr = true;
 		}
 		if (count != 0) {
@@ -208,6 +288,7 @@ void File::seek(int offs, int origin) {
 }
 
 uint32_t File::read(void *ptr, uint32_t len) {
+	atomicAdd(&_readsCount, 1);
 	return _impl->read(ptr, len);
 }
 
@@ -35,6 +35,10 @@ struct File {
 
 	char *_path;
 	File_impl *_impl;
+
+	static uint32_t _readsCount; // File::read calls
+	static uint32_t _ioReadsCount; // fread calls
+	static uint32_t _readBufferSize; // read ahead of the files opened for reading, 0 keeps the stdio buffering
 };
 
 #endif // FILE_H__
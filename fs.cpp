@@ -9,26 +9,44 @@
 #endif
 #ifdef BERMUDA_POSIX
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #endif
 #include <sys/param.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <ctype.h>
 #include <unistd.h>
 #include "file.h"
 #include "fs.h"
 #include "str.h"
+#include "thread.h"
+
+static uint32_t hashFileName(const char *s) {
+	// FNV-1a on the lowercase characters
+	uint32_t h = 2166136261u;
+	while (*s) {
+		h ^= (uint8_t)tolower(*s++);
+		h *= 16777619;
+	}
+	return h;
+}
 
 struct FileSystem_impl {
 	FileSystem_impl() :
-		_rootDir(0), _fileList(0), _fileCount(0), _filePathSkipLen(0) {
+		_rootDir(0), _fileList(0), _fileCount(0), _filePathSkipLen(0),
+		_hashTable(0), _hashMask(0), _lookupsCount(0), _lookupsCompareCount(0), _lookupsTime(0) {
 	}
 
 	virtual ~FileSystem_impl() {
+		debug(DBG_RES, "FileSystem lookups %d, string compares %d, %d us", _lookupsCount, _lookupsCompareCount, _lookupsTime);
 		free(_rootDir);
 		for (int i = 0; i < _fileCount; ++i) {
 			free(_fileList[i]);
 		}
 		free(_fileList);
+		free(_hashTable);
 	}
 
 	void setDataDirectory(const char *dir) {
@@ -37,15 +55,66 @@ struct FileSystem_impl {
 		buildFileListFromDirectory(dir);
 	}
 
-	int findFileIndex(const char *file) const {
-		for (int i = 0; i < _fileCount; ++i) {
-			if (strcasecmp(_fileList[i], file) == 0) {
-				return i;
+	int lookupFileIndex(const char *file, int *comparesCount) const {
+		if (_hashTable) {
+			for (uint32_t h = hashFileName(file) & _hashMask; _hashTable[h] != -1; h = (h + 1) & _hashMask) {
+				++*comparesCount;
+				if (strcasecmp(_fileList[_hashTable[h]], file) == 0) {
+					return _hashTable[h];
+				}
 			}
 		}
 		return -1;
 	}
 
+	int findFileIndex(const char *file) const {
+		int comparesCount = 0;
+		if (!(g_debugMask & DBG_RES)) {
+			return lookupFileIndex(file, &comparesCount);
+		}
+		// the lookups statistics are only collected when debugging the resources loading
+		struct timeval t0;
+		gettimeofday(&t0, 0);
+		const int index = lookupFileIndex(file, &comparesCount);
+		struct timeval t1;
+		gettimeofday(&t1, 0);
+		// the sounds are also opened from the background thread
+		atomicAdd(&_lookupsCount, 1);
+		atomicAdd(&_lookupsCompareCount, comparesCount);
+		atomicAdd(&_lookupsTime, (t1.tv_sec - t0.tv_sec) * 1000000 + (t1.tv_usec - t0.tv_usec));
+		return index;
+	}
+
+	void addFileToHashTable(int index) {
+		if (_fileCount * 2 > _hashMask) {
+			// keep the load factor under 1/2
+			const int size = (_hashMask == 0) ? 256 : (_hashMask + 1) * 2;
+			free(_hashTable);
+			_hashTable = (int *)malloc(size * sizeof(int));
+			if (!_hashTable) {
+				error("Unable to allocate file hash table (%d entries)", size);
+			}
+			memset(_hashTable, 0xFF, size * sizeof(int));
+			_hashMask = size - 1;
+			for (int i = 0; i < index; ++i) {
+				insertHashTable(i);
+			}
+		}
+		insertHashTable(index);
+	}
+
+	void insertHashTable(int index) {
+		uint32_t h = hashFileName(_fileList[index]) & _hashMask;
+		while (_hashTable[h] != -1) {
+			if (strcasecmp(_fileList[_hashTable[h]], _fileList[index]) == 0) {
+				// keep the first entry, as the linear lookup did
+				return;
+			}
+			h = (h + 1) & _hashMask;
+		}
+		_hashTable[h] = index;
+	}
+
 	virtual const char *findFilePath(const char *file) const {
 		const int i = findFileIndex(file);
 		return (i < 0) ? 0 : _fileList[i];
@@ -63,6 +132,7 @@ struct FileSystem_impl {
 		if (_fileList) {
 			_fileList[_fileCount] = strdup(filePath + _filePathSkipLen);
 			++_fileCount;
+			addFileToHashTable(_fileCount - 1);
 		}
 	}
 
@@ -72,6 +142,11 @@ struct FileSystem_impl {
 	char **_fileList;
 	int _fileCount;
 	int _filePathSkipLen;
+	int *_hashTable;
+	int _hashMask;
+	mutable int _lookupsCount;
+	mutable int _lookupsCompareCount;
+	mutable int _lookupsTime;
 
 };
 
@@ -153,29 +228,74 @@ struct FileSystem_romfs: FileSystem_impl {
 		uint32_t size;
 	};
 
-	FileSystem_romfs(const char *filePath) {
+	FileSystem_romfs(const char *filePath)
+		: _mappedData(0), _mappedSize(0) {
 		_filePath = strdup(filePath);
-		_f.open(filePath);
-		_f.seek(kHeaderSize);
+		mapImage(filePath);
+		if (_mappedData) {
+			_f = new File(_mappedData, _mappedSize);
+		} else {
+			_f = new File;
+			_f->open(filePath);
+		}
+		_f->seek(kHeaderSize);
 		const int len = readString(0);
 		const int align = (len + 15) & ~15;
-		_f.seek(kHeaderSize + align);
+		_f->seek(kHeaderSize + align);
 		readTOC("");
 	}
 
 	~FileSystem_romfs() {
+		delete _f;
+		unmapImage();
 		free(_filePath);
 	}
 
+	void mapImage(const char *filePath) {
+#ifdef BERMUDA_POSIX
+		const int fd = open(filePath, O_RDONLY);
+		if (fd != -1) {
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void *p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED) {
+					_mappedData = (const uint8_t *)p;
+					_mappedSize = st.st_size;
+				} else {
+					warning("Unable to map '%s', errno %d", filePath, errno);
+				}
+			}
+			close(fd);
+		}
+#endif
+	}
+
+	void unmapImage() {
+#ifdef BERMUDA_POSIX
+		if (_mappedData) {
+			munmap((void *)_mappedData, _mappedSize);
+		}
+#endif
+		_mappedData = 0;
+		_mappedSize = 0;
+	}
+
+	const uint8_t *getFileData(const Entry *e) const {
+		if (_mappedData && e->offset + e->size <= _mappedSize) {
+			return _mappedData + e->offset;
+		}
+		return 0;
+	}
+
 	uint32_t readLong() {
-		const uint32_t num = _f.readUint32BE();
+		const uint32_t num = _f->readUint32BE();
 		return num;
 	}
 
 	int readString(char *s) {
 		int len = 0;
 		while (1) {
-			const char c = _f.readByte();
+			const char c = _f->readByte();
 			if (s) {
 				*s++ = c;
 			}
@@ -201,19 +321,19 @@ struct FileSystem_romfs: FileSystem_impl {
 			switch (nextOffset & 7) {
 			case 1:
 				if (name[0] != '.') {
-					_f.seek(specInfo);
+					_f->seek(specInfo);
 					readTOC(path, level + 1);
 				}
 				break;
 			case 2:
 				addFileToList(&path[1]);
 				assert(_fileCount <= (int)ARRAYSIZE(_fileEntries));
-				_fileEntries[_fileCount - 1].offset = (_f.tell() + 15) & ~15;
+				_fileEntries[_fileCount - 1].offset = (_f->tell() + 15) & ~15;
 				_fileEntries[_fileCount - 1].size = dataSize;
 				break;
 			}
 			pos = nextOffset & ~15;
-			_f.seek(pos);
+			_f->seek(pos);
 		} while (pos != 0);
 	}
 
@@ -223,7 +343,9 @@ struct FileSystem_romfs: FileSystem_impl {
 	}
 
 	char *_filePath;
-	File _f;
+	File *_f;
+	const uint8_t *_mappedData;
+	uint32_t _mappedSize;
 	Entry _fileEntries[kMaxEntries];
 };
 
@@ -279,12 +401,19 @@ File *FileSystem::openFile(const char *path, bool errorIfNotFound) {
 	char *fixedPath = fixPath(path);
 	if (fixedPath) {
 		if (_romfs) {
-			const FileSystem_romfs::Entry *e = ((FileSystem_romfs *)_impl)->findFileEntry(fixedPath);
+			const FileSystem_romfs *romfs = (const FileSystem_romfs *)_impl;
+			const FileSystem_romfs::Entry *e = romfs->findFileEntry(fixedPath);
 			if (e) {
-				f = new File(e->offset, e->size);
-				if (!f->open(((FileSystem_romfs *)_impl)->_filePath, "rb")) {
-					delete f;
-					f = 0;
+				const uint8_t *data = romfs->getFileData(e);
+				if (data) {
+					f = new File(data, e->size);
+					f->_path = strdup(romfs->_filePath);
+				} else {
+					f = new File(e->offset, e->size);
+					if (!f->open(romfs->_filePath, "rb")) {
+						delete f;
+						f = 0;
+					}
 				}
 			}
 		} else {
@@ -307,6 +436,25 @@ File *FileSystem::openFile(const char *path, bool errorIfNotFound) {
 	return f;
 }
 
+const uint8_t *FileSystem::mapFile(const char *path, uint32_t *size) {
+	const uint8_t *data = 0;
+	if (_romfs) {
+		char *fixedPath = fixPath(path);
+		if (fixedPath) {
+			const FileSystem_romfs *romfs = (const FileSystem_romfs *)_impl;
+			const FileSystem_romfs::Entry *e = romfs->findFileEntry(fixedPath);
+			if (e) {
+				data = romfs->getFileData(e);
+				if (data && size) {
+					*size = e->size;
+				}
+			}
+			free(fixedPath);
+		}
+	}
+	return data;
+}
+
 void FileSystem::closeFile(File *f) {
 	if (f) {
 		f->close();
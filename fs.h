@@ -17,6 +17,8 @@ struct FileSystem {
 
 	File *openFile(const char *path, bool errorIfNotFound = true);
 	void closeFile(File *f);
+	// returns the file data if it can be accessed without a copy (mapped romfs image), 0 otherwise
+	const uint8_t *mapFile(const char *path, uint32_t *size);
 
 	bool existFile(const char *path);
 
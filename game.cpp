@@ -24,6 +24,9 @@ Game::Game(SystemStub *stub, const char *dataPath, const char *savePath, const c
 	_mixer = _stub->getMixer();
 	_stateSlot = 1;
 	_cheats = 0;
+	_sceneObjectsGeneration = 0;
+	_decodedFramesMaxSize = kDecodedFramesCacheDefaultSize;
+	_threadsCount = 0;
 	detectVersion();
 	detectTextCp949();
 	if (_textCp949) {
@@ -130,14 +133,21 @@ void Game::restart() {
 	_bagPosY = 23;
 
 	memset(_sortedSceneObjectsTable, 0, sizeof(_sortedSceneObjectsTable));
+	_sortedSceneObjectsCount = -1;
 	memset(_sceneObjectsTable, 0, sizeof(_sceneObjectsTable));
 	_sceneObjectsCount = 0;
+	++_sceneObjectsGeneration;
 	memset(_animationsTable, 0, sizeof(_animationsTable));
 	_animationsCount = 0;
 	memset(_soundBuffersTable, 0, sizeof(_soundBuffersTable));
 	_soundBuffersCount = 0;
 	memset(_boxesTable, 0, sizeof(_boxesTable));
 	memset(_boxesCountTable, 0, sizeof(_boxesCountTable));
+	_renderBoxesCount = 0;
+	memset(_renderBoxesCopyCountTable, 0xFF, sizeof(_renderBoxesCopyCountTable));
+	_depthMaskZCount = 0;
+	_depthMaskDirty = true;
+	clearDecodedFrames(0);
 	memset(_sceneObjectFramesTable, 0, sizeof(_sceneObjectFramesTable));
 	_sceneObjectFramesCount = 0;
 	memset(_bagObjectsTable, 0, sizeof(_bagObjectsTable));
@@ -153,6 +163,10 @@ void Game::restart() {
 
 	_keyboardReplaySize = _keyboardReplayOffset = 0;
 	_keyboardReplayData = 0;
+
+	_dirtyRectsCount = _previousDirtyRectsCount = 0;
+	_dirtyFullScreen = true;
+	_dirtyPixelsCount = 0;
 }
 
 void Game::init(bool fullscreen, int screenMode) {
@@ -164,6 +178,9 @@ void Game::init(bool fullscreen, int screenMode) {
 		_stub->setIcon(_bermudaIconBmpData, _bermudaIconBmpSize);
 	}
 	_stub->init(caption, kGameScreenWidth, kGameScreenHeight, fullscreen, screenMode);
+	_threadPool.init(_threadsCount);
+	_backgroundThread.init();
+	_compositor.init(&_threadPool, (_threadsCount > 0) ? _threadPool._threadsCount : 1);
 	allocateTables();
 	loadCommonSprites();
 	restart();
@@ -176,13 +193,25 @@ void Game::init(bool fullscreen, int screenMode) {
 }
 
 void Game::fini() {
+	_backgroundThread.fini();
 	clearSceneData(-1);
 	deallocateTables();
 	unloadCommonSprites();
+	_threadPool.fini();
+	_scriptProfiler.fini();
+	_inputRecorder.fini();
 	_stub->destroy();
 }
 
 void Game::mainLoop() {
+	TraceScope traceTick("mainLoop");
+	if (_inputRecorder._mode != InputRecorder::kModeNone) {
+		if (!_inputRecorder.beginTick(&_stub->_pi)) {
+			// end of the recording
+			_stub->_quit = true;
+			return;
+		}
+	}
 	if (_nextState != _state) {
 		// fini
 		switch (_state) {
@@ -197,6 +226,7 @@ void Game::mainLoop() {
 			break;
 		}
 		_state = _nextState;
+		_dirtyFullScreen = true;
 		// init
 		switch (_state) {
 		case kStateGame:
@@ -216,7 +246,10 @@ void Game::mainLoop() {
 	switch (_state) {
 	case kStateGame:
 		while (_switchScene) {
+			TraceScope traceSceneSwitch("switchScene");
 			_switchScene = false;
+			const uint32_t readsCount = atomicLoad(&File::_readsCount);
+			const uint32_t ioReadsCount = atomicLoad(&File::_ioReadsCount);
 			if (stringEndsWith(_tempTextBuffer, "SCN")) {
 				win16_sndPlaySound(6);
 				debug(DBG_GAME, "switch to scene '%s'", _tempTextBuffer);
@@ -264,12 +297,17 @@ void Game::mainLoop() {
 			if (_loadDataState != 0) {
 				_stub->setPalette(_bitmapBuffer0 + kOffsetBitmapPalette, 256);
 				_stub->copyRectWidescreen(kGameScreenWidth, kGameScreenHeight, _bitmapBuffer1.bits, _bitmapBuffer1.pitch);
+				_dirtyFullScreen = true;
 			}
+			debug(DBG_RES, "Scene switch file reads %d, io reads %d", atomicLoad(&File::_readsCount) - readsCount, atomicLoad(&File::_ioReadsCount) - ioReadsCount);
 			_gameOver = false;
 			_workaroundRaftFlySceneBug = strncmp(_currentSceneScn, "FLY", 3) == 0;
 		}
-		updateKeysPressedTable();
-		updateMouseButtonsPressed();
+		{
+			TraceScope traceInput("input");
+			updateKeysPressedTable();
+			updateMouseButtonsPressed();
+		}
 		runObjectsScript();
 		if (_startDialogue) {
 			_startDialogue = false;
@@ -332,7 +370,13 @@ void Game::mainLoop() {
 		}
 		break;
 	}
-	_stub->updateScreen();
+	{
+		TraceScope traceUpdateScreen("updateScreen");
+		_stub->updateScreen();
+	}
+	if (_inputRecorder._mode != InputRecorder::kModeNone) {
+		_inputRecorder.endTick(_bitmapBuffer1.bits, kGameScreenWidth, kGameScreenHeight, _bitmapBuffer1.pitch);
+	}
 }
 
 void Game::updateMouseButtonsPressed() {
@@ -392,6 +436,10 @@ void Game::updateKeysPressedTable() {
 			_loadState = _switchScene; // gamestate will get loaded on scene switch
 		}
 	}
+	if (_stub->_pi.dumpProfile) {
+		_stub->_pi.dumpProfile = false;
+		_scriptProfiler.dump();
+	}
 	if (_stub->_pi.save) {
 		_stub->_pi.save = false;
 		char filePath[MAXPATHLEN];
@@ -417,9 +465,29 @@ void Game::updateKeysPressedTable() {
 	}
 }
 
+void Game::releaseSceneData(int animationsCount, int framesCount) {
+	if (animationsCount != 0 && animationsCount >= _animationsCount) {
+		return;
+	}
+	// the frames and scripts of the animations above the count were allocated after their arena mark
+	for (int i = framesCount; i < _sceneObjectFramesCount; ++i) {
+		_sceneObjectFramesTable[i].data = 0;
+	}
+	for (int i = animationsCount; i < _animationsCount; ++i) {
+		_animationsTable[i].scriptData = 0;
+		_animationsTable[i].scriptCode = 0;
+	}
+	if (animationsCount == 0) {
+		_sceneArena.clear();
+	} else {
+		_sceneArena.release(_animationsArenaMarkTable[animationsCount]);
+	}
+}
+
 void Game::clearSceneData(int anim) {
 	debug(DBG_GAME, "Game::clearSceneData(%d)", anim);
 	if (anim == -1) {
+		releaseSceneData(0, 0);
 		_sceneConditionsCount = 0;
 		_soundBuffersCount = 0;
 		_animationsCount = 0;
@@ -428,31 +496,21 @@ void Game::clearSceneData(int anim) {
 		_sceneObjectFramesCount = 0;
 		_loadDataState = 0;
 	} else {
-		_animationsCount = anim + 1;
 		SceneAnimation *sa = &_animationsTable[anim];
-		_sceneObjectMotionsCount = sa->firstMotionIndex + sa->motionsCount;
-		SceneObjectMotion *som = &_sceneObjectMotionsTable[_sceneObjectMotionsCount - 1];
+		const int motionsCount = sa->firstMotionIndex + sa->motionsCount;
+		SceneObjectMotion *som = &_sceneObjectMotionsTable[motionsCount - 1];
+		releaseSceneData(anim + 1, som->firstFrameIndex + som->count);
+		_animationsCount = anim + 1;
+		_sceneObjectMotionsCount = motionsCount;
 		_sceneObjectFramesCount = som->firstFrameIndex + som->count;
 		_sceneObjectsCount = sa->firstObjectIndex + sa->objectsCount;
 		_soundBuffersCount = sa->firstSoundBufferIndex + sa->soundBuffersCount;
 		_sceneConditionsCount = 0;
 		_loadDataState = 2;
 	}
+	++_sceneObjectsGeneration;
 	win16_sndPlaySound(7);
-	for (int i = _sceneObjectFramesCount; i < NUM_SCENE_OBJECT_FRAMES; ++i) {
-		SceneObjectFrame *sof = &_sceneObjectFramesTable[i];
-		if (sof->data) {
-			free(sof->data);
-			sof->data = 0;
-		}
-	}
-	for (int i = _animationsCount; i < NUM_SCENE_ANIMATIONS; ++i) {
-		SceneAnimation *sa = &_animationsTable[i];
-		if (sa->scriptData) {
-			free(sa->scriptData);
-			sa->scriptData = 0;
-		}
-	}
+	clearDecodedFrames(_sceneObjectFramesCount);
 	for (int i = _sceneObjectsCount; i < NUM_SCENE_OBJECTS; ++i) {
 		SceneObject *so = &_sceneObjectsTable[i];
 		so->state = 0;
@@ -508,6 +566,7 @@ void Game::reinitializeObject(int object) {
 }
 
 void Game::updateObjects() {
+	TraceScope trace("updateObjects");
 	debug(DBG_GAME, "Game::updateObjects()");
 	redrawObjects();
 	for (int i = 0; i < _sceneObjectsCount; ++i) {
@@ -544,6 +603,7 @@ void Game::updateObjects() {
 }
 
 void Game::runObjectsScript() {
+	TraceScope trace("runObjectsScript");
 	debug(DBG_GAME, "Game::runObjectsScript()");
 	_objectScript.nextScene = -1;
 	assert(_loadDataState != 3); // unneeded code
@@ -551,6 +611,9 @@ void Game::runObjectsScript() {
 		memset(_keysPressed, 0, sizeof(_keysPressed));
 	}
 	if (_loadDataState == 2) {
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.beginTick();
+		}
 		int start = _workaroundRaftFlySceneBug ? 1 : 0;
 		_workaroundRaftFlySceneBug = false;
 		for (int i = start; i < _sceneObjectsCount; ++i) {
@@ -562,39 +625,46 @@ void Game::runObjectsScript() {
 			_objectScript.currentObjectNum = i;
 			int anim = _sceneObjectMotionsTable[so->motionNum1].animNum;
 			assert(anim >= 0 && anim < _animationsCount);
+			if (_scriptProfiler._enabled) {
+				_scriptProfiler.beginObject(so->name, _animationsTable[anim].name);
+			}
 			_objectScript.data = _animationsTable[anim].scriptData;
-			int endOfDataOffset = _animationsTable[anim].scriptSize; // endOfDataOffset2
-			_objectScript.dataOffset = 0;
-			int statement = 0;
-			while (_objectScript.dataOffset < endOfDataOffset) {
-				_objectScript.statementNum = statement;
-				int endOfStatementDataOffset = _objectScript.fetchNextWord(); // endOfDataOffset1
-				_objectScript.testObjectNum = -1;
-				_objectScript.testDataOffset = endOfStatementDataOffset;
-				bool loop = true;
-				while (loop) {
-					int op = _objectScript.fetchNextWord();
-					debug(DBG_OPCODES, "statement %d condition %d op %d", statement, i, op);
-					if (op == 0) {
-						break;
-					}
-					loop = executeConditionOpcode(op);
+			_objectScript.dataSize = _animationsTable[anim].scriptSize;
+			_objectScript.code = _animationsTable[anim].scriptCode;
+			if (_objectScript.code) {
+				ObjectScriptCode *code = _animationsTable[anim].scriptCode;
+				if (code->objectsGeneration != _sceneObjectsGeneration) {
+					resolveObjectScriptNames(code, _objectScript.data);
 				}
-				if (loop) {
-					while (_objectScript.dataOffset < endOfStatementDataOffset) {
-						int op = _objectScript.fetchNextWord();
-						debug(DBG_OPCODES, "statement %d operator %d op %d", statement, i, op);
-						if (op == 100) { // &Game::oop_breakObjectScript
-							endOfStatementDataOffset = _objectScript.dataOffset = endOfDataOffset;
-							break;
-						}
-						executeOperatorOpcode(op);
+				executeObjectScriptCode(code);
+			} else {
+				int endOfDataOffset = _animationsTable[anim].scriptSize; // endOfDataOffset2
+				_objectScript.dataOffset = 0;
+				int statement = 0;
+				while (_objectScript.dataOffset < endOfDataOffset) {
+					const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+					_objectScript.statementNum = statement;
+					int endOfStatementDataOffset = _objectScript.fetchNextWord(); // endOfDataOffset1
+					_objectScript.testObjectNum = -1;
+					_objectScript.testDataOffset = endOfStatementDataOffset;
+					const bool breakScript = executeObjectScriptConditions() && !executeObjectScriptOperators(endOfStatementDataOffset);
+					if (_scriptProfiler._enabled) {
+						_scriptProfiler.addStatement(statement, t0);
+					}
+					if (breakScript) {
+						break;
 					}
+					_objectScript.dataOffset = endOfStatementDataOffset;
+					++statement;
 				}
-				_objectScript.dataOffset = endOfStatementDataOffset;
-				++statement;
+			}
+			if (_scriptProfiler._enabled) {
+				_scriptProfiler.endObject();
 			}
 		}
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.endTick();
+		}
 		_dialogueEndedFlag = 0;
 		if (_objectScript.nextScene != -1 && _objectScript.nextScene < _sceneConditionsCount) {
 			strcpy(_tempTextBuffer, _nextScenesTable[_objectScript.nextScene].name);
@@ -705,30 +775,138 @@ int Game::getObjectTranslateYPos(int object, int dy1, int div, int dy2) {
 	return _si;
 }
 
-int Game::findObjectByName(int currentObjectNum, int defaultObjectNum, bool *objectFlag) {
+int Game::findObjectByName(int name, int currentObjectNum, int defaultObjectNum, bool *objectFlag) {
 	int index = -1;
 	*objectFlag = true;
-	int16_t len = _objectScript.fetchNextWord();
-	debug(DBG_GAME, "Game::findObjectByName() len = %d", len);
-	if (len == -1) {
+	debug(DBG_GAME, "Game::findObjectByName() name = %d", name);
+	if (name == -1) {
 		index = defaultObjectNum;
-	} else if (len == 0) {
+	} else if (name == 0) {
 		*objectFlag = false;
 		index = currentObjectNum;
 	} else {
-		debug(DBG_GAME, "Game::findObjectByName() name = '%s' len = %d", _objectScript.getString(), len);
-		for (int i = 0; i < _sceneObjectsCount; ++i) {
-			if (strcmp(_sceneObjectsTable[i].name, _objectScript.getString()) == 0) {
-				index = i;
-				break;
+		// name is the data offset of the string
+		debug(DBG_GAME, "Game::findObjectByName() name = '%s'", _objectScript.getString(name));
+		const ObjectScriptCode *code = _objectScript.code;
+		if (code && code->objectsTable[name] != kObjectNameUnresolved) {
+			index = code->objectsTable[name];
+		} else {
+			for (int i = 0; i < _sceneObjectsCount; ++i) {
+				if (strcmp(_sceneObjectsTable[i].name, _objectScript.getString(name)) == 0) {
+					index = i;
+					break;
+				}
 			}
 		}
-		_objectScript.dataOffset += len;
 	}
 	return index;
 }
 
+const uint8_t *Game::decodeSceneObjectFrame(int num, const uint16_t **spans) {
+	DecodedFrame *df = &_decodedFramesTable[num];
+	if (spans) {
+		*spans = 0;
+	}
+	if (df->data) {
+		if (_decodedFramesHead != num) {
+			// move to the front of the LRU list
+			_decodedFramesTable[df->prev].next = df->next;
+			if (df->next != -1) {
+				_decodedFramesTable[df->next].prev = df->prev;
+			} else {
+				_decodedFramesTail = df->prev;
+			}
+			df->prev = -1;
+			df->next = _decodedFramesHead;
+			_decodedFramesTable[_decodedFramesHead].prev = num;
+			_decodedFramesHead = num;
+		}
+		if (spans) {
+			*spans = df->spans;
+		}
+		return df->data;
+	}
+	SceneObjectFrame *sof = &_sceneObjectFramesTable[num];
+	const int bitmapSize = sof->decode(sof->data, _tempDecodeBuffer);
+	if (bitmapSize <= 0) {
+		return _tempDecodeBuffer;
+	}
+	// the spans follow the bitmap, aligned on 16 bits
+	const int spansOffset = (bitmapSize + 1) & ~1;
+	const int spansSize = encodeObjectSpans(_tempDecodeBuffer, 0) * sizeof(uint16_t);
+	const int size = spansOffset + spansSize;
+	if ((uint32_t)size > _decodedFramesMaxSize) {
+		return _tempDecodeBuffer;
+	}
+	while (_decodedFramesSize + size > _decodedFramesMaxSize) {
+		unloadDecodedFrame(_decodedFramesTail);
+	}
+	df->data = (uint8_t *)malloc(size);
+	if (!df->data) {
+		warning("Unable to allocate %d bytes for decoded frame %d", size, num);
+		return _tempDecodeBuffer;
+	}
+	memcpy(df->data, _tempDecodeBuffer, bitmapSize);
+	df->spans = (uint16_t *)(df->data + spansOffset);
+	encodeObjectSpans(df->data, df->spans);
+	df->dataSize = size;
+	_decodedFramesSize += size;
+	df->prev = -1;
+	df->next = _decodedFramesHead;
+	if (_decodedFramesHead != -1) {
+		_decodedFramesTable[_decodedFramesHead].prev = num;
+	} else {
+		_decodedFramesTail = num;
+	}
+	_decodedFramesHead = num;
+	if (spans) {
+		*spans = df->spans;
+	}
+	return df->data;
+}
+
+void Game::unloadDecodedFrame(int num) {
+	DecodedFrame *df = &_decodedFramesTable[num];
+	if (df->data) {
+		if (df->prev != -1) {
+			_decodedFramesTable[df->prev].next = df->next;
+		} else {
+			_decodedFramesHead = df->next;
+		}
+		if (df->next != -1) {
+			_decodedFramesTable[df->next].prev = df->prev;
+		} else {
+			_decodedFramesTail = df->prev;
+		}
+		_decodedFramesSize -= df->dataSize;
+		free(df->data);
+		df->data = 0;
+		df->spans = 0;
+		df->dataSize = 0;
+		df->prev = df->next = -1;
+	}
+}
+
+void Game::clearDecodedFrames(int first) {
+	for (int i = first; i < NUM_SCENE_OBJECT_FRAMES; ++i) {
+		unloadDecodedFrame(i);
+	}
+}
+
 void Game::sortObjects() {
+	// the shell sort is not stable, the order of objects with the same z depends on all
+	// the other z values : the table is sorted again from scratch when any of them changes
+	bool sorted = (_sortedSceneObjectsCount == _sceneObjectsCount);
+	for (int i = 0; i < _sceneObjectsCount; ++i) {
+		if (_sortedSceneObjectsZTable[i] != _sceneObjectsTable[i].z) {
+			_sortedSceneObjectsZTable[i] = _sceneObjectsTable[i].z;
+			sorted = false;
+		}
+	}
+	if (sorted) {
+		return;
+	}
+	_sortedSceneObjectsCount = _sceneObjectsCount;
 	for (int i = 0; i < _sceneObjectsCount; ++i) {
 		_sortedSceneObjectsTable[i] = &_sceneObjectsTable[i];
 	}
@@ -824,139 +1002,259 @@ void Game::drawBox(int x, int y, int w, int h, SceneBitmap *src, SceneBitmap *ds
 	}
 }
 
-void Game::drawObject(int x, int y, const uint8_t *src, SceneBitmap *dst) {
-	int w = READ_LE_UINT16(src) + 1; src += 2;
-	int h = READ_LE_UINT16(src) + 1; src += 2;
-
-	int clippedW = w;
-	if (x > dst->w || x + clippedW <= 0) {
-		return;
-	}
-	if (x < 0) {
-		clippedW += x;
-		src -= x;
-		x = 0;
-	}
-	if (x + clippedW > dst->w) {
-		clippedW = dst->w + 1 - x;
+void Game::updateRenderBoxes() {
+	bool changed = false;
+	for (int b = 0; b < 10; ++b) {
+		if (_renderBoxesCopyCountTable[b] != _boxesCountTable[b] || memcmp(_renderBoxesCopyTable[b], _boxesTable[b], _boxesCountTable[b] * sizeof(Box)) != 0) {
+			_renderBoxesCopyCountTable[b] = _boxesCountTable[b];
+			memcpy(_renderBoxesCopyTable[b], _boxesTable[b], _boxesCountTable[b] * sizeof(Box));
+			changed = true;
+		}
 	}
-
-	int clippedH = h;
-	if (y > dst->h || y + clippedH <= 0) {
+	if (!changed) {
+		if (_depthMaskDirty) {
+			buildDepthMask();
+		}
 		return;
 	}
-	if (y < 0) {
-		clippedH += y;
-		src -= y * w;
-		y = 0;
-	}
-	if (y + clippedH > dst->h) {
-		clippedH = dst->h + 1 - y;
+	// insertion sort, boxes with the same z keep the group order
+	_renderBoxesCount = 0;
+	for (int b = 0; b < 10; ++b) {
+		for (int i = 0; i < _boxesCountTable[b]; ++i) {
+			Box *box = derefBox(b, i);
+			if (box->state == 2) {
+				int j = _renderBoxesCount++;
+				for (; j > 0 && _renderBoxesTable[j - 1]->z < box->z; --j) {
+					_renderBoxesTable[j] = _renderBoxesTable[j - 1];
+				}
+				_renderBoxesTable[j] = box;
+			}
+		}
 	}
+	debug(DBG_GAME, "Game::updateRenderBoxes() %d boxes", _renderBoxesCount);
+	buildDepthMask();
+}
 
-	for (int j = 0; j < clippedH; ++j) {
-		for (int i = 0; i < clippedW; ++i) {
-			if (src[i]) {
-				dst->bits[dst->pitch * (y + j) + (x + i)] = src[i];
+// a box hides the pixels of the objects with a greater or equal z, which are drawn before it
+void Game::buildDepthMask() {
+	_depthMaskDirty = false;
+	_depthMaskZCount = 0;
+	for (int i = _renderBoxesCount - 1; i >= 0; --i) {
+		const int z = _renderBoxesTable[i]->z;
+		if (_depthMaskZCount == 0 || _depthMaskZTable[_depthMaskZCount - 1] != z) {
+			_depthMaskZTable[_depthMaskZCount++] = z;
+		}
+	}
+	const int pitch = _bitmapBuffer1.pitch;
+	assert(pitch * (_bitmapBuffer1.h + 1) <= kGameScreenWidth * kGameScreenHeight);
+	memset(_depthMask, kDepthMaskNone, pitch * (_bitmapBuffer1.h + 1));
+	int level = _depthMaskZCount;
+	for (int i = 0; i < _renderBoxesCount; ++i) {
+		const Box *b = _renderBoxesTable[i];
+		while (_depthMaskZTable[level - 1] != b->z) {
+			--level;
+		}
+		// same clipping as copyBufferToBuffer and drawBox
+		int w = b->x2 - b->x1 + 1;
+		int h = b->y2 - b->y1 + 1;
+		int x = b->x1;
+		int y = _bitmapBuffer1.h + 1 - b->y2;
+		const int x2 = MIN(_bitmapBuffer3.w, _bitmapBuffer1.w);
+		if (w <= 0 || x > x2 || x + w <= 0) {
+			continue;
+		}
+		if (x < 0) {
+			w += x;
+			x = 0;
+		}
+		if (x + w > x2) {
+			w = x2 + 1 - x;
+		}
+		const int y2 = MIN(_bitmapBuffer3.h, _bitmapBuffer1.h);
+		if (h <= 0 || y >= y2 || y + h <= 0) {
+			continue;
+		}
+		if (y < 0) {
+			h += y;
+			y = 0;
+		}
+		if (y + h > y2) {
+			h = y2 + 1 - y;
+		}
+		const uint8_t *src = _bitmapBuffer3.bits + y * _bitmapBuffer3.pitch + x;
+		uint8_t *dst = _depthMask + y * pitch + x;
+		// boxes are processed by decreasing z, the nearest one is written last
+		if (b->endColor != 0) {
+			const int startColor = b->startColor;
+			const int endColor = b->startColor + b->endColor - 1;
+			for (int j = 0; j < h; ++j) {
+				for (int i = 0; i < w; ++i) {
+					if (startColor > src[i] || endColor <= src[i]) {
+						dst[i] = level - 1;
+					}
+				}
+				src += _bitmapBuffer3.pitch;
+				dst += pitch;
+			}
+		} else {
+			for (int j = 0; j < h; ++j) {
+				memset(dst, level - 1, w);
+				dst += pitch;
 			}
 		}
-		src += w;
 	}
+	debug(DBG_GAME, "Game::buildDepthMask() %d boxes %d levels", _renderBoxesCount, _depthMaskZCount);
 }
 
-void Game::drawObjectVerticalFlip(int x, int y, const uint8_t *src, SceneBitmap *dst) {
-	int w = READ_LE_UINT16(src) + 1; src += 2;
-	int h = READ_LE_UINT16(src) + 1; src += 2;
+// number of boxes z lower or equal to z, the object pixels with a lower mask value are hidden
+int Game::getDepthMaskLevel(int z) const {
+	int level = 0;
+	while (level < _depthMaskZCount && _depthMaskZTable[level] <= z) {
+		++level;
+	}
+	return level;
+}
 
-	src += w - 1;
+void Game::drawScreenObject(int x, int y, const uint8_t *src) {
+	drawObject(x, y, src, &_bitmapBuffer1);
+	addDirtyRect(x, y, getBitmapWidth(src), getBitmapHeight(src));
+}
 
-	int clippedW = w;
-	if (x > dst->w || x + clippedW <= 0) {
-		return;
-	}
+void Game::addDirtyRect(int x, int y, int w, int h) {
 	if (x < 0) {
-		clippedW += x;
-		src += x;
+		w += x;
 		x = 0;
 	}
-	if (x + clippedW > dst->w) {
-		clippedW = dst->w + 1 - x;
-	}
-
-	int clippedH = h;
-	if (y > dst->h || y + clippedH <= 0) {
-		return;
+	if (x + w > _bitmapBuffer1.w + 1) {
+		w = _bitmapBuffer1.w + 1 - x;
 	}
 	if (y < 0) {
-		clippedH += y;
-		src -= y * w;
+		h += y;
 		y = 0;
 	}
-	if (y + clippedH > dst->h) {
-		clippedH = dst->h + 1 - y;
+	if (y + h > _bitmapBuffer1.h + 1) {
+		h = _bitmapBuffer1.h + 1 - y;
 	}
+	if (w <= 0 || h <= 0) {
+		return;
+	}
+	for (int i = 0; i < _dirtyRectsCount; ++i) {
+		Rect *r = &_dirtyRectsTable[i];
+		if (x <= r->x + r->w && r->x <= x + w && y <= r->y + r->h && r->y <= y + h) {
+			// merge with the overlapping rectangle
+			const int x2 = MAX(x + w, r->x + r->w);
+			const int y2 = MAX(y + h, r->y + r->h);
+			r->x = MIN(x, r->x);
+			r->y = MIN(y, r->y);
+			r->w = x2 - r->x;
+			r->h = y2 - r->y;
+			return;
+		}
+	}
+	if (_dirtyRectsCount >= NUM_DIRTY_RECTS) {
+		_dirtyFullScreen = true;
+		return;
+	}
+	Rect *r = &_dirtyRectsTable[_dirtyRectsCount++];
+	r->x = x;
+	r->y = y;
+	r->w = w;
+	r->h = h;
+}
 
-	for (int j = 0; j < clippedH; ++j) {
-		for (int i = 0; i < clippedW; ++i) {
-			if (src[-i]) {
-				dst->bits[dst->pitch * (y + j) + (x + i)] = src[-i];
+static int mergeRects(Rect *rects, int count) {
+	for (int i = 0; i < count; ++i) {
+		for (int j = i + 1; j < count; ++j) {
+			Rect *a = &rects[i];
+			const Rect *b = &rects[j];
+			if (a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h) {
+				const int x2 = MAX(a->x + a->w, b->x + b->w);
+				const int y2 = MAX(a->y + a->h, b->y + b->h);
+				a->x = MIN(a->x, b->x);
+				a->y = MIN(a->y, b->y);
+				a->w = x2 - a->x;
+				a->h = y2 - a->y;
+				rects[j] = rects[--count];
+				// the grown rectangle may now overlap previous ones
+				j = i;
 			}
 		}
-		src += w;
 	}
+	return count;
 }
 
-void Game::redrawObjectBoxes(int previousObject, int currentObject) {
-	debug(DBG_GAME, "Game::redrawObjectBoxes(%d, %d)", previousObject, currentObject);
-	for (int b = 0; b < 10; ++b) {
-		for (int i = 0; i < _boxesCountTable[b]; ++i) {
-			Box *box = derefBox(b, i);
-			if (box->state == 2 && box->z <= _sortedSceneObjectsTable[previousObject]->z) {
-				const int w = box->x2 - box->x1 + 1;
-				const int h = box->y2 - box->y1 + 1;
-				const int x = box->x1;
-				const int y = _bitmapBuffer1.h + 1 - box->y2;
-				if (previousObject == currentObject || box->z > _sortedSceneObjectsTable[currentObject]->z) {
-					if (box->endColor != 0) {
-						drawBox(x, y, w, h, &_bitmapBuffer3, &_bitmapBuffer1, box->startColor, box->startColor + box->endColor - 1);
-					} else {
-						copyBufferToBuffer(x, y, w, h, &_bitmapBuffer3, &_bitmapBuffer1);
-					}
-				}
-			}
+void Game::updateDirtyRects() {
+	TraceScope trace("copyRect");
+	const int w = _bitmapBuffer1.w + 1;
+	const int h = _bitmapBuffer1.h + 1;
+	_dirtyPixelsCount = 0;
+	if (_inputRecorder._mode != InputRecorder::kModeNone) {
+		// the objects are drawn to the screen buffer, the background is restored below them by updateRects
+		_inputRecorder.captureFrame(_bitmapBuffer1.bits, kGameScreenWidth, kGameScreenHeight, _bitmapBuffer1.pitch);
+	}
+	if (_dirtyFullScreen) {
+		_dirtyFullScreen = false;
+		Rect r;
+		r.x = r.y = 0;
+		r.w = w;
+		r.h = h;
+		_compositor.updateRects(_stub, &_bitmapBuffer1, &_bitmapBuffer3, &r, 1, 0, 0);
+		memcpy(_bitmapBuffer1.bits, _bitmapBuffer3.bits, kGameScreenWidth * kGameScreenHeight);
+		_dirtyPixelsCount = 2 * w * h;
+		// the rectangles list may be incomplete, refresh the whole screen on the next frame
+		_previousDirtyRectsTable[0] = r;
+		_previousDirtyRectsCount = 1;
+	} else {
+		// upload the areas covered by the objects of this frame and the previous one, then restore the background
+		Rect rects[NUM_DIRTY_RECTS * 2];
+		int count = 0;
+		for (int i = 0; i < _previousDirtyRectsCount; ++i) {
+			rects[count++] = _previousDirtyRectsTable[i];
+		}
+		for (int i = 0; i < _dirtyRectsCount; ++i) {
+			rects[count++] = _dirtyRectsTable[i];
 		}
+		count = mergeRects(rects, count);
+		_compositor.updateRects(_stub, &_bitmapBuffer1, &_bitmapBuffer3, rects, count, _dirtyRectsTable, _dirtyRectsCount);
+		for (int i = 0; i < count; ++i) {
+			_dirtyPixelsCount += rects[i].w * rects[i].h;
+		}
+		for (int i = 0; i < _dirtyRectsCount; ++i) {
+			_dirtyPixelsCount += _dirtyRectsTable[i].w * _dirtyRectsTable[i].h;
+		}
+		memcpy(_previousDirtyRectsTable, _dirtyRectsTable, _dirtyRectsCount * sizeof(Rect));
+		_previousDirtyRectsCount = _dirtyRectsCount;
 	}
+	_dirtyRectsCount = 0;
+	debug(DBG_GAME, "Game::updateDirtyRects() %d pixels", _dirtyPixelsCount);
 }
 
 void Game::redrawObjects() {
+	TraceScope trace("redrawObjects");
 	sortObjects();
-	int previousObject = -1;
+	updateRenderBoxes();
+	_compositor.beginSprites(&_bitmapBuffer1, _depthMask);
 	for (int i = 0; i < _sceneObjectsCount; ++i) {
 		SceneObject *so = _sortedSceneObjectsTable[i];
 		if (so->state == 1 || so->state == 2) {
-			if (previousObject >= 0) {
-				redrawObjectBoxes(previousObject, i);
+			if (!_decodedFramesTable[so->frameNum].data) {
+				// decoding may evict the frames or reuse the temporary buffer of the queued sprites
+				_compositor.flushSprites();
 			}
-			previousObject = i;
-			_sceneObjectFramesTable[so->frameNum].decode(_sceneObjectFramesTable[so->frameNum].data, _tempDecodeBuffer);
+			const uint16_t *frameSpans;
+			const uint8_t *frameData = decodeSceneObjectFrame(so->frameNum, &frameSpans);
 			if (_isDemo && _sceneNumber == 1 && i == 14) {
 				// FIXME fixes wrong overlapping icon in the first scene of the demo
 				//   object 13 pos 582,423 frame 1885 - should be displayed
 				//   object 14 pos 582,423 frame 1884 - shouldn't be displayed
 				continue;
 			}
-			if (so->flip == 2) {
-				int16_t y = _bitmapBuffer1.h + 1 - so->y - _sceneObjectFramesTable[so->frameNum].hdr.h;
-				drawObjectVerticalFlip(so->x, y, _tempDecodeBuffer, &_bitmapBuffer1);
-			} else {
-				int16_t y = _bitmapBuffer1.h + 1 - so->y - _sceneObjectFramesTable[so->frameNum].hdr.h;
-				drawObject(so->x, y, _tempDecodeBuffer, &_bitmapBuffer1);
-			}
+			int16_t y = _bitmapBuffer1.h + 1 - so->y - _sceneObjectFramesTable[so->frameNum].hdr.h;
+			_compositor.addSprite(so->x, y, frameData, frameSpans, so->flip == 2, getDepthMaskLevel(so->z));
+			addDirtyRect(so->x, y, getBitmapWidth(frameData), getBitmapHeight(frameData));
 		}
 	}
-	if (previousObject >= 0) {
-		redrawObjectBoxes(previousObject, previousObject);
-	}
+	_compositor.flushSprites();
 
 	// no overlay graphics on static screens
 	//
@@ -975,38 +1273,38 @@ void Game::redrawObjects() {
 	if (_sceneNumber > -1000 && _sceneObjectsCount != 0) {
 		if (!_isDemo && _gameOver) {
 			decodeLzss(_bermudaOvrData + 2, _tempDecodeBuffer);
-			drawObject(93, _bitmapBuffer1.h - 230, _tempDecodeBuffer, &_bitmapBuffer1);
+			drawScreenObject(93, _bitmapBuffer1.h - 230, _tempDecodeBuffer);
 		}
 		if (_currentBagObject >= 0 && _currentBagObject < _bagObjectsCount && _currentBagAction == 3) {
-			drawObject(_bagPosX, _bitmapBuffer1.h + 1 - _bagPosY - getBitmapHeight(_iconBackgroundImage), _iconBackgroundImage, &_bitmapBuffer1);
+			drawScreenObject(_bagPosX, _bitmapBuffer1.h + 1 - _bagPosY - getBitmapHeight(_iconBackgroundImage), _iconBackgroundImage);
 			int invW = getBitmapWidth(_iconBackgroundImage);
 			int invH = getBitmapHeight(_iconBackgroundImage);
 			int bagObjW = getBitmapWidth(_bagObjectsTable[_currentBagObject].data);
 			int bagObjH = getBitmapHeight(_bagObjectsTable[_currentBagObject].data);
 			int y = _bitmapBuffer1.h + 1 - _bagPosY - (invH - bagObjH) / 2 - bagObjH;
 			int x = _bagPosX + (invW - bagObjW) / 2;
-			drawObject(x, y, _bagObjectsTable[_currentBagObject].data, &_bitmapBuffer1);
+			drawScreenObject(x, y, _bagObjectsTable[_currentBagObject].data);
 		}
 		if (_lifeBarDisplayed) {
-			drawObject(386, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage, &_bitmapBuffer1);
+			drawScreenObject(386, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage);
 			if (_varsTable[1] == 1) {
-				drawObject(150, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage, &_bitmapBuffer1);
+				drawScreenObject(150, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage);
 				if (_swordIconImage) {
-					drawObject(173, _bitmapBuffer1.h - 18 - getBitmapHeight(_swordIconImage), _swordIconImage, &_bitmapBuffer1);
+					drawScreenObject(173, _bitmapBuffer1.h - 18 - getBitmapHeight(_swordIconImage), _swordIconImage);
 				}
 			} else if (_varsTable[2] == 1) {
-				drawObject(150, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage, &_bitmapBuffer1);
+				drawScreenObject(150, _bitmapBuffer1.h - 18 - getBitmapHeight(_lifeBarImage), _lifeBarImage);
 				int index = MIN(13, 13 - _varsTable[4]);
-				drawObject(173, _bitmapBuffer1.h - 31 - getBitmapHeight(_weaponIconImageTable[index]), _weaponIconImageTable[index], &_bitmapBuffer1);
+				drawScreenObject(173, _bitmapBuffer1.h - 31 - getBitmapHeight(_weaponIconImageTable[index]), _weaponIconImageTable[index]);
 				if (_varsTable[3] < 5) {
 					index = (_varsTable[4] <= 0) ? 0 : 1;
 					uint8_t *p = _ammoIconImageTable[index][_varsTable[3]];
-					drawObject(184, _bitmapBuffer1.h - 41 - getBitmapHeight(p), p, &_bitmapBuffer1);
+					drawScreenObject(184, _bitmapBuffer1.h - 41 - getBitmapHeight(p), p);
 				}
 			}
 			int index = (_varsTable[0] >= 10) ? 10 : _varsTable[0];
 			uint8_t *lifeBarFrame = _lifeBarImageTable[index][_lifeBarCurrentFrame];
-			drawObject(409, _bitmapBuffer1.h - 36 - getBitmapHeight(lifeBarFrame), lifeBarFrame, &_bitmapBuffer1);
+			drawScreenObject(409, _bitmapBuffer1.h - 36 - getBitmapHeight(lifeBarFrame), lifeBarFrame);
 			++_lifeBarCurrentFrame;
 			if (_lifeBarCurrentFrame >= 12) {
 				_lifeBarCurrentFrame = 0;
@@ -1054,8 +1352,7 @@ void Game::redrawObjects() {
 		}
 #endif
 	}
-	win16_stretchBits(&_bitmapBuffer1, _bitmapBuffer1.h + 1, _bitmapBuffer1.w + 1, 0, 0, _bitmapBuffer1.h + 1, _bitmapBuffer1.w + 1, 0, 0);
-	memcpy(_bitmapBuffer1.bits, _bitmapBuffer3.bits, kGameScreenWidth * kGameScreenHeight);
+	updateDirtyRects();
 	if (_lifeBarDisplayed) {
 		copyBufferToBuffer(386,
 			_bitmapBuffer1.h + 1 - 19 - getBitmapHeight(_lifeBarImage),
@@ -1107,6 +1404,7 @@ void Game::stopMusic() {
 }
 
 void Game::playMusic(const char *name) {
+	TraceScope trace("playMusic");
 	static const struct {
 		const char *fileName;
 		int digitalTrack;
@@ -1192,14 +1490,14 @@ void Game::changeObjectMotionFrame(int object, int object2, int useObject2, int
 	}
 }
 
-int16_t Game::getObjectTransformXPos(int object) {
+int16_t Game::getObjectTransformXPos(int object, const int *args) {
 	debug(DBG_GAME, "Game::getObjectTransformXPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int w = derefSceneObjectFrame(so->frameNumPrev)->hdr.w;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
 
 	int16_t dx = a0 * w / a2 + a4;
 	if (so->flipPrev == 2) {
@@ -1208,14 +1506,14 @@ int16_t Game::getObjectTransformXPos(int object) {
 	return so->xPrev + dx;
 }
 
-int16_t Game::getObjectTransformYPos(int object) {
+int16_t Game::getObjectTransformYPos(int object, const int *args) {
 	debug(DBG_GAME, "Game::getObjectTransformYPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int h = derefSceneObjectFrame(so->frameNumPrev)->hdr.h;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
 
 	int16_t dy = a0 * h / a2 + a4;
 	if (so->flipPrev == 1) {
@@ -1224,19 +1522,19 @@ int16_t Game::getObjectTransformYPos(int object) {
 	return so->yPrev + dy;
 }
 
-bool Game::comparePrevObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
+bool Game::comparePrevObjectTransformXPos(int object, const int *args, bool fetchCmp, int cmpX) {
 	debug(DBG_GAME, "Game::comparePrevObjectTransformXPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int w = derefSceneObjectFrame(so->frameNumPrev)->hdr.w;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
-	int16_t a6 = _objectScript.fetchNextWord();
-	int16_t a8 = _objectScript.fetchNextWord();
-	int16_t aA = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
+	int16_t a6 = args[3];
+	int16_t a8 = args[4];
+	int16_t aA = args[5];
 	if (fetchCmp) {
-		cmpX = _objectScript.fetchNextWord();
+		cmpX = args[6];
 	}
 
 	int16_t xmin = a0 * w / a2 + a4;
@@ -1251,19 +1549,19 @@ bool Game::comparePrevObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
 	return so->statePrev != 0 && so->xPrev + xmin <= cmpX && so->xPrev + xmax >= cmpX;
 }
 
-bool Game::compareObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
+bool Game::compareObjectTransformXPos(int object, const int *args, bool fetchCmp, int cmpX) {
 	debug(DBG_GAME, "Game::compareObjectTransformXPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int w = derefSceneObjectFrame(so->frameNum)->hdr.w;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
-	int16_t a6 = _objectScript.fetchNextWord();
-	int16_t a8 = _objectScript.fetchNextWord();
-	int16_t aA = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
+	int16_t a6 = args[3];
+	int16_t a8 = args[4];
+	int16_t aA = args[5];
 	if (fetchCmp) {
-		cmpX = _objectScript.fetchNextWord();
+		cmpX = args[6];
 	}
 
 	int16_t xmin = a0 * w / a2 + a4;
@@ -1278,19 +1576,19 @@ bool Game::compareObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
 	return so->state != 0 && so->x + xmin <= cmpX && so->x + xmax >= cmpX;
 }
 
-bool Game::comparePrevObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
+bool Game::comparePrevObjectTransformYPos(int object, const int *args, bool fetchCmp, int cmpY) {
 	debug(DBG_GAME, "Game::comparePrevObjectTransformYPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int h = derefSceneObjectFrame(so->frameNumPrev)->hdr.h;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
-	int16_t a6 = _objectScript.fetchNextWord();
-	int16_t a8 = _objectScript.fetchNextWord();
-	int16_t aA = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
+	int16_t a6 = args[3];
+	int16_t a8 = args[4];
+	int16_t aA = args[5];
 	if (fetchCmp) {
-		cmpY = _objectScript.fetchNextWord();
+		cmpY = args[6];
 	}
 
 	int16_t ymin = a0 * h / a2 + a4;
@@ -1305,19 +1603,19 @@ bool Game::comparePrevObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
 	return so->statePrev != 0 && so->yPrev + ymin <= cmpY && so->yPrev + ymax >= cmpY;
 }
 
-bool Game::compareObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
+bool Game::compareObjectTransformYPos(int object, const int *args, bool fetchCmp, int cmpY) {
 	debug(DBG_GAME, "Game::compareObjectTransformYPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	const int h = derefSceneObjectFrame(so->frameNum)->hdr.h;
 
-	int16_t a0 = _objectScript.fetchNextWord();
-	int16_t a2 = _objectScript.fetchNextWord();
-	int16_t a4 = _objectScript.fetchNextWord();
-	int16_t a6 = _objectScript.fetchNextWord();
-	int16_t a8 = _objectScript.fetchNextWord();
-	int16_t aA = _objectScript.fetchNextWord();
+	int16_t a0 = args[0];
+	int16_t a2 = args[1];
+	int16_t a4 = args[2];
+	int16_t a6 = args[3];
+	int16_t a8 = args[4];
+	int16_t aA = args[5];
 	if (fetchCmp) {
-		cmpY = _objectScript.fetchNextWord();
+		cmpY = args[6];
 	}
 
 	int16_t ymin = a0 * h / a2 + a4;
@@ -1332,7 +1630,7 @@ bool Game::compareObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
 	return so->state != 0 && so->y + ymin <= cmpY && so->y + ymax >= cmpY;
 }
 
-void Game::setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2) {
+bool Game::setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2, const int *args) {
 	debug(DBG_GAME, "Game::setupObjectPos(%d)", object);
 	SceneObject *so = derefSceneObject(object);
 	SceneObjectFrame *sof = derefSceneObjectFrame(so->frameNumPrev);
@@ -1340,13 +1638,13 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 	int16_t dy = 0, dx = 0, xmin = 0, xmax, ymin = 0, ymax, _ax;
 	if (so->statePrev != 0) {
 		if (type1 == 2) {
-			a0 = _objectScript.fetchNextWord();
-			a2 = _objectScript.fetchNextWord();
-			a4 = _objectScript.fetchNextWord();
+			a0 = *args++;
+			a2 = *args++;
+			a4 = *args++;
 			xmin = a0 * sof->hdr.w / a2 + a4;
-			a0 = _objectScript.fetchNextWord();
-			a2 = _objectScript.fetchNextWord();
-			a4 = _objectScript.fetchNextWord();
+			a0 = *args++;
+			a2 = *args++;
+			a4 = *args++;
 			xmax = a0 * sof->hdr.w / a2 + a4;
 			if (xmax < xmin) {
 				SWAP(xmin, xmax);
@@ -1354,13 +1652,13 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 			dx = xmax - xmin;
 		}
 		if (type2 == 2) {
-			a0 = _objectScript.fetchNextWord();
-			a2 = _objectScript.fetchNextWord();
-			a4 = _objectScript.fetchNextWord();
+			a0 = *args++;
+			a2 = *args++;
+			a4 = *args++;
 			ymin = a0 * sof->hdr.h / a2 + a4;
-			a0 = _objectScript.fetchNextWord();
-			a2 = _objectScript.fetchNextWord();
-			a4 = _objectScript.fetchNextWord();
+			a0 = *args++;
+			a2 = *args++;
+			a4 = *args++;
 			ymax = a0 * sof->hdr.h / a2 + a4;
 			if (ymax < ymin) {
 				SWAP(ymin, ymax);
@@ -1373,11 +1671,11 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 		} else {
 			_ax = _sceneObjectsTable[object2].motionInit;
 		}
-		so->motionNum2 = _ax + _objectScript.fetchNextWord() - 1;
+		so->motionNum2 = _ax + *args++ - 1;
 		if (useData == 0) {
 			so->frameNum = _sceneObjectMotionsTable[so->motionNum2].firstFrameIndex;
 		} else {
-			so->frameNum = _sceneObjectMotionsTable[so->motionNum2].firstFrameIndex + _objectScript.fetchNextWord() - 1;
+			so->frameNum = _sceneObjectMotionsTable[so->motionNum2].firstFrameIndex + *args++ - 1;
 		}
 
 		int16_t _si = _sceneObjectFramesTable[so->frameNum].hdr.xPos - sof->hdr.xPos;
@@ -1387,8 +1685,8 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 				_si += dx;
 			}
 		} else if (type1 == 3) {
-			a0 = _objectScript.fetchNextWord();
-			_objectScript.fetchNextWord();
+			a0 = *args++;
+			++args;
 			_si = a0 - sof->hdr.xPos;
 		}
 
@@ -1399,8 +1697,8 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 				_di += dy;
 			}
 		} else if (type2 == 3) {
-			_objectScript.fetchNextWord();
-			a2 = _objectScript.fetchNextWord();
+			++args;
+			a2 = *args++;
 			_di = a2 - sof->hdr.yPos;
 		}
 
@@ -1413,7 +1711,9 @@ void Game::setupObjectPos(int object, int object2, int useObject2, int useData,
 		}
 		so->x = _ax;
 		so->y = so->yPrev + _di;
+		return true;
 	}
+	return false;
 }
 
 bool Game::intersectsBox(int num, int index, int x1, int y1, int x2, int y2) {
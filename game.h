@@ -7,14 +7,40 @@
 #define GAME_H__
 
 #include "intern.h"
+#include "arena.h"
+#include "compositor.h"
 #include "random.h"
 #include "fs.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "thread.h"
+
+struct ObjectScriptInstruction {
+	uint16_t num; // index in the condition or operator opcodes table
+	uint16_t dataOffset; // first operand
+	uint16_t nextDataOffset;
+	uint16_t firstOperand; // index in the decoded operands table
+};
+
+struct ObjectScriptStatement {
+	uint16_t endDataOffset;
+	uint16_t operatorsDataOffset;
+	uint16_t firstInstruction;
+	uint16_t conditionsCount;
+	uint16_t operatorsCount;
+	bool breakScript;
+};
 
-struct SceneBitmap {
-	uint16_t w; // x2
-	uint16_t h; // y2
-	uint16_t pitch;
-	uint8_t *bits;
+struct ObjectScriptCode {
+	int statementsCount;
+	ObjectScriptStatement *statementsTable;
+	ObjectScriptInstruction *instructionsTable;
+	int *operandsTable;
+	int dataSize;
+	int namesCount;
+	uint16_t *namesTable; // offsets of the object names
+	int8_t *objectsTable; // object index of the name at a data offset
+	uint32_t objectsGeneration;
 };
 
 struct SceneAnimation {
@@ -25,8 +51,9 @@ struct SceneAnimation {
 	int16_t objectsCount;
 	int16_t firstSoundBufferIndex;
 	int16_t soundBuffersCount;
-	uint8_t *scriptData;
+	const uint8_t *scriptData;
 	uint16_t scriptSize;
+	ObjectScriptCode *scriptCode;
 	int16_t unk26;
 };
 
@@ -90,11 +117,18 @@ struct SceneObjectFrameHeader {
 };
 
 struct SceneObjectFrame {
-	uint8_t *data;
+	const uint8_t *data; // compressed, in the scene arena or the file mapping
 	SceneObjectFrameHeader hdr;
 	int (*decode)(const uint8_t *, uint8_t *);
 };
 
+struct DecodedFrame {
+	uint8_t *data;
+	uint16_t *spans; // opaque runs of each row : count, (x, len) * count
+	uint32_t dataSize;
+	int16_t prev, next; // LRU list
+};
+
 struct BagObject {
 	char name[20];
 	uint8_t *data;
@@ -116,8 +150,16 @@ struct SceneObjectStatus {
 };
 
 struct Script {
-	uint8_t *data;
+	enum {
+		kMaxOperands = 256
+	};
+
+	const uint8_t *data;
+	int dataSize;
+	const ObjectScriptCode *code;
 	int dataOffset;
+	int operandsDataOffset;
+	int operandsBuffer[kMaxOperands]; // operands decoded by the interpreter
 	int testDataOffset;
 	int currentObjectNum;
 	bool objectFound;
@@ -131,17 +173,14 @@ struct Script {
 		return word;
 	}
 
-	const char *fetchNextString() {
-		int len = fetchNextWord();
-		assert(len >= 1);
-		const char *str = (const char *)(data + dataOffset);
-		dataOffset += len;
-		assert(len >= 1 && str[len - 1] == '\0');
-		return str;
+	const char *getString(int offset) const {
+		return (const char *)(data + offset);
 	}
 
-	const char *getString() {
-		return (const char *)(data + dataOffset);
+	// offset following the object name, the first operand of the current opcode
+	int getObjectNameEndDataOffset() const {
+		const int16_t len = READ_LE_UINT16(data + operandsDataOffset);
+		return operandsDataOffset + 2 + (len > 0 ? len : 0);
 	}
 };
 
@@ -201,13 +240,16 @@ enum {
 
 enum {
 	kCycleDelay = 50,
+	kDepthMaskNone = 255,
 	kGameScreenWidth = 640,
 	kGameScreenHeight = 480,
 	kDemoSavSlot = -1,
 	kOffsetBitmapInfo = 0,
 	kOffsetBitmapPalette = kOffsetBitmapInfo + 40,
 	kOffsetBitmapBits = kOffsetBitmapPalette + 256 * 4,
-	kBitmapBufferDefaultSize = 40 + 256 * 4 + 640 * 480 + 256 * 4
+	kBitmapBufferDefaultSize = 40 + 256 * 4 + 640 * 480 + 256 * 4,
+	kDecodedFramesCacheDefaultSize = 4 * 1024 * 1024,
+	kObjectNameUnresolved = -2
 };
 
 enum {
@@ -256,7 +298,8 @@ struct Game {
 		NUM_NEXT_SCENES = 20,
 		NUM_SCENE_OBJECT_STATUS = 200,
 		NUM_DIALOG_CHOICES = 10,
-		NUM_DIALOG_ENTRIES = 40
+		NUM_DIALOG_ENTRIES = 40,
+		NUM_DIRTY_RECTS = 64
 	};
 
 	Game(SystemStub *stub, const char *dataPath, const char *savePath, const char *musicPath);
@@ -308,32 +351,39 @@ struct Game {
 	void updateMouseButtonsPressed();
 	void updateKeysPressedTable();
 	void clearSceneData(int anim);
+	void releaseSceneData(int animationsCount, int framesCount);
 	void reinitializeObject(int object);
 	void updateObjects();
 	void runObjectsScript();
 	int findBagObjectByName(const char *objectName) const;
 	int getObjectTranslateXPos(int object, int dx1, int div, int dx2);
 	int getObjectTranslateYPos(int object, int dy1, int div, int dy2);
-	int findObjectByName(int currentObjectNum, int defaultObjectNum, bool *objectFlag);
+	int findObjectByName(int name, int currentObjectNum, int defaultObjectNum, bool *objectFlag);
+	const uint8_t *decodeSceneObjectFrame(int num, const uint16_t **spans = 0);
+	void unloadDecodedFrame(int num);
+	void clearDecodedFrames(int first);
 	void sortObjects();
 	void copyBufferToBuffer(int x, int y, int w, int h, SceneBitmap *src, SceneBitmap *dst);
 	void drawBox(int x, int y, int w, int h, SceneBitmap *src, SceneBitmap *dst, int startColor, int endColor);
-	void drawObject(int x, int y, const uint8_t *src, SceneBitmap *dst);
-	void drawObjectVerticalFlip(int x, int y, const uint8_t *src, SceneBitmap *dst);
-	void redrawObjectBoxes(int previousObject, int currentObject);
+	void updateRenderBoxes();
+	void buildDepthMask();
+	int getDepthMaskLevel(int z) const;
+	void drawScreenObject(int x, int y, const uint8_t *src);
+	void addDirtyRect(int x, int y, int w, int h);
+	void updateDirtyRects();
 	void redrawObjects();
 	void playVideo(const char *name);
 	void displayTitleBitmap();
 	void stopMusic();
 	void playMusic(const char *name);
 	void changeObjectMotionFrame(int object, int object2, int useObject2, int count1, int count2, int useDx, int dx, int useDy, int dy);
-	int16_t getObjectTransformXPos(int object);
-	int16_t getObjectTransformYPos(int object);
-	bool comparePrevObjectTransformXPos(int object, bool fetchCmp = true, int cmpX = -1);
-	bool compareObjectTransformXPos(int object, bool fetchCmp = true, int cmpX = -1);
-	bool comparePrevObjectTransformYPos(int object, bool fetchCmp = true, int cmpY = -1);
-	bool compareObjectTransformYPos(int object, bool fetchCmp = true, int cmpY = -1);
-	void setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2);
+	int16_t getObjectTransformXPos(int object, const int *args);
+	int16_t getObjectTransformYPos(int object, const int *args);
+	bool comparePrevObjectTransformXPos(int object, const int *args, bool fetchCmp = true, int cmpX = -1);
+	bool compareObjectTransformXPos(int object, const int *args, bool fetchCmp = true, int cmpX = -1);
+	bool comparePrevObjectTransformYPos(int object, const int *args, bool fetchCmp = true, int cmpY = -1);
+	bool compareObjectTransformYPos(int object, const int *args, bool fetchCmp = true, int cmpY = -1);
+	bool setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2, const int *args);
 	bool intersectsBox(int num, int index, int x1, int y1, int x2, int y2);
 
 	// menu.cpp
@@ -342,89 +392,93 @@ struct Game {
 	void handleMenu();
 
 	// opcodes.cpp
-	bool executeConditionOpcode(int num);
-	void executeOperatorOpcode(int num);
-	void evalExpr(int16_t *val);
-	bool testExpr(int16_t val);
-	bool cop_true();
-	bool cop_isInRandomRange();
-	bool cop_isKeyPressed();
-	bool cop_isKeyNotPressed();
-	bool cop_testMouseButtons();
-	bool cop_isObjectInScene();
-	bool cop_testObjectPrevState();
-	bool cop_testObjectState();
-	bool cop_isObjectInRect();
-	bool cop_testPrevObjectTransformXPos();
-	bool cop_testObjectTransformXPos();
-	bool cop_testPrevObjectTransformYPos();
-	bool cop_testObjectTransformYPos();
-	bool cop_testObjectPrevFlip();
-	bool cop_testObjectFlip();
-	bool cop_testObjectPrevFrameNum();
-	bool cop_testObjectFrameNum();
-	bool cop_testPrevMotionNum();
-	bool cop_testMotionNum();
-	bool cop_testObjectVar();
-	bool cop_testObjectAndObjectXPos();
-	bool cop_testObjectAndObjectYPos();
-	bool cop_testObjectMotionYPos();
-	bool cop_testVar();
-	bool cop_isCurrentBagAction();
-	bool cop_isObjectInBox();
-	bool cop_isObjectNotInBox();
-	bool cop_isObjectNotIntersectingBox();
-	bool cop_isCurrentBagObject();
-	bool cop_isLifeBarDisplayed();
-	bool cop_isLifeBarNotDisplayed();
-	bool cop_testLastDialogue();
-	bool cop_isNextScene();
-	void oop_initializeObject();
-	void oop_evalCurrentObjectX();
-	void oop_evalCurrentObjectY();
-	void oop_evalObjectX();
-	void oop_evalObjectY();
-	void oop_evalObjectZ();
-	void oop_setObjectFlip();
-	void oop_adjustObjectPos_vv0000();
-	void oop_adjustObjectPos_vv1v00();
-	void oop_adjustObjectPos_vv1v1v();
-	void oop_setupObjectPos_121();
-	void oop_setupObjectPos_122();
-	void oop_setupObjectPos_123();
-	void oop_adjustObjectPos_1v0000();
-	void oop_adjustObjectPos_1v1v1v();
-	void oop_setupObjectPos_021();
-	void oop_setupObjectPos_022();
-	void oop_setupObjectPos_023();
-	void oop_evalObjectVar();
-	void oop_translateObjectXPos();
-	void oop_translateObjectYPos();
-	void oop_setObjectMode();
-	void oop_setObjectInitPos();
-	void oop_setObjectTransformInitPos();
-	void oop_evalObjectXInit();
-	void oop_evalObjectYInit();
-	void oop_evalObjectZInit();
-	void oop_setObjectFlipInit();
-	void oop_setObjectCel();
-	void oop_resetObjectCel();
-	void oop_evalVar();
-	void oop_getSceneNumberInVar();
-	void oop_disableBox();
-	void oop_enableBox();
-	void oop_evalBoxesXPos();
-	void oop_evalBoxesYPos();
-	void oop_setBoxToObject();
-	void oop_clipBoxes();
-	void oop_saveObjectStatus();
-	void oop_addObjectToBag();
-	void oop_removeObjectFromBag();
-	void oop_playSoundLowerEqualPriority();
-	void oop_playSoundLowerPriority();
-	void oop_startDialogue();
-	void oop_switchSceneClearBoxes();
-	void oop_switchSceneCopyBoxes();
+	ObjectScriptCode *compileObjectScript(const uint8_t *data, int dataSize);
+	void resolveObjectScriptNames(ObjectScriptCode *code, const uint8_t *data);
+	void executeObjectScriptCode(const ObjectScriptCode *code);
+	bool executeObjectScriptStatement(const ObjectScriptCode *code, int statement);
+	bool executeObjectScriptConditions();
+	bool executeObjectScriptOperators(int endOfStatementDataOffset);
+	void evalExpr(int16_t *val, const int *args);
+	bool testExpr(int16_t val, const int *args);
+	bool cop_true(const int *args);
+	bool cop_isInRandomRange(const int *args);
+	bool cop_isKeyPressed(const int *args);
+	bool cop_isKeyNotPressed(const int *args);
+	bool cop_testMouseButtons(const int *args);
+	bool cop_isObjectInScene(const int *args);
+	bool cop_testObjectPrevState(const int *args);
+	bool cop_testObjectState(const int *args);
+	bool cop_isObjectInRect(const int *args);
+	bool cop_testPrevObjectTransformXPos(const int *args);
+	bool cop_testObjectTransformXPos(const int *args);
+	bool cop_testPrevObjectTransformYPos(const int *args);
+	bool cop_testObjectTransformYPos(const int *args);
+	bool cop_testObjectPrevFlip(const int *args);
+	bool cop_testObjectFlip(const int *args);
+	bool cop_testObjectPrevFrameNum(const int *args);
+	bool cop_testObjectFrameNum(const int *args);
+	bool cop_testPrevMotionNum(const int *args);
+	bool cop_testMotionNum(const int *args);
+	bool cop_testObjectVar(const int *args);
+	bool cop_testObjectAndObjectXPos(const int *args);
+	bool cop_testObjectAndObjectYPos(const int *args);
+	bool cop_testObjectMotionYPos(const int *args);
+	bool cop_testVar(const int *args);
+	bool cop_isCurrentBagAction(const int *args);
+	bool cop_isObjectInBox(const int *args);
+	bool cop_isObjectNotInBox(const int *args);
+	bool cop_isObjectNotIntersectingBox(const int *args);
+	bool cop_isCurrentBagObject(const int *args);
+	bool cop_isLifeBarDisplayed(const int *args);
+	bool cop_isLifeBarNotDisplayed(const int *args);
+	bool cop_testLastDialogue(const int *args);
+	bool cop_isNextScene(const int *args);
+	void oop_initializeObject(const int *args);
+	void oop_evalCurrentObjectX(const int *args);
+	void oop_evalCurrentObjectY(const int *args);
+	void oop_evalObjectX(const int *args);
+	void oop_evalObjectY(const int *args);
+	void oop_evalObjectZ(const int *args);
+	void oop_setObjectFlip(const int *args);
+	void oop_adjustObjectPos_vv0000(const int *args);
+	void oop_adjustObjectPos_vv1v00(const int *args);
+	void oop_adjustObjectPos_vv1v1v(const int *args);
+	void oop_setupObjectPos_121(const int *args);
+	void oop_setupObjectPos_122(const int *args);
+	void oop_setupObjectPos_123(const int *args);
+	void oop_adjustObjectPos_1v0000(const int *args);
+	void oop_adjustObjectPos_1v1v1v(const int *args);
+	void oop_setupObjectPos_021(const int *args);
+	void oop_setupObjectPos_022(const int *args);
+	void oop_setupObjectPos_023(const int *args);
+	void oop_evalObjectVar(const int *args);
+	void oop_translateObjectXPos(const int *args);
+	void oop_translateObjectYPos(const int *args);
+	void oop_setObjectMode(const int *args);
+	void oop_setObjectInitPos(const int *args);
+	void oop_setObjectTransformInitPos(const int *args);
+	void oop_evalObjectXInit(const int *args);
+	void oop_evalObjectYInit(const int *args);
+	void oop_evalObjectZInit(const int *args);
+	void oop_setObjectFlipInit(const int *args);
+	void oop_setObjectCel(const int *args);
+	void oop_resetObjectCel(const int *args);
+	void oop_evalVar(const int *args);
+	void oop_getSceneNumberInVar(const int *args);
+	void oop_disableBox(const int *args);
+	void oop_enableBox(const int *args);
+	void oop_evalBoxesXPos(const int *args);
+	void oop_evalBoxesYPos(const int *args);
+	void oop_setBoxToObject(const int *args);
+	void oop_clipBoxes(const int *args);
+	void oop_saveObjectStatus(const int *args);
+	void oop_addObjectToBag(const int *args);
+	void oop_removeObjectFromBag(const int *args);
+	void oop_playSoundLowerEqualPriority(const int *args);
+	void oop_playSoundLowerPriority(const int *args);
+	void oop_startDialogue(const int *args);
+	void oop_switchSceneClearBoxes(const int *args);
+	void oop_switchSceneCopyBoxes(const int *args);
 
 	// parser_scn.cpp
 	void parseSCN(const char *fileName);
@@ -438,6 +492,7 @@ struct Game {
 	void loadCommonSprites();
 	void unloadCommonSprites();
 	uint8_t *loadFile(const char *fileName, uint8_t *dst = 0, uint32_t *dstSize = 0);
+	int decodeWGPChunks(const uint8_t *src, int srcSize, uint8_t *dst);
 	void loadWGP(const char *fileName);
 	void loadSPR(const char *fileName, SceneAnimation *sa);
 	void loadMOV(const char *fileName);
@@ -450,6 +505,8 @@ struct Game {
 
 	// win16.cpp (temporary helpers)
 	int win16_sndPlaySound(int op, void *data = 0);
+	bool isSceneSoundBuffer(const char *fileName) const;
+	void preloadSoundBuffers(int first, int count);
 	void win16_stretchBits(SceneBitmap *bits, int srcHeight, int srcWidth, int srcY, int srcX, int dstHeight, int dstWidth, int dstY, int dstX);
 
 	int _nextState, _state;
@@ -460,6 +517,12 @@ struct Game {
 	RandomGenerator _rnd;
 	SystemStub *_stub;
 	Mixer *_mixer;
+	ThreadPool _threadPool;
+	BackgroundThread _backgroundThread;
+	int _threadsCount; // 0 to use all processors for decoding and a single compositor band
+	Compositor _compositor;
+	ScriptProfiler _scriptProfiler;
+	InputRecorder _inputRecorder;
 	const char *_dataPath;
 	const char *_savePath;
 	const char *_musicPath;
@@ -560,16 +623,39 @@ struct Game {
 	char _currentSceneSav[128]; // non interactive parts of the demo relies on savestates
 	int _bagPosX, _bagPosY;
 	SceneObject *_sortedSceneObjectsTable[NUM_SCENE_OBJECTS];
+	int16_t _sortedSceneObjectsZTable[NUM_SCENE_OBJECTS]; // objects z when last sorted
+	int _sortedSceneObjectsCount;
 	SceneObject _sceneObjectsTable[NUM_SCENE_OBJECTS];
 	int _sceneObjectsCount;
+	uint32_t _sceneObjectsGeneration; // incremented when the objects table changes
 	SceneAnimation _animationsTable[NUM_SCENE_ANIMATIONS];
 	int _animationsCount;
+	Arena _sceneArena; // sprite frames and object scripts
+	ArenaMark _animationsArenaMarkTable[NUM_SCENE_ANIMATIONS];
 	SoundBuffer _soundBuffersTable[NUM_SOUND_BUFFERS];
 	int _soundBuffersCount;
 	Box _boxesTable[NUM_BOXES][10];
 	int _boxesCountTable[NUM_BOXES];
+	Box *_renderBoxesTable[10 * 10]; // foreground boxes, by decreasing z
+	int _renderBoxesCount;
+	Box _renderBoxesCopyTable[10][10]; // boxes the render list was built from
+	int _renderBoxesCopyCountTable[10];
+	uint8_t *_depthMask; // per pixel index in _depthMaskZTable of the nearest foreground box
+	int16_t _depthMaskZTable[10 * 10]; // foreground boxes z, increasing
+	int _depthMaskZCount;
+	bool _depthMaskDirty;
 	SceneObjectFrame _sceneObjectFramesTable[NUM_SCENE_OBJECT_FRAMES];
 	int _sceneObjectFramesCount;
+	DecodedFrame _decodedFramesTable[NUM_SCENE_OBJECT_FRAMES];
+	int _decodedFramesHead, _decodedFramesTail;
+	uint32_t _decodedFramesSize;
+	uint32_t _decodedFramesMaxSize;
+	Rect _dirtyRectsTable[NUM_DIRTY_RECTS];
+	int _dirtyRectsCount;
+	Rect _previousDirtyRectsTable[NUM_DIRTY_RECTS];
+	int _previousDirtyRectsCount;
+	bool _dirtyFullScreen;
+	uint32_t _dirtyPixelsCount;
 	BagObject _bagObjectsTable[NUM_BAG_OBJECTS];
 	int _bagObjectsCount;
 	SceneObjectMotion _sceneObjectMotionsTable[NUM_SCENE_MOTIONS];
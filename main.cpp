@@ -9,6 +9,7 @@
 #include <emscripten.h>
 #endif
 #include "game.h"
+#include "scheduler.h"
 #include "systemstub.h"
 
 static const char *USAGE =
@@ -18,14 +19,53 @@ static const char *USAGE =
 	"  --savepath=PATH    Path to save files (default '.')\n"
 	"  --musicpath=PATH   Path to music files (default 'MUSIC')\n"
 	"  --fullscreen       Fullscreen display\n"
-	"  --widescreen=MODE  Widescreen mode ('default', '4:3' or '16:9')\n";
+	"  --widescreen=MODE  Widescreen mode ('default', '4:3' or '16:9')\n"
+	"  --framecache=KB    Decoded sprite frames cache size (default 4096)\n"
+	"  --profile=FILE     Write object scripts profile to FILE (.csv or .json)\n"
+	"  --record=FILE      Record player input and frame hashes to FILE\n"
+	"  --trace=FILE       Write main loop phases timings to FILE (Chrome trace .json)\n"
+	"  --threads=N        Worker threads for decoding and screen compositing (default: decoding on all processors)\n"
+	"  --readbuffer=KB    Read ahead buffer size of the data files (default 64, 0 disables it)\n"
+#ifdef BERMUDA_HEADLESS
+	"  --replay=FILE      Replay recorded player input from FILE at full speed\n"
+	"  --input=FILE       Read scripted input events from FILE\n"
+	"  --audio=FILE       Write mixed audio (22 khz S16 stereo) to FILE\n"
+	"  --duration=MS      Quit after MS milliseconds of game time\n"
+#endif
+	;
 
 static Game *g_game;
 static SystemStub *g_stub;
+#ifdef BERMUDA_HEADLESS
+static char *g_inputPath;
+static char *g_audioPath;
+static int g_duration;
+#endif
 
-static void init(const char *dataPath, const char *savePath, const char *musicPath, bool fullscreen, int screenMode) {
+static void init(const char *dataPath, const char *savePath, const char *musicPath, bool fullscreen, int screenMode, int frameCacheSize, int threadsCount, const char *profilePath, const char *recordPath, const char *replayPath, const char *tracePath) {
+#ifdef BERMUDA_HEADLESS
+	g_stub = SystemStub_Null_create(g_inputPath, g_audioPath, g_duration);
+#else
 	g_stub = SystemStub_SDL_create();
+#endif
 	g_game = new Game(g_stub, dataPath ? dataPath : "DATA", savePath ? savePath : ".", musicPath ? musicPath : "MUSIC");
+	if (frameCacheSize >= 0) {
+		g_game->_decodedFramesMaxSize = frameCacheSize * 1024;
+	}
+	if (threadsCount > 0) {
+		g_game->_threadsCount = threadsCount;
+	}
+	if (profilePath) {
+		g_game->_scriptProfiler.init(profilePath);
+	}
+	if (tracePath) {
+		g_traceProfiler.init(tracePath);
+	}
+	if (replayPath) {
+		g_game->_inputRecorder.initReplay(replayPath, &g_game->_rnd);
+	} else if (recordPath) {
+		g_game->_inputRecorder.initRecord(recordPath, &g_game->_rnd);
+	}
 	g_game->init(fullscreen, screenMode);
 }
 
@@ -34,6 +74,7 @@ static void fini() {
 	delete g_game;
 	delete g_stub;
 	g_stub = 0;
+	g_traceProfiler.fini();
 }
 
 #ifdef __EMSCRIPTEN__
@@ -51,6 +92,12 @@ int main(int argc, char *argv[]) {
 	char *musicPath = 0;
 	bool fullscreen = false;
 	int screenMode = SCREEN_MODE_DEFAULT;
+	int frameCacheSize = -1;
+	int threadsCount = -1;
+	char *profilePath = 0;
+	char *recordPath = 0;
+	char *replayPath = 0;
+	char *tracePath = 0;
 	if (argc == 2) {
 		// data path as the only command line argument
 		struct stat st;
@@ -65,6 +112,18 @@ int main(int argc, char *argv[]) {
 			{ "musicpath",  required_argument, 0, 3 },
 			{ "fullscreen", no_argument,       0, 4 },
 			{ "widescreen", required_argument, 0, 5 },
+			{ "framecache", required_argument, 0, 6 },
+			{ "profile",    required_argument, 0, 7 },
+			{ "record",     required_argument, 0, 8 },
+			{ "trace",      required_argument, 0, 10 },
+			{ "threads",    required_argument, 0, 11 },
+			{ "readbuffer", required_argument, 0, 15 },
+#ifdef BERMUDA_HEADLESS
+			{ "replay",     required_argument, 0, 9 },
+			{ "input",      required_argument, 0, 12 },
+			{ "audio",      required_argument, 0, 13 },
+			{ "duration",   required_argument, 0, 14 },
+#endif
 			{ "help",       no_argument,       0, 0 },
 			{ 0, 0, 0, 0 }
 		};
@@ -104,30 +163,88 @@ int main(int argc, char *argv[]) {
 				}
 			}
 			break;
+		case 6:
+			frameCacheSize = atoi(optarg);
+			break;
+		case 7:
+			profilePath = strdup(optarg);
+			break;
+		case 8:
+			recordPath = strdup(optarg);
+			break;
+		case 10:
+			tracePath = strdup(optarg);
+			break;
+		case 11:
+			threadsCount = atoi(optarg);
+			break;
+		case 15:
+			// set before the Game constructor opens the first files
+			File::_readBufferSize = MAX(atoi(optarg), 0) * 1024;
+			break;
+#ifdef BERMUDA_HEADLESS
+		case 9:
+			// the sounds end on the audio device clock with 'bs', the game ticks waiting for them would differ
+			replayPath = strdup(optarg);
+			break;
+		case 12:
+			g_inputPath = strdup(optarg);
+			break;
+		case 13:
+			g_audioPath = strdup(optarg);
+			break;
+		case 14:
+			g_duration = atoi(optarg);
+			break;
+#endif
 		default:
 			fprintf(stdout, "%s", USAGE);
 			return 0;
 		}
 	}
 	g_debugMask = DBG_INFO; // | DBG_GAME | DBG_OPCODES | DBG_DIALOGUE;
-	init(dataPath, savePath, musicPath, fullscreen, screenMode);
+	init(dataPath, savePath, musicPath, fullscreen, screenMode, frameCacheSize, threadsCount, profilePath, recordPath, replayPath, tracePath);
 #ifdef __EMSCRIPTEN__
 	emscripten_set_main_loop(mainLoop, kCycleDelay, 0);
 #else
-	uint32_t lastFrameTimeStamp = g_stub->getTimeStamp();
+#ifdef BERMUDA_HEADLESS
+	const uint64_t startTime = ScriptProfiler::getTime();
+	uint32_t ticksCount = 0;
+#endif
+	TickScheduler scheduler;
+	scheduler.init(g_stub, kCycleDelay);
 	while (!g_stub->_quit) {
 		g_game->mainLoop();
-		const uint32_t end = lastFrameTimeStamp + kCycleDelay;
-		do {
-			g_stub->sleep(10);
+#ifdef BERMUDA_HEADLESS
+		++ticksCount;
+		if (g_game->_inputRecorder._mode == InputRecorder::kModeReplay) {
+			// no frame pacing when replaying, the stub clock still advances a cycle
+			g_stub->sleep(kCycleDelay);
 			g_stub->processEvents();
-		} while (!g_stub->_pi.fastMode && g_stub->getTimeStamp() < end);
-		lastFrameTimeStamp = g_stub->getTimeStamp();
+			continue;
+		}
+#endif
+		TraceScope traceWait("waitNextTick");
+		scheduler.waitNextTick();
 	}
+	scheduler.dumpStats();
+#ifdef BERMUDA_HEADLESS
+	const uint64_t elapsed = ScriptProfiler::getTime() - startTime;
+	fprintf(stdout, "%d ticks, %d ms game time, %.3f s real time, %.1f ticks/sec\n",
+		ticksCount, g_stub->getTimeStamp(), elapsed / 1000000000., elapsed ? ticksCount * 1000000000. / elapsed : 0.);
+#endif
 	fini();
 #endif
 	free(dataPath);
 	free(savePath);
 	free(musicPath);
+	free(profilePath);
+	free(recordPath);
+	free(replayPath);
+	free(tracePath);
+#ifdef BERMUDA_HEADLESS
+	free(g_inputPath);
+	free(g_audioPath);
+#endif
 	return 0;
 }
@@ -1,6 +1,7 @@
 
 #include <libretro.h>
 
+#include "blitter.h"
 #include "file.h"
 #include "game.h"
 #include "mixer.h"
@@ -27,6 +28,7 @@ struct SystemStub_libretro: SystemStub {
 	uint32_t _palette[256];
 	uint32_t *_offscreenBuffer;
 	int _w, _h;
+	const Blitter *_blitter;
 	Mixer *_mixer;
 	AudioCallback _audioProc;
 	void *_audioData;
@@ -45,6 +47,7 @@ struct SystemStub_libretro: SystemStub {
 		_offscreenBuffer = (uint32_t *)malloc(w * h * sizeof(uint32_t));
 		_w = w;
 		_h = h;
+		_blitter = getBlitter();
 		_mixer->open();
 	}
 	virtual void destroy() {
@@ -71,10 +74,8 @@ struct SystemStub_libretro: SystemStub {
 		uint32_t *dst = _offscreenBuffer + y * _w + x;
 		const uint32_t rgb = _palette[color];
 		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				dst[i] = rgb;
-			}
-			dst += w;
+			_blitter->fill32(dst, w, rgb);
+			dst += _w;
 		}
 	}
 	virtual void copyRect(int x, int y, int w, int h, const uint8_t *buf, int pitch, bool transparent = false) {
@@ -82,27 +83,22 @@ struct SystemStub_libretro: SystemStub {
 		uint32_t *dst = _offscreenBuffer + y * _w + x;
 		buf += (h - 1) * pitch;
 		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				if (!transparent || buf[i] != 0) {
-					dst[i] = _palette[buf[i]];
-				}
+			if (transparent) {
+				_blitter->expandPaletteTransparent(dst, buf, w, _palette);
+			} else {
+				_blitter->expandPalette(dst, buf, w, _palette);
 			}
 			dst += _w;
 			buf -= pitch;
 		}
-        }
+	}
 	virtual void darkenRect(int x, int y, int w, int h) {
 		assert(x >= 0 && x + w <= _w && y >= 0 && y + h <= _h);
-		const uint32_t redBlueMask = 0xFF00FF;
-		const uint32_t greenMask = 0xFF00;
+		const uint32_t mask = getDarkenMask(0xFF00FF, 0xFF00);
 		uint32_t *dst = _offscreenBuffer + y * _w + x;
 		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				uint32_t color = ((dst[i] & redBlueMask) >> 1) & redBlueMask;
-				color |= ((dst[i] & greenMask) >> 1) & greenMask;
-				dst[i] = color;
-			}
-			dst += w;
+			_blitter->darken32(dst, w, mask);
+			dst += _w;
 		}
 	}
 
@@ -123,6 +119,8 @@ struct SystemStub_libretro: SystemStub {
 
 	virtual void processEvents() {
 	}
+	virtual void waitEvents(int timeout) {
+	}
 	virtual void sleep(int duration) {
 	}
 	virtual uint32_t getTimeStamp() {
@@ -25,8 +25,10 @@ void Game::initMenu(int num) {
 
 void Game::finiMenu() {
 	if (_currentSceneWgp[0]) {
+		releaseSceneData(_animationsCount - 1, _menuObjectFrames);
 		--_animationsCount;
 		_sceneObjectsCount = _menuObjectCount;
+		++_sceneObjectsGeneration;
 		_sceneObjectMotionsCount = _menuObjectMotion;
 		_sceneObjectFramesCount = _menuObjectFrames;
 		const int state = _loadDataState;
@@ -97,10 +99,11 @@ void Game::handleMenu() {
 	}
 
 	if (_menuHighlight != -1) {
-		SceneObjectFrame *sof = &_sceneObjectFramesTable[_sceneObjectMotionsTable[_menuObjectMotion].firstFrameIndex + _menuHighlight];
-		sof->decode(sof->data, _tempDecodeBuffer);
+		const int num = _sceneObjectMotionsTable[_menuObjectMotion].firstFrameIndex + _menuHighlight;
+		SceneObjectFrame *sof = &_sceneObjectFramesTable[num];
+		const uint8_t *frameData = decodeSceneObjectFrame(num);
 		const int yPos = _bitmapBuffer1.h + 1 - sof->hdr.yPos - sof->hdr.h;
-		drawObject(sof->hdr.xPos, yPos, _tempDecodeBuffer, &_bitmapBuffer1);
+		drawObject(sof->hdr.xPos, yPos, frameData, &_bitmapBuffer1);
 	}
 
 	_stub->copyRect(0, 0, kGameScreenWidth, kGameScreenHeight, _bitmapBuffer1.bits, _bitmapBuffer1.pitch);
@@ -20,7 +20,17 @@ struct Mixer {
 	virtual void open() = 0;
 	virtual void close() = 0;
 
-	virtual void playSound(File *f, int *id) = 0;
+	// when name is not null, the decoded sound is kept in the cache under that name
+	virtual void playSound(File *f, int *id, const char *name = 0) = 0;
+	// returns false if no sound was cached under that name
+	virtual bool playCachedSound(const char *name, int *id) = 0;
+	// releases the cached sounds not listed
+	virtual void trimSoundsCache(const char *const *names, int count) = 0;
+	virtual bool isSoundCached(const char *name) = 0;
+	// returns false if the sounds cannot be decoded ahead of their first play
+	virtual bool canPreloadSounds() = 0;
+	// decodes a sound for a later playCachedSound, can be called from any thread
+	virtual void preloadSound(File *f, const char *name) = 0;
 	virtual void playMusic(File *f, int *id) = 0;
 	virtual bool isSoundPlaying(int id) = 0;
 	virtual void stopSound(int id) = 0;
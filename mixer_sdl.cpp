@@ -4,25 +4,135 @@
 #include <SDL_mixer.h>
 #include "file.h"
 #include "mixer.h"
+#include "thread.h"
 #include "util.h"
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+typedef Sint64 RWOffset;
+typedef size_t RWCount;
+#else
+typedef int RWOffset;
+typedef int RWCount;
+#endif
+
+// read only SDL_RWops over a File, the data is not copied and romfs entries are handled
+
+static RWOffset File_RWseek(SDL_RWops *rw, RWOffset offset, int whence) {
+	File *f = (File *)rw->hidden.unknown.data1;
+	switch (whence) {
+	case RW_SEEK_CUR:
+		offset += f->tell();
+		break;
+	case RW_SEEK_END:
+		offset += f->size();
+		break;
+	}
+	f->seek(offset, SEEK_SET);
+	return f->tell();
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+static RWOffset File_RWsize(SDL_RWops *rw) {
+	return ((File *)rw->hidden.unknown.data1)->size();
+}
+#endif
+
+static RWCount File_RWread(SDL_RWops *rw, void *ptr, RWCount size, RWCount maxnum) {
+	if (size == 0) {
+		return 0;
+	}
+	return ((File *)rw->hidden.unknown.data1)->read(ptr, size * maxnum) / size;
+}
+
+static RWCount File_RWwrite(SDL_RWops *rw, const void *ptr, RWCount size, RWCount num) {
+	SDL_SetError("File_RWwrite not supported");
+	return 0;
+}
+
+static int File_RWclose(SDL_RWops *rw) {
+	SDL_FreeRW(rw);
+	return 0;
+}
+
+// the File is deleted with the SDL_RWops
+static int File_RWcloseFile(SDL_RWops *rw) {
+	File *f = (File *)rw->hidden.unknown.data1;
+	f->close();
+	delete f;
+	SDL_FreeRW(rw);
+	return 0;
+}
+
+static SDL_RWops *File_RWFromFile(File *f, bool ownFile) {
+	SDL_RWops *rw = SDL_AllocRW();
+	if (rw) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		rw->size = File_RWsize;
+		rw->type = SDL_RWOPS_UNKNOWN;
+#endif
+		rw->seek = File_RWseek;
+		rw->read = File_RWread;
+		rw->write = File_RWwrite;
+		rw->close = ownFile ? File_RWcloseFile : File_RWclose;
+		rw->hidden.unknown.data1 = f;
+	}
+	return rw;
+}
+
+static Mix_Chunk *loadChunk(File *f) {
+	SDL_RWops *rw = File_RWFromFile(f, false);
+	if (!rw) {
+		return 0;
+	}
+	Mix_Chunk *chunk = Mix_LoadWAV_RW(rw, 1);
+	if (!chunk) {
+		warning("Failed to load sound, %s", Mix_GetError());
+	}
+	return chunk;
+}
+
 struct MixerSDL: Mixer {
 
 	static const int kMixFreq = 22050;
 	static const int kMixBufSize = 4096;
 	static const int kChannels = 4;
+	static const int kMaxCachedChunks = 64;
+
+	struct CachedChunk {
+		char *name;
+		Mix_Chunk *chunk;
+		uint32_t lastUse;
+	};
 
 	bool _isOpen;
 	Mix_Chunk *_sounds[kChannels];
+	bool _ownedSounds[kChannels]; // chunk freed with the channel, false if in the cache
+	CachedChunk _cachedChunksTable[kMaxCachedChunks];
+	int _cachedChunksCount;
+	uint32_t _chunksUseCounter;
+	Mutex _preloadMutex;
+	CachedChunk _preloadedChunksTable[kMaxCachedChunks];
+	int _preloadedChunksCount;
 	Mix_Music *_music;
 	uint8_t *_musicBuf;
 
 	MixerSDL()
-		: _isOpen(false), _music(0), _musicBuf(0) {
+		: _isOpen(false), _cachedChunksCount(0), _chunksUseCounter(0), _preloadedChunksCount(0), _music(0), _musicBuf(0) {
 		memset(_sounds, 0, sizeof(_sounds));
+		memset(_ownedSounds, 0, sizeof(_ownedSounds));
 	}
 
 	virtual ~MixerSDL() {
+		for (int i = 0; i < kChannels; ++i) {
+			releaseChannel(i);
+		}
+		while (_cachedChunksCount != 0) {
+			uncacheChunk(0);
+		}
+		for (int i = 0; i < _preloadedChunksCount; ++i) {
+			free(_preloadedChunksTable[i].name);
+			Mix_FreeChunk(_preloadedChunksTable[i].chunk);
+		}
 	}
 
 	virtual void open() {
@@ -43,72 +153,213 @@ struct MixerSDL: Mixer {
 		_isOpen = false;
 	}
 
-	virtual void playSound(File *f, int *id) {
-		debug(DBG_MIXER, "MixerSDL::playSound() path '%s'", f->_path);
-		Mix_Chunk *chunk = Mix_LoadWAV(f->_path);
-		if (chunk) {
-			const int ch = Mix_PlayChannel(-1, chunk, 0);
-			if (ch >= 0 && ch < kChannels) {
-				if (_sounds[ch]) {
-					Mix_FreeChunk(_sounds[ch]);
+	void releaseChannel(int ch) {
+		Mix_Chunk *chunk = _sounds[ch];
+		const bool owned = _ownedSounds[ch];
+		_sounds[ch] = 0;
+		_ownedSounds[ch] = false;
+		if (chunk && owned) {
+			for (int i = 0; i < kChannels; ++i) {
+				if (_sounds[i] == chunk) {
+					// still played by another channel
+					_ownedSounds[i] = true;
+					return;
 				}
-				_sounds[ch] = chunk;
-			} else {
-				warning("Sound playing on channel %d (max %d)", ch, kChannels);
 			}
-			*id = ch;
+			Mix_FreeChunk(chunk);
+		}
+	}
+
+	void playChunk(Mix_Chunk *chunk, bool owned, int *id) {
+		const int ch = Mix_PlayChannel(-1, chunk, 0);
+		if (ch >= 0 && ch < kChannels) {
+			releaseChannel(ch);
+			_sounds[ch] = chunk;
+			_ownedSounds[ch] = owned;
 		} else {
+			warning("Sound playing on channel %d (max %d)", ch, kChannels);
+			if (ch < 0 && owned) {
+				Mix_FreeChunk(chunk);
+			}
+		}
+		*id = ch;
+	}
+
+	virtual void playSound(File *f, int *id, const char *name) {
+		debug(DBG_MIXER, "MixerSDL::playSound() name '%s'", name ? name : "");
+		Mix_Chunk *chunk = loadChunk(f);
+		if (!chunk) {
 			*id = -1;
+			return;
+		}
+		if (name && !findCachedChunk(name) && cacheChunk(chunk, name)) {
+			playChunk(chunk, false, id);
+		} else {
+			playChunk(chunk, true, id);
 		}
 	}
-	virtual void playMusic(File *f, int *id) {
-		debug(DBG_MIXER, "MixerSDL::playSoundMusic() path '%s'", f->_path);
-		stopMusic();
-		const char *ext = strrchr(f->_path, '.');
-		if (ext) {
-			if (strcasecmp(ext, ".ogg") != 0 && strcasecmp(ext, ".mid") != 0) {
-				loadMusic(f);
-				*id = -1;
-				return;
+	virtual bool playCachedSound(const char *name, int *id) {
+		adoptPreloadedChunks();
+		Mix_Chunk *chunk = findCachedChunk(name);
+		if (!chunk) {
+			return false;
+		}
+		debug(DBG_MIXER, "MixerSDL::playCachedSound() name '%s'", name);
+		playChunk(chunk, false, id);
+		return true;
+	}
+	virtual void trimSoundsCache(const char *const *names, int count) {
+		adoptPreloadedChunks();
+		for (int i = 0; i < _cachedChunksCount; ) {
+			bool found = false;
+			for (int j = 0; j < count; ++j) {
+				if (strcmp(_cachedChunksTable[i].name, names[j]) == 0) {
+					found = true;
+					break;
+				}
+			}
+			if (found) {
+				++i;
+			} else {
+				uncacheChunk(i);
 			}
 		}
-		playMusic(f->_path);
-		*id = -1;
+		debug(DBG_MIXER, "MixerSDL::trimSoundsCache() %d chunks", _cachedChunksCount);
 	}
-	virtual bool isSoundPlaying(int id) {
-		return Mix_Playing(id) != 0;
+	virtual bool isSoundCached(const char *name) {
+		adoptPreloadedChunks();
+		return findCachedChunk(name) != 0;
 	}
-	virtual void stopSound(int id) {
-		debug(DBG_MIXER, "MixerSDL::stopSound()");
-		Mix_HaltChannel(id);
-		if (id >= 0 && id < kChannels && _sounds[id]) {
-			Mix_FreeChunk(_sounds[id]);
-			_sounds[id] = 0;
+	virtual bool canPreloadSounds() {
+		return true;
+	}
+	virtual void preloadSound(File *f, const char *name) {
+		Mix_Chunk *chunk = loadChunk(f);
+		if (!chunk) {
+			return;
+		}
+		MutexLock lock(_preloadMutex);
+		char *chunkName = strdup(name);
+		if (chunkName && _preloadedChunksCount < kMaxCachedChunks) {
+			CachedChunk *cc = &_preloadedChunksTable[_preloadedChunksCount++];
+			cc->name = chunkName;
+			cc->chunk = chunk;
+			cc->lastUse = 0;
+		} else {
+			free(chunkName);
+			Mix_FreeChunk(chunk);
+		}
+	}
+
+	// moves the chunks loaded by preloadSound to the cache, only the game thread updates the cache
+	void adoptPreloadedChunks() {
+		MutexLock lock(_preloadMutex);
+		for (int i = 0; i < _preloadedChunksCount; ++i) {
+			CachedChunk *cc = &_preloadedChunksTable[i];
+			if (findCachedChunk(cc->name) || !cacheChunk(cc->chunk, cc->name)) {
+				Mix_FreeChunk(cc->chunk);
+			}
+			free(cc->name);
+		}
+		_preloadedChunksCount = 0;
+	}
+
+	Mix_Chunk *findCachedChunk(const char *name) {
+		for (int i = 0; i < _cachedChunksCount; ++i) {
+			CachedChunk *cc = &_cachedChunksTable[i];
+			if (strcmp(cc->name, name) == 0) {
+				cc->lastUse = ++_chunksUseCounter;
+				return cc->chunk;
+			}
+		}
+		return 0;
+	}
+
+	bool cacheChunk(Mix_Chunk *chunk, const char *name) {
+		char *chunkName = strdup(name);
+		if (!chunkName) {
+			return false;
+		}
+		if (_cachedChunksCount >= kMaxCachedChunks) {
+			// evict the least recently played chunk
+			int lru = 0;
+			for (int i = 1; i < _cachedChunksCount; ++i) {
+				if (_cachedChunksTable[i].lastUse < _cachedChunksTable[lru].lastUse) {
+					lru = i;
+				}
+			}
+			uncacheChunk(lru);
 		}
+		CachedChunk *cc = &_cachedChunksTable[_cachedChunksCount++];
+		cc->name = chunkName;
+		cc->chunk = chunk;
+		cc->lastUse = ++_chunksUseCounter;
+		return true;
 	}
 
-	void loadMusic(File *f) {
+	void uncacheChunk(int i) {
+		Mix_Chunk *chunk = _cachedChunksTable[i].chunk;
+		free(_cachedChunksTable[i].name);
+		_cachedChunksTable[i] = _cachedChunksTable[--_cachedChunksCount];
+		bool playing = false;
+		for (int ch = 0; ch < kChannels; ++ch) {
+			if (_sounds[ch] == chunk) {
+				if (!Mix_Playing(ch)) {
+					_sounds[ch] = 0;
+				} else if (!playing) {
+					// the channel releases the chunk once done
+					_ownedSounds[ch] = true;
+					playing = true;
+				}
+			}
+		}
+		if (!playing) {
+			Mix_FreeChunk(chunk);
+		}
+	}
+
+	virtual void playMusic(File *f, int *id) {
+		debug(DBG_MIXER, "MixerSDL::playMusic() path '%s'", f->_path);
+		stopMusic();
+		*id = -1;
+		const char *ext = strrchr(f->_path, '.');
+		if (ext && strcasecmp(ext, ".ogg") == 0) {
+			// the digital soundtracks are streamed, the File is owned by the mixer
+			SDL_RWops *rw = File_RWFromFile(f, true);
+			if (rw) {
+				playMusic(Mix_LoadMUSType_RW(rw, MUS_OGG, 1));
+			} else {
+				delete f;
+			}
+			return;
+		}
+		// the midi files are closed by the caller, keep a copy of the data
 		_musicBuf = (uint8_t *)malloc(f->size());
 		if (_musicBuf) {
 			const int size = f->read(_musicBuf, f->size());
 			SDL_RWops *rw = SDL_RWFromConstMem(_musicBuf, size);
 			if (rw) {
-				_music = Mix_LoadMUSType_RW(rw, MUS_MID, 1);
-				if (_music) {
-					Mix_PlayMusic(_music, 0);
-				} else {
-					warning("Failed to load music, %s", Mix_GetError());
-				}
+				playMusic(Mix_LoadMUSType_RW(rw, MUS_MID, 1));
 			}
 		}
 	}
+	virtual bool isSoundPlaying(int id) {
+		return Mix_Playing(id) != 0;
+	}
+	virtual void stopSound(int id) {
+		debug(DBG_MIXER, "MixerSDL::stopSound()");
+		Mix_HaltChannel(id);
+		if (id >= 0 && id < kChannels) {
+			releaseChannel(id);
+		}
+	}
 
-	void playMusic(const char *path) {
-		_music = Mix_LoadMUS(path);
+	void playMusic(Mix_Music *music) {
+		_music = music;
 		if (_music) {
 			Mix_PlayMusic(_music, 0);
 		} else {
-			warning("Failed to load music '%s', %s", path, Mix_GetError());
+			warning("Failed to load music, %s", Mix_GetError());
 		}
 	}
 	void stopMusic() {
@@ -135,6 +386,9 @@ struct MixerSDL: Mixer {
 	virtual void stopAll() {
 		debug(DBG_MIXER, "MixerSDL::stopAll()");
 		Mix_HaltChannel(-1);
+		for (int i = 0; i < kChannels; ++i) {
+			releaseChannel(i);
+		}
 		stopMusic();
 	}
 };
@@ -3,9 +3,12 @@
  * Copyright (C) 2007-2011 Gregory Montoir
  */
 
+#include "blitter.h"
 #include "file.h"
 #include "mixer.h"
+#include "profiler.h"
 #include "systemstub.h"
+#include "thread.h"
 #ifdef BERMUDA_VORBIS
 #include <vorbis/vorbisfile.h>
 #endif
@@ -27,110 +30,193 @@ struct LockAudioStack {
 	SystemStub *_stub;
 };
 
-static void mixSample(int16_t &dst, int sample, int volume) {
-	int pcm = dst + ((sample * volume) >> 8);
-	if (pcm < -32768) {
-		pcm = -32768;
-	} else if (pcm > 32767) {
-		pcm = 32767;
-	}
-	dst = (int16_t)pcm;
+static inline void mixSample(int32_t &dst, int sample, int volume) {
+	dst += (sample * volume) >> 8;
 }
 
+// the channels add their samples to a 32 bits stereo buffer, saturated to 16 bits once all are mixed
 struct MixerChannel {
 	virtual ~MixerChannel() {}
 	virtual bool load(File *f, int mixerSampleRate) = 0;
-	virtual int read(int16_t *dst, int samples) = 0;
+	virtual int read(int32_t *dst, int samples) = 0;
 	int id;
 };
 
-struct MixerChannel_Wav : MixerChannel {
-	MixerChannel_Wav()
-		: _buf(0), _bufSize(0), _bufReadOffset(0), _bufReadStep(0) {
+// sent by the game thread to the audio callback
+struct MixerCommand {
+	enum {
+		kStart,
+		kStop,
+		kStopAll
+	};
+	int type;
+	int channel;
+	int id;
+	MixerChannel *mc;
+};
+
+// 16 bits samples at the mixer rate, shared by the channels playing the sound
+struct MixerSound {
+	char *name; // 0 if not in the cache or the preloaded sounds
+	int16_t *samples;
+	int samplesCount;
+	bool stereo;
+	int size;
+	int refsCount; // channels playing the sound, only updated on the game thread
+	uint32_t lastUse;
+};
+
+static void freeSound(MixerSound *sound) {
+	free(sound->name);
+	free(sound->samples);
+	free(sound);
+}
+
+template <int kBits>
+static inline int readWavSample(const uint8_t *buf, int index) {
+	if (kBits == 8) {
+		return (buf[index] << 8) - 32768;
+	} else {
+		return (int16_t)READ_LE_UINT16(buf + index * 2);
 	}
+}
 
-	virtual ~MixerChannel_Wav() {
-		if (_buf) {
-			free(_buf);
-			_buf = 0;
+// stereo files read the left and right samples at successive steps of the fixed point offset
+template <int kBits, bool kStereo>
+static void convertWav(int16_t *dst, int count, const uint8_t *buf, uint32_t offset, uint32_t step) {
+	for (int i = 0; i < count; ++i) {
+		*dst++ = readWavSample<kBits>(buf, offset >> _fracStepBits);
+		offset += step;
+		if (kStereo) {
+			*dst++ = readWavSample<kBits>(buf, offset >> _fracStepBits);
+			offset += step;
 		}
 	}
+}
 
-	virtual bool load(File *f, int mixerSampleRate) {
-		char buf[8];
-		f->seek(8); // skip RIFF header
-		f->read(buf, 8);
-		if (memcmp(buf, "WAVEfmt ", 8) == 0) {
-			f->readUint32LE(); // fmtLength
-			int compression = f->readUint16LE();
-			int channels = f->readUint16LE();
-			int sampleRate = f->readUint32LE();
-			f->readUint32LE(); // averageBytesPerSec
-			f->readUint16LE(); // blockAlign
-			_bitsPerSample = f->readUint16LE();
-			if (compression != 1 ||
-			    (channels != 1 && channels != 2) ||
-			    (sampleRate != 11025 && sampleRate != 22050 && sampleRate != 44100) ||
-			    (_bitsPerSample != 8 && _bitsPerSample != 16)) {
-				warning("Unhandled wav/pcm format compression %d channels %d rate %d bits %d", compression, channels, sampleRate, _bitsPerSample);
-				return false;
+template <bool kStereo>
+static void mixSound(int32_t *dst, int count, const int16_t *src, int volume) {
+	for (int i = 0; i < count; ++i) {
+		if (kStereo) {
+			mixSample(dst[0], src[0], volume);
+			mixSample(dst[1], src[1], volume);
+			src += 2;
+		} else {
+			mixSample(dst[0], src[0], volume);
+			mixSample(dst[1], src[0], volume);
+			++src;
+		}
+		dst += 2;
+	}
+}
+
+static MixerSound *decodeWav(File *f, int mixerSampleRate) {
+	char buf[8];
+	f->seek(8); // skip RIFF header
+	f->read(buf, 8);
+	if (memcmp(buf, "WAVEfmt ", 8) != 0) {
+		return 0;
+	}
+	f->readUint32LE(); // fmtLength
+	const int compression = f->readUint16LE();
+	const int channels = f->readUint16LE();
+	const int sampleRate = f->readUint32LE();
+	f->readUint32LE(); // averageBytesPerSec
+	f->readUint16LE(); // blockAlign
+	const int bitsPerSample = f->readUint16LE();
+	if (compression != 1 ||
+	    (channels != 1 && channels != 2) ||
+	    (sampleRate != 11025 && sampleRate != 22050 && sampleRate != 44100) ||
+	    (bitsPerSample != 8 && bitsPerSample != 16)) {
+		warning("Unhandled wav/pcm format compression %d channels %d rate %d bits %d", compression, channels, sampleRate, bitsPerSample);
+		return 0;
+	}
+	f->read(buf, 4);
+	if (memcmp(buf, "data", 4) != 0) {
+		return 0;
+	}
+	const uint32_t dataSize = f->readUint32LE();
+	uint8_t *data = (uint8_t *)malloc(dataSize);
+	if (!data) {
+		return 0;
+	}
+	f->read(data, dataSize);
+	const bool stereo = (channels == 2);
+	const uint32_t step = (sampleRate << _fracStepBits) / mixerSampleRate;
+	// number of output samples before the end of the data
+	const uint32_t end = (dataSize / (bitsPerSample / 8)) << _fracStepBits;
+	const uint32_t reads = (end + step - 1) / step;
+	const int count = stereo ? reads / 2 : reads;
+	MixerSound *sound = (MixerSound *)calloc(1, sizeof(MixerSound));
+	if (sound) {
+		sound->size = count * (stereo ? 2 : 1) * sizeof(int16_t);
+		sound->samples = (int16_t *)malloc(sound->size);
+		if (!sound->samples) {
+			free(sound);
+			sound = 0;
+		}
+	}
+	if (sound) {
+		sound->samplesCount = count;
+		sound->stereo = stereo;
+		if (bitsPerSample == 8) {
+			if (stereo) {
+				convertWav<8, true>(sound->samples, count, data, 0, step);
+			} else {
+				convertWav<8, false>(sound->samples, count, data, 0, step);
 			}
-			_stereo = (channels == 2);
-			_bufReadStep = (sampleRate << _fracStepBits) / mixerSampleRate;
-			f->read(buf, 4);
-			if (memcmp(buf, "data", 4) == 0) {
-				_bufSize = f->readUint32LE();
-				_buf = (uint8_t *)malloc(_bufSize);
-				if (_buf) {
-					f->read(_buf, _bufSize);
-					return true;
-				}
+		} else {
+			if (stereo) {
+				convertWav<16, true>(sound->samples, count, data, 0, step);
+			} else {
+				convertWav<16, false>(sound->samples, count, data, 0, step);
 			}
 		}
-		return false;
 	}
+	free(data);
+	return sound;
+}
 
-	bool readSample(int16_t &sample) {
-		switch (_bitsPerSample) {
-		case 8:
-			if ((_bufReadOffset >> _fracStepBits) >= _bufSize) { // end of buffer
-				return false;
-			}
-			sample = (_buf[_bufReadOffset >> _fracStepBits] << 8) ^ 0x8000;
-			break;
-		case 16:
-			if ((_bufReadOffset >> _fracStepBits) * 2 >= _bufSize) { // end of buffer
-				return false;
+struct MixerChannel_Wav : MixerChannel {
+	MixerChannel_Wav(MixerSound *sound = 0)
+		: _sound(sound), _samplesOffset(0) {
+		if (_sound) {
+			++_sound->refsCount;
+		}
+	}
+
+	virtual ~MixerChannel_Wav() {
+		if (_sound) {
+			--_sound->refsCount;
+			if (_sound->refsCount == 0 && !_sound->name) {
+				freeSound(_sound);
 			}
-			sample = READ_LE_UINT16(&_buf[(_bufReadOffset >> _fracStepBits) * 2]);
-			break;
+			_sound = 0;
+		}
+	}
+
+	virtual bool load(File *f, int mixerSampleRate) {
+		_sound = decodeWav(f, mixerSampleRate);
+		if (!_sound) {
+			return false;
 		}
-		_bufReadOffset += _bufReadStep;
+		++_sound->refsCount;
 		return true;
 	}
 
-	virtual int read(int16_t *dst, int samples) {
-		for (int i = 0; i < samples; ++i) {
-			int16_t sampleL = 0, sampleR;
-			if (!readSample(sampleL)) {
-				return i;
-			}
-			sampleR = sampleL;
-			if (_stereo && !readSample(sampleR)) {
-				return i;
-			}
-			mixSample(*dst++, sampleL, _sfxVolume);
-			mixSample(*dst++, sampleR, _sfxVolume);
+	virtual int read(int32_t *dst, int samples) {
+		const int count = MIN(samples, _sound->samplesCount - _samplesOffset);
+		if (_sound->stereo) {
+			mixSound<true>(dst, count, _sound->samples + _samplesOffset * 2, _sfxVolume);
+		} else {
+			mixSound<false>(dst, count, _sound->samples + _samplesOffset, _sfxVolume);
 		}
-		return samples;
+		_samplesOffset += count;
+		return count;
 	}
 
-	uint8_t *_buf;
-	int _bufSize;
-	int _bufReadOffset;
-	int _bufReadStep;
-	int _bitsPerSample;
-	bool _stereo;
+	MixerSound *_sound;
+	int _samplesOffset;
 };
 
 #ifdef BERMUDA_VORBIS
@@ -190,7 +276,7 @@ struct MixerChannel_Vorbis : MixerChannel {
 		return true;
 	}
 
-	virtual int read(int16_t *dst, int samples) {
+	virtual int read(int32_t *dst, int samples) {
 		int dstSize = samples * sizeof(int16_t) * 2;
 		if (dstSize > _readBufSize) {
 			_readBufSize = dstSize;
@@ -264,7 +350,7 @@ struct MixerChannel_StbVorbis : MixerChannel {
 		}
 		return false;
 	}
-	virtual int read(int16_t *dst, int samples) {
+	virtual int read(int32_t *dst, int samples) {
 		int total = 0;
 		if (_decodedSamplesLen != 0) {
 			const int len = MIN(_decodedSamplesLen, samples);
@@ -338,25 +424,59 @@ struct MixerChannel_StbVorbis : MixerChannel {
 };
 #endif
 
+// The channels are started and stopped by commands queued to the audio callback,
+// which hands the channels done playing back to the game thread to be deleted.
+// Neither thread waits on the other, the audio lock is only taken if the queue is full.
 struct MixerSoftware: Mixer {
 	static const int kMaxChannels = 4;
+	static const int kMaxCachedSounds = 64;
+	static const int kSoundsCacheSize = 4 * 1024 * 1024;
+	static const int kMaxCommands = 64;
 
 	SystemStub *_stub;
 	int _channelIdSeed;
 	bool _open;
+	bool _musicMix; // the audio callback is replaced by setMusicMix
+	int _channelsIds[kMaxChannels]; // sound playing on the channel, cleared by the audio callback once done
+	SpscQueue<MixerCommand, kMaxCommands> _commandsQueue;
+	// a channel is created after the queue is emptied, the queue holds at most the started and playing ones
+	SpscQueue<MixerChannel *, kMaxCommands + kMaxChannels + 1> _doneChannelsQueue;
+	// only accessed from the audio callback, or the game thread when the callback is not running
 	MixerChannel *_channels[kMaxChannels];
+	int32_t *_mixBuf;
+	int _mixBufSize;
+	const Blitter *_blitter;
+	MixerSound *_cachedSoundsTable[kMaxCachedSounds];
+	int _cachedSoundsCount;
+	int _cachedSoundsSize;
+	uint32_t _soundsUseCounter;
+	Mutex _preloadMutex;
+	MixerSound *_preloadedSoundsTable[kMaxCachedSounds];
+	int _preloadedSoundsCount;
 
 	MixerSoftware(SystemStub *stub)
-		: _stub(stub), _channelIdSeed(0), _open(false) {
+		: _stub(stub), _channelIdSeed(0), _open(false), _musicMix(false), _mixBuf(0), _mixBufSize(0),
+		_cachedSoundsCount(0), _cachedSoundsSize(0), _soundsUseCounter(0), _preloadedSoundsCount(0) {
+		for (int i = 0; i < kMaxChannels; ++i) {
+			_channelsIds[i] = kDefaultSoundId;
+		}
 		memset(_channels, 0, sizeof(_channels));
+		_blitter = getBlitter();
 	}
 
 	virtual ~MixerSoftware() {
+		processCommands();
 		for (int i = 0; i < kMaxChannels; ++i) {
-			if (_channels[i]) {
-				delete _channels[i];
-			}
+			releaseChannel(i);
 		}
+		deleteDoneChannels();
+		while (_cachedSoundsCount != 0) {
+			uncacheSound(0);
+		}
+		for (int i = 0; i < _preloadedSoundsCount; ++i) {
+			freeSound(_preloadedSoundsTable[i]);
+		}
+		free(_mixBuf);
 	}
 
 	virtual void open() {
@@ -381,20 +501,152 @@ struct MixerSoftware: Mixer {
 		delete mc;
 	}
 
-	virtual void playSound(File *f, int *id) {
+	virtual void playSound(File *f, int *id, const char *name) {
 		debug(DBG_MIXER, "Mixer::playSound()");
-		LockAudioStack las(_stub);
-		startSound(f, id, new MixerChannel_Wav);
+		MixerChannel_Wav *mc = new MixerChannel_Wav;
+		if (!mc->load(f, _stub->getOutputSampleRate())) {
+			*id = kDefaultSoundId;
+			delete mc;
+			return;
+		}
+		if (name && !findCachedSound(name)) {
+			cacheSound(mc->_sound, name);
+		}
+		if (!bindChannel(mc, id)) {
+			*id = kDefaultSoundId;
+			delete mc;
+		}
+	}
+
+	virtual bool playCachedSound(const char *name, int *id) {
+		adoptPreloadedSounds();
+		MixerSound *sound = findCachedSound(name);
+		if (!sound) {
+			return false;
+		}
+		debug(DBG_MIXER, "Mixer::playCachedSound() '%s'", name);
+		MixerChannel *mc = new MixerChannel_Wav(sound);
+		if (!bindChannel(mc, id)) {
+			*id = kDefaultSoundId;
+			delete mc;
+		}
+		return true;
+	}
+
+	virtual void trimSoundsCache(const char *const *names, int count) {
+		// the sounds of the channels done playing can be released
+		deleteDoneChannels();
+		adoptPreloadedSounds();
+		for (int i = 0; i < _cachedSoundsCount; ) {
+			bool found = false;
+			for (int j = 0; j < count; ++j) {
+				if (strcmp(_cachedSoundsTable[i]->name, names[j]) == 0) {
+					found = true;
+					break;
+				}
+			}
+			if (found) {
+				++i;
+			} else {
+				uncacheSound(i);
+			}
+		}
+		debug(DBG_MIXER, "Mixer::trimSoundsCache() %d sounds, %d bytes", _cachedSoundsCount, _cachedSoundsSize);
+	}
+
+	virtual bool isSoundCached(const char *name) {
+		adoptPreloadedSounds();
+		return findCachedSound(name) != 0;
+	}
+
+	virtual bool canPreloadSounds() {
+		return true;
+	}
+
+	virtual void preloadSound(File *f, const char *name) {
+		MixerSound *sound = decodeWav(f, _stub->getOutputSampleRate());
+		if (!sound) {
+			return;
+		}
+		sound->name = strdup(name);
+		MutexLock lock(_preloadMutex);
+		if (sound->name && _preloadedSoundsCount < kMaxCachedSounds) {
+			_preloadedSoundsTable[_preloadedSoundsCount++] = sound;
+		} else {
+			freeSound(sound);
+		}
+	}
+
+	// moves the sounds decoded by preloadSound to the cache, only the game thread updates the cache
+	void adoptPreloadedSounds() {
+		MutexLock lock(_preloadMutex);
+		for (int i = 0; i < _preloadedSoundsCount; ++i) {
+			MixerSound *sound = _preloadedSoundsTable[i];
+			char *name = sound->name;
+			sound->name = 0;
+			if (!findCachedSound(name)) {
+				cacheSound(sound, name);
+			}
+			free(name);
+			if (!sound->name) {
+				freeSound(sound);
+			}
+		}
+		_preloadedSoundsCount = 0;
+	}
+
+	MixerSound *findCachedSound(const char *name) {
+		for (int i = 0; i < _cachedSoundsCount; ++i) {
+			MixerSound *sound = _cachedSoundsTable[i];
+			if (strcmp(sound->name, name) == 0) {
+				sound->lastUse = ++_soundsUseCounter;
+				return sound;
+			}
+		}
+		return 0;
+	}
+
+	void cacheSound(MixerSound *sound, const char *name) {
+		if (sound->size > kSoundsCacheSize) {
+			return;
+		}
+		while (_cachedSoundsCount >= kMaxCachedSounds || _cachedSoundsSize + sound->size > kSoundsCacheSize) {
+			// evict the least recently played sound
+			int lru = 0;
+			for (int i = 1; i < _cachedSoundsCount; ++i) {
+				if (_cachedSoundsTable[i]->lastUse < _cachedSoundsTable[lru]->lastUse) {
+					lru = i;
+				}
+			}
+			uncacheSound(lru);
+		}
+		sound->name = strdup(name);
+		if (!sound->name) {
+			return;
+		}
+		sound->lastUse = ++_soundsUseCounter;
+		_cachedSoundsTable[_cachedSoundsCount++] = sound;
+		_cachedSoundsSize += sound->size;
+	}
+
+	void uncacheSound(int i) {
+		MixerSound *sound = _cachedSoundsTable[i];
+		_cachedSoundsTable[i] = _cachedSoundsTable[--_cachedSoundsCount];
+		_cachedSoundsSize -= sound->size;
+		free(sound->name);
+		sound->name = 0;
+		// the sound is released by the last channel playing it
+		if (sound->refsCount == 0) {
+			freeSound(sound);
+		}
 	}
 
 	virtual void playMusic(File *f, int *id) {
 		debug(DBG_MIXER, "Mixer::playMusic()");
 #ifdef BERMUDA_VORBIS
-		LockAudioStack las(_stub);
 		startSound(f, id, new MixerChannel_Vorbis);
 #endif
 #ifdef BERMUDA_STB_VORBIS
-		LockAudioStack las(_stub);
 		startSound(f, id, new MixerChannel_StbVorbis);
 #endif
 	}
@@ -404,11 +656,9 @@ struct MixerSoftware: Mixer {
 		if (id == kDefaultSoundId) {
 			return false;
 		}
-		LockAudioStack las(_stub);
 		const int channel = getChannelFromSoundId(id);
 		assert(channel >= 0 && channel < kMaxChannels);
-		MixerChannel *mc = _channels[channel];
-		return (mc && mc->id == id);
+		return atomicLoad(&_channelsIds[channel]) == id;
 	}
 
 	virtual void stopSound(int id) {
@@ -416,29 +666,28 @@ struct MixerSoftware: Mixer {
 		if (id == kDefaultSoundId) {
 			return;
 		}
-		LockAudioStack las(_stub);
 		const int channel = getChannelFromSoundId(id);
 		assert(channel >= 0 && channel < kMaxChannels);
-		MixerChannel *mc = _channels[channel];
-		if (mc && mc->id == id) {
-			delete mc;
-			_channels[channel] = 0;
+		if (atomicCompareAndSwap(&_channelsIds[channel], id, kDefaultSoundId)) {
+			MixerCommand cmd = { MixerCommand::kStop, channel, id, 0 };
+			pushCommand(cmd);
 		}
+		deleteDoneChannels();
 	}
 
 	virtual void stopAll() {
 		debug(DBG_MIXER, "Mixer::stopAll()");
-		LockAudioStack las(_stub);
 		for (int i = 0; i < kMaxChannels; ++i) {
-			if (_channels[i]) {
-				delete _channels[i];
-				_channels[i] = 0;
-			}
+			atomicStore(&_channelsIds[i], kDefaultSoundId);
 		}
+		MixerCommand cmd = { MixerCommand::kStopAll, 0, kDefaultSoundId, 0 };
+		pushCommand(cmd);
+		deleteDoneChannels();
 	}
 
 	virtual void setMusicMix(void *param, void (*mix)(void *, uint8_t *, int)) {
 		_stub->stopAudio();
+		_musicMix = (mix != 0);
 		if (mix) {
 			_stub->startAudio(mix, param);
 		} else {
@@ -448,19 +697,31 @@ struct MixerSoftware: Mixer {
 
 	void mix(int16_t *buf, int len) {
 		assert((len & 1) == 0);
-		memset(buf, 0, len * sizeof(int16_t));
+		processCommands();
+		if (len > _mixBufSize) {
+			free(_mixBuf);
+			_mixBuf = (int32_t *)malloc(len * sizeof(int32_t));
+			if (!_mixBuf) {
+				_mixBufSize = 0;
+				memset(buf, 0, len * sizeof(int16_t));
+				return;
+			}
+			_mixBufSize = len;
+		}
+		memset(_mixBuf, 0, len * sizeof(int32_t));
 		for (int i = 0; i < kMaxChannels; ++i) {
 			MixerChannel *mc = _channels[i];
 			if (mc) {
-				if (mc->read(buf, len / 2) <= 0) {
-					delete mc;
-					_channels[i] = 0;
+				if (mc->read(_mixBuf, len / 2) <= 0) {
+					releaseChannel(i);
 				}
 			}
 		}
+		_blitter->clipS16(buf, _mixBuf, len);
 	}
 
 	static void mixCallback(void *param, uint8_t *buf, int len) {
+		TraceScope trace("mix", TraceProfiler::kThreadAudio);
 		assert((len & 1) == 0);
 		((MixerSoftware *)param)->mix((int16_t *)buf, len / 2);
 	}
@@ -477,21 +738,71 @@ struct MixerSoftware: Mixer {
 	}
 
 	bool bindChannel(MixerChannel *mc, int *id) {
+		deleteDoneChannels();
 		for (int i = 0; i < kMaxChannels; ++i) {
-			if (!_channels[i]) {
-				_channels[i] = mc;
+			if (atomicLoad(&_channelsIds[i]) == kDefaultSoundId) {
 				*id = mc->id = generateSoundId(i);
+				atomicStore(&_channelsIds[i], *id);
+				MixerCommand cmd = { MixerCommand::kStart, i, *id, mc };
+				pushCommand(cmd);
 				return true;
 			}
 		}
 		return false;
 	}
 
-	void unbindChannel(int channel) {
-		assert(channel >= 0 && channel < kMaxChannels);
-		if (_channels[channel]) {
-			delete _channels[channel];
+	void pushCommand(const MixerCommand &cmd) {
+		if (!_commandsQueue.push(cmd)) {
+			// the audio callback is late, process the queued commands with the device locked
+			LockAudioStack las(_stub);
+			processCommands();
+			_commandsQueue.push(cmd);
+		}
+		if (!_open || _musicMix) {
+			// the audio callback is not running
+			processCommands();
+		}
+	}
+
+	void processCommands() {
+		MixerCommand cmd;
+		while (_commandsQueue.pop(&cmd)) {
+			switch (cmd.type) {
+			case MixerCommand::kStart:
+				releaseChannel(cmd.channel);
+				_channels[cmd.channel] = cmd.mc;
+				break;
+			case MixerCommand::kStop:
+				if (_channels[cmd.channel] && _channels[cmd.channel]->id == cmd.id) {
+					releaseChannel(cmd.channel);
+				}
+				break;
+			case MixerCommand::kStopAll:
+				for (int i = 0; i < kMaxChannels; ++i) {
+					releaseChannel(i);
+				}
+				break;
+			}
+		}
+	}
+
+	// hands the channel to the game thread, which deletes it and updates the sound reference count
+	void releaseChannel(int channel) {
+		MixerChannel *mc = _channels[channel];
+		if (mc) {
 			_channels[channel] = 0;
+			// a new sound may have been started on the channel
+			atomicCompareAndSwap(&_channelsIds[channel], mc->id, kDefaultSoundId);
+			if (!_doneChannelsQueue.push(mc)) {
+				warning("Mixer::releaseChannel() queue is full");
+			}
+		}
+	}
+
+	void deleteDoneChannels() {
+		MixerChannel *mc;
+		while (_doneChannelsQueue.pop(&mc)) {
+			delete mc;
 		}
 	}
 };
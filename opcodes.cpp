@@ -7,103 +7,452 @@
 #include "decoder.h"
 #include "systemstub.h"
 
-bool Game::executeConditionOpcode(int num) {
-	switch (num) {
-	case    10: return cop_true();
-	case   100: return cop_isInRandomRange();
-	case   500: return cop_isKeyPressed();
-	case   510: return cop_isKeyNotPressed();
-	case  1100: return cop_testMouseButtons();
-	case  2500: return cop_isObjectInScene();
-	case  3000: return cop_testObjectPrevState();
-	case  3010: return cop_testObjectState();
-	case  3050: return cop_isObjectInRect();
-	case  3100: return cop_testPrevObjectTransformXPos();
-	case  3105: return cop_testObjectTransformXPos();
-	case  3110: return cop_testPrevObjectTransformYPos();
-	case  3150: return cop_testObjectTransformYPos();
-	case  3300: return cop_testObjectPrevFlip();
-	case  3310: return cop_testObjectFlip();
-	case  3400: return cop_testObjectPrevFrameNum();
-	case  3410: return cop_testObjectFrameNum();
-	case  3500: return cop_testPrevMotionNum();
-	case  3510: return cop_testMotionNum();
-	case  3600: return cop_testObjectVar();
-	case  3700: return cop_testObjectAndObjectXPos();
-	case  3710: return cop_testObjectAndObjectYPos();
-	case  4110: return cop_testObjectMotionYPos();
-	case  6000: return cop_testVar();
-	case  6500: return cop_isCurrentBagAction();
-	case  7000: return cop_isObjectInBox();
-	case  7500: return cop_isObjectNotInBox();
-	case  8500: return cop_isObjectNotIntersectingBox();
-	case 10000: return cop_isCurrentBagObject();
-	case 20000: return cop_isLifeBarDisplayed();
-	case 20010: return cop_isLifeBarNotDisplayed();
-	case 25000: return cop_testLastDialogue();
-	case 30000: return cop_isNextScene();
-	default:
-		error("Invalid condition %d", num);
+// operands encoding : 'w' word, 'n' object name, 's' string, 't' test expression, 'e' eval expression, 'm' object mode
+struct ConditionOpcode {
+	int num;
+	bool (Game::*proc)(const int *args);
+	const char *operands;
+};
+
+static const ConditionOpcode _conditionOpcodesTable[] = {
+	{    10, &Game::cop_true, "" },
+	{   100, &Game::cop_isInRandomRange, "w" },
+	{   500, &Game::cop_isKeyPressed, "w" },
+	{   510, &Game::cop_isKeyNotPressed, "w" },
+	{  1100, &Game::cop_testMouseButtons, "w" },
+	{  2500, &Game::cop_isObjectInScene, "n" },
+	{  3000, &Game::cop_testObjectPrevState, "nw" },
+	{  3010, &Game::cop_testObjectState, "nw" },
+	{  3050, &Game::cop_isObjectInRect, "nwwww" },
+	{  3100, &Game::cop_testPrevObjectTransformXPos, "nwwwwwww" },
+	{  3105, &Game::cop_testObjectTransformXPos, "nwwwwwww" },
+	{  3110, &Game::cop_testPrevObjectTransformYPos, "nwwwwwww" },
+	{  3150, &Game::cop_testObjectTransformYPos, "nwwwwwww" },
+	{  3300, &Game::cop_testObjectPrevFlip, "nw" },
+	{  3310, &Game::cop_testObjectFlip, "nw" },
+	{  3400, &Game::cop_testObjectPrevFrameNum, "nt" },
+	{  3410, &Game::cop_testObjectFrameNum, "nt" },
+	{  3500, &Game::cop_testPrevMotionNum, "nt" },
+	{  3510, &Game::cop_testMotionNum, "nt" },
+	{  3600, &Game::cop_testObjectVar, "wnt" },
+	{  3700, &Game::cop_testObjectAndObjectXPos, "nwwwwwwnwwwwww" },
+	{  3710, &Game::cop_testObjectAndObjectYPos, "nwwwwwwnwwwwww" },
+	{  4110, &Game::cop_testObjectMotionYPos, "nww" },
+	{  6000, &Game::cop_testVar, "wt" },
+	{  6500, &Game::cop_isCurrentBagAction, "w" },
+	{  7000, &Game::cop_isObjectInBox, "wnwwwwwwwwwwww" },
+	{  7500, &Game::cop_isObjectNotInBox, "wnwwwwwwwwwwww" },
+	{  8500, &Game::cop_isObjectNotIntersectingBox, "wnwwwwwwnwwwwww" },
+	{ 10000, &Game::cop_isCurrentBagObject, "s" },
+	{ 20000, &Game::cop_isLifeBarDisplayed, "" },
+	{ 20010, &Game::cop_isLifeBarNotDisplayed, "" },
+	{ 25000, &Game::cop_testLastDialogue, "t" },
+	{ 30000, &Game::cop_isNextScene, "w" },
+	{ -1, 0, 0 }
+};
+
+struct OperatorOpcode {
+	int num;
+	void (Game::*proc)(const int *args);
+	const char *operands;
+};
+
+static const OperatorOpcode _operatorOpcodesTable[] = {
+	{  3000, &Game::oop_initializeObject, "nw" },
+	{  3100, &Game::oop_evalCurrentObjectX, "wwwe" },
+	{  3110, &Game::oop_evalCurrentObjectY, "wwwe" },
+	{  3120, &Game::oop_evalObjectX, "ne" },
+	{  3130, &Game::oop_evalObjectY, "ne" },
+	{  3200, &Game::oop_evalObjectZ, "ne" },
+	{  3300, &Game::oop_setObjectFlip, "nw" },
+	{  3400, &Game::oop_adjustObjectPos_vv0000, "nww" },
+	{  3410, &Game::oop_adjustObjectPos_vv1v00, "nwwww" },
+	{  3430, &Game::oop_adjustObjectPos_vv1v1v, "nwwww" },
+	{  3440, &Game::oop_setupObjectPos_121, "nwwwwwwww" },
+	{  3460, &Game::oop_setupObjectPos_122, "nwwwwwwwwwwwwww" },
+	{  3480, &Game::oop_setupObjectPos_123, "nwwwwwwwwww" },
+	{  3500, &Game::oop_adjustObjectPos_1v0000, "nw" },
+	{  3530, &Game::oop_adjustObjectPos_1v1v1v, "nwww" },
+	{  3540, &Game::oop_setupObjectPos_021, "nwwwwwww" },
+	{  3560, &Game::oop_setupObjectPos_022, "nwwwwwwwwwwwww" },
+	{  3580, &Game::oop_setupObjectPos_023, "nwwwwwwwww" },
+	{  4000, &Game::oop_evalObjectVar, "wne" },
+	{  4100, &Game::oop_translateObjectXPos, "nwwww" },
+	{  4200, &Game::oop_translateObjectYPos, "nwwww" },
+	{  5000, &Game::oop_setObjectMode, "nm" },
+	{  5100, &Game::oop_setObjectInitPos, "nww" },
+	{  5110, &Game::oop_setObjectTransformInitPos, "nwwwwww" },
+	{  5112, &Game::oop_evalObjectXInit, "ne" },
+	{  5114, &Game::oop_evalObjectYInit, "ne" },
+	{  5200, &Game::oop_evalObjectZInit, "ne" },
+	{  5300, &Game::oop_setObjectFlipInit, "nw" },
+	{  5400, &Game::oop_setObjectCel, "nww" },
+	{  5500, &Game::oop_resetObjectCel, "nw" },
+	{  6000, &Game::oop_evalVar, "we" },
+	{  6100, &Game::oop_getSceneNumberInVar, "w" },
+	{  7000, &Game::oop_disableBox, "ww" },
+	{  7010, &Game::oop_enableBox, "ww" },
+	{  7100, &Game::oop_evalBoxesXPos, "e" },
+	{  7110, &Game::oop_evalBoxesYPos, "e" },
+	{  7200, &Game::oop_setBoxToObject, "wwnwwwwwwwwwwww" },
+	{  7300, &Game::oop_clipBoxes, "wwww" },
+	{  8000, &Game::oop_saveObjectStatus, "w" },
+	{ 10000, &Game::oop_addObjectToBag, "n" },
+	{ 11000, &Game::oop_removeObjectFromBag, "s" },
+	{ 20000, &Game::oop_playSoundLowerEqualPriority, "ww" },
+	{ 20010, &Game::oop_playSoundLowerPriority, "ww" },
+	{ 25000, &Game::oop_startDialogue, "ssss" },
+	{ 30000, &Game::oop_switchSceneClearBoxes, "w" },
+	{ 30010, &Game::oop_switchSceneCopyBoxes, "w" },
+	{ -1, 0, 0 }
+};
+
+static int16_t readScriptWord(const uint8_t *data, int dataSize, int *offset) {
+	if (*offset < 0 || *offset + 2 > dataSize) {
+		*offset = -1;
+		return 0;
+	}
+	const int16_t word = READ_LE_UINT16(data + *offset);
+	*offset += 2;
+	return word;
+}
+
+static void addScriptOperand(int *args, int *argsCount, int value) {
+	if (args) {
+		args[*argsCount] = value;
+	}
+	++*argsCount;
+}
+
+// decodes the operands to args, the object names and strings are stored as their data offset, an object name
+// without string as -1 (default object) or 0 (current object), the ranges of a test expression follow their count.
+// returns the offset following the operands, -1 if they cannot be decoded statically
+static int decodeScriptOperands(const uint8_t *data, int dataSize, int offset, const char *operands, int *args, int *argsCount, uint16_t *names, int *namesCount) {
+	for (; *operands && offset >= 0; ++operands) {
+		int len, op;
+		switch (*operands) {
+		case 'w':
+			addScriptOperand(args, argsCount, readScriptWord(data, dataSize, &offset));
+			break;
+		case 'n':
+			len = readScriptWord(data, dataSize, &offset);
+			if (len < -1) {
+				return -1;
+			} else if (len <= 0) {
+				addScriptOperand(args, argsCount, len);
+			} else {
+				if (offset + len <= dataSize && data[offset + len - 1] == 0) {
+					if (names) {
+						names[*namesCount] = offset;
+					}
+					++*namesCount;
+				}
+				addScriptOperand(args, argsCount, offset);
+				offset += len;
+			}
+			break;
+		case 's':
+			len = readScriptWord(data, dataSize, &offset);
+			if (len < 1 || offset + len > dataSize || data[offset + len - 1] != 0) {
+				return -1;
+			}
+			addScriptOperand(args, argsCount, offset);
+			offset += len;
+			break;
+		case 't':
+			op = readScriptWord(data, dataSize, &offset);
+			addScriptOperand(args, argsCount, op);
+			if (op == -1) {
+				len = readScriptWord(data, dataSize, &offset);
+				if (len < 0) {
+					return -1;
+				}
+				addScriptOperand(args, argsCount, len);
+				for (int i = 0; i < len * 2 && offset >= 0; ++i) {
+					addScriptOperand(args, argsCount, readScriptWord(data, dataSize, &offset));
+				}
+			} else {
+				addScriptOperand(args, argsCount, readScriptWord(data, dataSize, &offset));
+			}
+			break;
+		case 'e':
+			addScriptOperand(args, argsCount, readScriptWord(data, dataSize, &offset));
+			addScriptOperand(args, argsCount, readScriptWord(data, dataSize, &offset));
+			break;
+		case 'm':
+			op = readScriptWord(data, dataSize, &offset);
+			addScriptOperand(args, argsCount, op);
+			addScriptOperand(args, argsCount, (op == 2) ? readScriptWord(data, dataSize, &offset) : 0);
+			break;
+		}
+		if (offset > dataSize) {
+			return -1;
+		}
 	}
-	return false;
+	return offset;
 }
 
-void Game::executeOperatorOpcode(int num) {
-	switch (num) {
-	case  3000: return oop_initializeObject();
-	case  3100: return oop_evalCurrentObjectX();
-	case  3110: return oop_evalCurrentObjectY();
-	case  3120: return oop_evalObjectX();
-	case  3130: return oop_evalObjectY();
-	case  3200: return oop_evalObjectZ();
-	case  3300: return oop_setObjectFlip();
-	case  3400: return oop_adjustObjectPos_vv0000();
-	case  3410: return oop_adjustObjectPos_vv1v00();
-	case  3430: return oop_adjustObjectPos_vv1v1v();
-	case  3440: return oop_setupObjectPos_121();
-	case  3460: return oop_setupObjectPos_122();
-	case  3480: return oop_setupObjectPos_123();
-	case  3500: return oop_adjustObjectPos_1v0000();
-	case  3530: return oop_adjustObjectPos_1v1v1v();
-	case  3540: return oop_setupObjectPos_021();
-	case  3560: return oop_setupObjectPos_022();
-	case  3580: return oop_setupObjectPos_023();
-	case  4000: return oop_evalObjectVar();
-	case  4100: return oop_translateObjectXPos();
-	case  4200: return oop_translateObjectYPos();
-	case  5000: return oop_setObjectMode();
-	case  5100: return oop_setObjectInitPos();
-	case  5110: return oop_setObjectTransformInitPos();
-	case  5112: return oop_evalObjectXInit();
-	case  5114: return oop_evalObjectYInit();
-	case  5200: return oop_evalObjectZInit();
-	case  5300: return oop_setObjectFlipInit();
-	case  5400: return oop_setObjectCel();
-	case  5500: return oop_resetObjectCel();
-	case  6000: return oop_evalVar();
-	case  6100: return oop_getSceneNumberInVar();
-	case  7000: return oop_disableBox();
-	case  7010: return oop_enableBox();
-	case  7100: return oop_evalBoxesXPos();
-	case  7110: return oop_evalBoxesYPos();
-	case  7200: return oop_setBoxToObject();
-	case  7300: return oop_clipBoxes();
-	case  8000: return oop_saveObjectStatus();
-	case 10000: return oop_addObjectToBag();
-	case 11000: return oop_removeObjectFromBag();
-	case 20000: return oop_playSoundLowerEqualPriority();
-	case 20010: return oop_playSoundLowerPriority();
-	case 25000: return oop_startDialogue();
-	case 30000: return oop_switchSceneClearBoxes();
-	case 30010: return oop_switchSceneCopyBoxes();
-	default:
-		error("Invalid operator %d", num);
+static int findConditionOpcode(int num) {
+	for (int i = 0; _conditionOpcodesTable[i].num != -1; ++i) {
+		if (_conditionOpcodesTable[i].num == num) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int findOperatorOpcode(int num) {
+	for (int i = 0; _operatorOpcodesTable[i].num != -1; ++i) {
+		if (_operatorOpcodesTable[i].num == num) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static bool addScriptInstruction(ObjectScriptInstruction *instructions, int *instructionsCount, int num, int dataOffset, int nextDataOffset, int firstOperand) {
+	if (nextDataOffset < 0 || *instructionsCount >= 0xFFFF || firstOperand > 0xFFFF) {
+		return false;
+	}
+	if (instructions) {
+		ObjectScriptInstruction *ins = &instructions[*instructionsCount];
+		ins->num = num;
+		ins->dataOffset = dataOffset;
+		ins->nextDataOffset = nextDataOffset;
+		ins->firstOperand = firstOperand;
+	}
+	++*instructionsCount;
+	return true;
+}
+
+// decodes the statements of a script, the tables are only filled if non null
+static bool parseObjectScript(const uint8_t *data, int dataSize, ObjectScriptStatement *statements, int *statementsCount, ObjectScriptInstruction *instructions, int *instructionsCount, int *operands, int *operandsCount, uint16_t *names, int *namesCount) {
+	*statementsCount = 0;
+	*instructionsCount = 0;
+	*operandsCount = 0;
+	*namesCount = 0;
+	int offset = 0;
+	while (offset < dataSize) {
+		const int statementDataOffset = offset;
+		const int endOfStatementDataOffset = readScriptWord(data, dataSize, &offset);
+		if (offset < 0 || endOfStatementDataOffset <= statementDataOffset || endOfStatementDataOffset > dataSize) {
+			return false;
+		}
+		ObjectScriptStatement st;
+		st.endDataOffset = endOfStatementDataOffset;
+		st.firstInstruction = *instructionsCount;
+		st.conditionsCount = 0;
+		st.operatorsCount = 0;
+		st.breakScript = false;
+		while (1) {
+			const int op = readScriptWord(data, dataSize, &offset);
+			if (offset < 0 || offset > endOfStatementDataOffset) {
+				return false;
+			}
+			if (op == 0) {
+				break;
+			}
+			const int num = findConditionOpcode(op);
+			if (num == -1) {
+				return false;
+			}
+			const int firstOperand = *operandsCount;
+			const int next = decodeScriptOperands(data, dataSize, offset, _conditionOpcodesTable[num].operands, operands, operandsCount, names, namesCount);
+			if (!addScriptInstruction(instructions, instructionsCount, num, offset, next, firstOperand)) {
+				return false;
+			}
+			++st.conditionsCount;
+			offset = next;
+		}
+		st.operatorsDataOffset = offset;
+		while (offset < endOfStatementDataOffset) {
+			const int op = readScriptWord(data, dataSize, &offset);
+			if (offset < 0) {
+				return false;
+			}
+			if (op == 100) { // &Game::oop_breakObjectScript
+				st.breakScript = true;
+				break;
+			}
+			const int num = findOperatorOpcode(op);
+			if (num == -1) {
+				return false;
+			}
+			const int firstOperand = *operandsCount;
+			const int next = decodeScriptOperands(data, dataSize, offset, _operatorOpcodesTable[num].operands, operands, operandsCount, names, namesCount);
+			if (!addScriptInstruction(instructions, instructionsCount, num, offset, next, firstOperand)) {
+				return false;
+			}
+			++st.operatorsCount;
+			offset = next;
+		}
+		if (offset > endOfStatementDataOffset) {
+			return false;
+		}
+		if (statements) {
+			statements[*statementsCount] = st;
+		}
+		++*statementsCount;
+		offset = endOfStatementDataOffset;
+	}
+	return true;
+}
+
+ObjectScriptCode *Game::compileObjectScript(const uint8_t *data, int dataSize) {
+	int statementsCount, instructionsCount, operandsCount, namesCount;
+	if (!parseObjectScript(data, dataSize, 0, &statementsCount, 0, &instructionsCount, 0, &operandsCount, 0, &namesCount)) {
+		warning("Unable to compile object script, using interpreter");
+		return 0;
+	}
+	ObjectScriptCode *code = (ObjectScriptCode *)_sceneArena.allocate(sizeof(ObjectScriptCode));
+	code->statementsCount = statementsCount;
+	code->statementsTable = (ObjectScriptStatement *)_sceneArena.allocate(statementsCount * sizeof(ObjectScriptStatement));
+	code->instructionsTable = (ObjectScriptInstruction *)_sceneArena.allocate(instructionsCount * sizeof(ObjectScriptInstruction));
+	code->operandsTable = (int *)_sceneArena.allocate(operandsCount * sizeof(int));
+	code->dataSize = dataSize;
+	code->namesCount = namesCount;
+	code->namesTable = (uint16_t *)_sceneArena.allocate(namesCount * sizeof(uint16_t));
+	code->objectsTable = (int8_t *)_sceneArena.allocate(dataSize);
+	memset(code->objectsTable, kObjectNameUnresolved, dataSize);
+	code->objectsGeneration = _sceneObjectsGeneration;
+	parseObjectScript(data, dataSize, code->statementsTable, &statementsCount, code->instructionsTable, &instructionsCount, code->operandsTable, &operandsCount, code->namesTable, &namesCount);
+	debug(DBG_RES, "Game::compileObjectScript() statements %d instructions %d operands %d names %d", statementsCount, instructionsCount, operandsCount, namesCount);
+	return code;
+}
+
+void Game::resolveObjectScriptNames(ObjectScriptCode *code, const uint8_t *data) {
+	// names are looked up in the objects table, the index is -1 if the object is not in the scene
+	for (int i = 0; i < code->namesCount; ++i) {
+		const int offset = code->namesTable[i];
+		const char *name = (const char *)data + offset;
+		int index = -1;
+		for (int j = 0; j < _sceneObjectsCount; ++j) {
+			if (strcmp(_sceneObjectsTable[j].name, name) == 0) {
+				index = j;
+				break;
+			}
+		}
+		code->objectsTable[offset] = index;
+	}
+	code->objectsGeneration = _sceneObjectsGeneration;
+}
+
+void Game::executeObjectScriptCode(const ObjectScriptCode *code) {
+	for (int statement = 0; statement < code->statementsCount; ++statement) {
+		const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+		const bool next = executeObjectScriptStatement(code, statement);
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.addStatement(statement, t0);
+		}
+		if (!next) {
+			break;
+		}
+	}
+}
+
+// returns false if the script execution should stop
+bool Game::executeObjectScriptStatement(const ObjectScriptCode *code, int statement) {
+	const ObjectScriptStatement *st = &code->statementsTable[statement];
+	_objectScript.statementNum = statement;
+	_objectScript.testObjectNum = -1;
+	_objectScript.testDataOffset = st->endDataOffset;
+	const ObjectScriptInstruction *ins = &code->instructionsTable[st->firstInstruction];
+	for (int i = 0; i < st->conditionsCount; ++i, ++ins) {
+		const ConditionOpcode *opcode = &_conditionOpcodesTable[ins->num];
+		debug(DBG_OPCODES, "statement %d condition %d op %d", statement, _objectScript.currentObjectNum, opcode->num);
+		const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+		const bool ret = (this->*opcode->proc)(&code->operandsTable[ins->firstOperand]);
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.addOpcode(true, opcode->num, t0);
+		}
+		if (!ret) {
+			return true;
+		}
 	}
+	for (int i = 0; i < st->operatorsCount; ++i, ++ins) {
+		const OperatorOpcode *opcode = &_operatorOpcodesTable[ins->num];
+		debug(DBG_OPCODES, "statement %d operator %d op %d", statement, _objectScript.currentObjectNum, opcode->num);
+		const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+		_objectScript.operandsDataOffset = ins->dataOffset;
+		_objectScript.dataOffset = ins->nextDataOffset;
+		(this->*opcode->proc)(&code->operandsTable[ins->firstOperand]);
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.addOpcode(false, opcode->num, t0);
+		}
+		// the setupObjectPos opcodes do not consume their operands past the object name if the current
+		// object is not set, the following words are then executed as operators, as the original interpreter does
+		if (_objectScript.dataOffset != ins->nextDataOffset) {
+			return executeObjectScriptOperators(st->endDataOffset);
+		}
+	}
+	return !st->breakScript;
+}
+
+// decodes the operands of the opcode at the data offset for the interpreter
+static const int *decodeInterpretedOperands(Script *script, const char *operands) {
+	int count = 0;
+	int namesCount = 0;
+	const int next = decodeScriptOperands(script->data, script->dataSize, script->dataOffset, operands, 0, &count, 0, &namesCount);
+	if (next < 0 || count > Script::kMaxOperands) {
+		error("Invalid operands at offset %d", script->dataOffset);
+	}
+	count = 0;
+	decodeScriptOperands(script->data, script->dataSize, script->dataOffset, operands, script->operandsBuffer, &count, 0, &namesCount);
+	script->operandsDataOffset = script->dataOffset;
+	script->dataOffset = next;
+	return script->operandsBuffer;
+}
+
+bool Game::executeObjectScriptConditions() {
+	while (1) {
+		int op = _objectScript.fetchNextWord();
+		debug(DBG_OPCODES, "statement %d condition %d op %d", _objectScript.statementNum, _objectScript.currentObjectNum, op);
+		if (op == 0) {
+			break;
+		}
+		const int num = findConditionOpcode(op);
+		if (num == -1) {
+			error("Invalid condition %d", op);
+			return false;
+		}
+		const int *args = decodeInterpretedOperands(&_objectScript, _conditionOpcodesTable[num].operands);
+		const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+		const bool ret = (this->*_conditionOpcodesTable[num].proc)(args);
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.addOpcode(true, op, t0);
+		}
+		if (!ret) {
+			return false;
+		}
+	}
+	return true;
 }
 
-void Game::evalExpr(int16_t *val) {
-	int16_t op = _objectScript.fetchNextWord();
-	int16_t arg = _objectScript.fetchNextWord();
+bool Game::executeObjectScriptOperators(int endOfStatementDataOffset) {
+	while (_objectScript.dataOffset < endOfStatementDataOffset) {
+		int op = _objectScript.fetchNextWord();
+		debug(DBG_OPCODES, "statement %d operator %d op %d", _objectScript.statementNum, _objectScript.currentObjectNum, op);
+		if (op == 100) { // &Game::oop_breakObjectScript
+			return false;
+		}
+		const int num = findOperatorOpcode(op);
+		if (num == -1) {
+			error("Invalid operator %d", op);
+			return true;
+		}
+		const int *args = decodeInterpretedOperands(&_objectScript, _operatorOpcodesTable[num].operands);
+		const uint64_t t0 = _scriptProfiler._enabled ? ScriptProfiler::getTime() : 0;
+		(this->*_operatorOpcodesTable[num].proc)(args);
+		if (_scriptProfiler._enabled) {
+			_scriptProfiler.addOpcode(false, op, t0);
+		}
+	}
+	return true;
+}
+
+void Game::evalExpr(int16_t *val, const int *args) {
+	int16_t op = args[0];
+	int16_t arg = args[1];
 	switch (op) {
 	case 0:
 		*val = arg;
@@ -126,14 +475,15 @@ void Game::evalExpr(int16_t *val) {
 	}
 }
 
-bool Game::testExpr(int16_t val) {
+bool Game::testExpr(int16_t val, const int *args) {
 	bool ret = false;
-	int16_t op = _objectScript.fetchNextWord();
+	int16_t op = args[0];
 	if (op == -1) {
-		int count = _objectScript.fetchNextWord();
-		while (count--) {
-			int16_t cmp1 = _objectScript.fetchNextWord();
-			int16_t cmp2 = _objectScript.fetchNextWord();
+		const int count = args[1];
+		const int *ranges = &args[2];
+		for (int i = 0; i < count; ++i, ranges += 2) {
+			int16_t cmp1 = ranges[0];
+			int16_t cmp2 = ranges[1];
 			if (cmp1 > cmp2) {
 				warning("testExpr cmp %d,%d", cmp1, cmp2);
 			}
@@ -142,7 +492,7 @@ bool Game::testExpr(int16_t val) {
 			}
 		}
 	} else {
-		int16_t arg = _objectScript.fetchNextWord();
+		int16_t arg = args[1];
 		switch (op) {
 		case 0:
 			if (arg == val) {
@@ -182,34 +532,34 @@ bool Game::testExpr(int16_t val) {
 	return ret;
 }
 
-bool Game::cop_true() {
+bool Game::cop_true(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_true");
 	return true;
 }
 
-bool Game::cop_isInRandomRange() {
+bool Game::cop_isInRandomRange(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isInRandomRange");
 	int16_t rnd = _rnd.getNumber();
-	int t = (int16_t)_objectScript.fetchNextWord();
+	int t = (int16_t)args[0];
 	return ((((t * rnd) / 0x8000) & 0xFFFF) == 0);
 }
 
-bool Game::cop_isKeyPressed() {
+bool Game::cop_isKeyPressed(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isKeyPressed");
-	int key = _objectScript.fetchNextWord();
+	int key = args[0];
 	return _keysPressed[key] != 0;
 }
 
-bool Game::cop_isKeyNotPressed() {
+bool Game::cop_isKeyNotPressed(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isKeyNotPressed");
-	int key = _objectScript.fetchNextWord();
+	int key = args[0];
 	return _keysPressed[key] == 0;
 }
 
-bool Game::cop_testMouseButtons() {
+bool Game::cop_testMouseButtons(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testMouseButtons");
 	bool ret = true;
-	int t = _objectScript.fetchNextWord();
+	int t = args[0];
 	switch (t) {
 	case 0:
 		ret = (_mouseButtonsPressed & kLeftMouseButton) != 0;
@@ -227,10 +577,10 @@ bool Game::cop_testMouseButtons() {
 	return ret;
 }
 
-bool Game::cop_isObjectInScene() {
+bool Game::cop_isObjectInScene(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isObjectInScene");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
@@ -242,55 +592,51 @@ bool Game::cop_isObjectInScene() {
 	return ret;
 }
 
-bool Game::cop_testObjectPrevState() {
+bool Game::cop_testObjectPrevState(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectPrevState");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t state = _objectScript.fetchNextWord();
+		int16_t state = args[1];
 		if (so->statePrev != state) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectState() {
+bool Game::cop_testObjectState(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectState");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t state = _objectScript.fetchNextWord();
+		int16_t state = args[1];
 		if (so->state != state) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 	return ret;
 }
 
-bool Game::cop_isObjectInRect() {
+bool Game::cop_isObjectInRect(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isObjectInRect");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
-	int16_t var1E = _objectScript.fetchNextWord(); // x1
-	int16_t var22 = _objectScript.fetchNextWord(); // y1
-	int16_t var20 = _objectScript.fetchNextWord(); // x2
-	int16_t var24 = _objectScript.fetchNextWord(); // y2
+	int16_t var1E = args[1]; // x1
+	int16_t var22 = args[2]; // y1
+	int16_t var20 = args[3]; // x2
+	int16_t var24 = args[4]; // y2
 	assert(var1E <= var20);
 	assert(var22 <= var24);
 	if (ret) {
@@ -309,117 +655,105 @@ bool Game::cop_isObjectInRect() {
 	return ret;
 }
 
-bool Game::cop_testPrevObjectTransformXPos() {
+bool Game::cop_testPrevObjectTransformXPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testPrevObjectTransformXPos");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret && derefSceneObject(index)->statePrev != 0) {
-		if (!comparePrevObjectTransformXPos(index)) {
+		if (!comparePrevObjectTransformXPos(index, &args[1])) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 14;
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectTransformXPos() {
+bool Game::cop_testObjectTransformXPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectTransformXPos");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret && derefSceneObject(index)->state != 0) {
-		if (!compareObjectTransformXPos(index)) {
+		if (!compareObjectTransformXPos(index, &args[1])) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 14;
 	}
 	return ret;
 }
 
-bool Game::cop_testPrevObjectTransformYPos() {
+bool Game::cop_testPrevObjectTransformYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testPrevObjectTransformYPos");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret && derefSceneObject(index)->statePrev != 0) {
-		if (!comparePrevObjectTransformYPos(index)) {
+		if (!comparePrevObjectTransformYPos(index, &args[1])) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 14;
 	}
 	return ret;
 
 }
 
-bool Game::cop_testObjectTransformYPos() {
+bool Game::cop_testObjectTransformYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectTransformYPos");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret && derefSceneObject(index)->state != 0) {
-		if (!compareObjectTransformYPos(index)) {
+		if (!compareObjectTransformYPos(index, &args[1])) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 14;
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectPrevFlip() {
+bool Game::cop_testObjectPrevFlip(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectPrevFlip");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t flip = _objectScript.fetchNextWord();
+		int16_t flip = args[1];
 		if (flip != so->flipPrev) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectFlip() {
+bool Game::cop_testObjectFlip(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectFlip");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t flip = _objectScript.fetchNextWord();
+		int16_t flip = args[1];
 		if (flip != so->flip) {
 			ret = false;
 		}
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectPrevFrameNum() {
+bool Game::cop_testObjectPrevFrameNum(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectPrevFrameNum");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
@@ -427,7 +761,7 @@ bool Game::cop_testObjectPrevFrameNum() {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
 			int16_t val = so->frameNumPrev - _sceneObjectMotionsTable[so->motionNum1].firstFrameIndex + 1;
-			if (testExpr(val)) {
+			if (testExpr(val, &args[1])) {
 				return true;
 			}
 		}
@@ -436,10 +770,10 @@ bool Game::cop_testObjectPrevFrameNum() {
 	return ret;
 }
 
-bool Game::cop_testObjectFrameNum() {
+bool Game::cop_testObjectFrameNum(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectFrameNum");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
@@ -447,7 +781,7 @@ bool Game::cop_testObjectFrameNum() {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
 			int16_t val = so->frameNum - _sceneObjectMotionsTable[so->motionNum2].firstFrameIndex + 1;
-			if (testExpr(val)) {
+			if (testExpr(val, &args[1])) {
 				return true;
 			}
 		}
@@ -456,10 +790,10 @@ bool Game::cop_testObjectFrameNum() {
 	return ret;
 }
 
-bool Game::cop_testPrevMotionNum() {
+bool Game::cop_testPrevMotionNum(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testPrevMotionNum");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
@@ -473,7 +807,7 @@ bool Game::cop_testPrevMotionNum() {
 					_ax = _animationsTable[_sceneObjectMotionsTable[so->motionNum1].animNum].unk26;
 				}
 			}
-			if (testExpr(_ax + _dx + 1)) {
+			if (testExpr(_ax + _dx + 1, &args[1])) {
 				return true;
 			}
 		}
@@ -482,10 +816,10 @@ bool Game::cop_testPrevMotionNum() {
 	return ret;
 }
 
-bool Game::cop_testMotionNum() {
+bool Game::cop_testMotionNum(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testMotionNum");
 	bool ret = true;
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
@@ -499,7 +833,7 @@ bool Game::cop_testMotionNum() {
 					_ax = _animationsTable[_sceneObjectMotionsTable[so->motionNum1].animNum].unk26;
 				}
 			}
-			if (testExpr(_ax + _dx + 1)) {
+			if (testExpr(_ax + _dx + 1, &args[1])) {
 				return true;
 			}
 		}
@@ -508,40 +842,40 @@ bool Game::cop_testMotionNum() {
 	return ret;
 }
 
-bool Game::cop_testObjectVar() {
+bool Game::cop_testObjectVar(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectVar()");
 	bool ret = true;
-	int var = _objectScript.fetchNextWord();
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int var = args[0];
+	int index = findObjectByName(args[1], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
 		assert(var >= 0 && var < 10);
-		if (!testExpr(so->varsTable[var])) {
+		if (!testExpr(so->varsTable[var], &args[2])) {
 			ret = false;
 		}
 	}
 	return ret;
 }
 
-bool Game::cop_testObjectAndObjectXPos() {
+bool Game::cop_testObjectAndObjectXPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectAndObjectXPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
-			int16_t var1E = getObjectTransformXPos(index);
-			int16_t var20 = getObjectTransformXPos(index);
-			int var18 = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+			int16_t var1E = getObjectTransformXPos(index, &args[1]);
+			int16_t var20 = getObjectTransformXPos(index, &args[4]);
+			int var18 = findObjectByName(args[7], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 			if (var18 != -1) {
 				so = derefSceneObject(var18);
 				if (so->statePrev == 0) {
 					return false;
 				}
-				int16_t var22 = getObjectTransformXPos(var18);
-				int16_t var24 = getObjectTransformXPos(var18);
+				int16_t var22 = getObjectTransformXPos(var18, &args[8]);
+				int16_t var24 = getObjectTransformXPos(var18, &args[11]);
 				int16_t _dx = MIN(var1E, var20);
 				int16_t _ax = MAX(var22, var24);
 				if (_dx <= _ax) {
@@ -558,22 +892,22 @@ bool Game::cop_testObjectAndObjectXPos() {
 	return false;
 }
 
-bool Game::cop_testObjectAndObjectYPos() {
+bool Game::cop_testObjectAndObjectYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectAndObjectYPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
-			int16_t var22 = getObjectTransformYPos(index);
-			int16_t var24 = getObjectTransformYPos(index);
-			int var18 = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+			int16_t var22 = getObjectTransformYPos(index, &args[1]);
+			int16_t var24 = getObjectTransformYPos(index, &args[4]);
+			int var18 = findObjectByName(args[7], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 			if (var18 != -1) {
 				so = derefSceneObject(var18);
 				if (so->statePrev == 0) {
 					return false;
 				}
-				int16_t var1E = getObjectTransformYPos(var18);
-				int16_t var20 = getObjectTransformYPos(var18);
+				int16_t var1E = getObjectTransformYPos(var18, &args[8]);
+				int16_t var20 = getObjectTransformYPos(var18, &args[11]);
 				int16_t _dx = MIN(var22, var24);
 				int16_t _ax = MAX(var1E, var20);
 				if (_dx <= _ax) {
@@ -590,9 +924,9 @@ bool Game::cop_testObjectAndObjectYPos() {
 	return false;
 }
 
-bool Game::cop_testObjectMotionYPos() {
+bool Game::cop_testObjectMotionYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testObjectMotionYPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
 		int num = so->motionNum + so->motionInit;
@@ -600,49 +934,47 @@ bool Game::cop_testObjectMotionYPos() {
 		int _ax = so->yPrev - so->yInit;
 		_ax -= _sceneObjectFramesTable[so->frameNumPrev].hdr.yPos;
 		_ax += _sceneObjectFramesTable[var1A].hdr.yPos;
-		int16_t div = _objectScript.fetchNextWord();
+		int16_t div = args[1];
 		var1A = _ax % div;
 		if (var1A < 0) {
 			var1A += div;
 		}
-		int16_t cmp = _objectScript.fetchNextWord();
+		int16_t cmp = args[2];
 		if (var1A == cmp && so->state == 1) {
 			return true;
 		}
-	} else {
-		_objectScript.dataOffset += 4;
 	}
 	return false;
 }
 
-bool Game::cop_testVar() {
+bool Game::cop_testVar(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testVar()");
-	int var = _objectScript.fetchNextWord();
-	bool ret = testExpr(_varsTable[var]);
+	int var = args[0];
+	bool ret = testExpr(_varsTable[var], &args[1]);
 	return ret;
 }
 
-bool Game::cop_isCurrentBagAction() {
+bool Game::cop_isCurrentBagAction(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isCurrentBagAction()");
-	int16_t num = _objectScript.fetchNextWord();
+	int16_t num = args[0];
 	return num == _currentBagAction;
 }
 
-bool Game::cop_isObjectInBox() {
+bool Game::cop_isObjectInBox(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isObjectInBox()");
 	bool ret = true;
-	int16_t var1A = _objectScript.fetchNextWord(); // boxNum
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound); // var18
+	int16_t var1A = args[0]; // boxNum
+	int index = findObjectByName(args[1], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound); // var18
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
-			int16_t var1E = getObjectTransformXPos(index); // x1
-			int16_t var20 = getObjectTransformXPos(index); // x2
-			int16_t var22 = getObjectTransformYPos(index); // y1
-			int16_t var24 = getObjectTransformYPos(index); // y2
+			int16_t var1E = getObjectTransformXPos(index, &args[2]); // x1
+			int16_t var20 = getObjectTransformXPos(index, &args[5]); // x2
+			int16_t var22 = getObjectTransformYPos(index, &args[8]); // y1
+			int16_t var24 = getObjectTransformYPos(index, &args[11]); // y2
 			bool foundBox = false;
 			for (int i = 0; i < _boxesCountTable[var1A]; ++i) {
 				Box *box = derefBox(var1A, i);
@@ -670,21 +1002,21 @@ bool Game::cop_isObjectInBox() {
 	return false;
 }
 
-bool Game::cop_isObjectNotInBox() {
+bool Game::cop_isObjectNotInBox(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isObjectNotInBox()");
 	bool ret = true;
-	int16_t var1A = _objectScript.fetchNextWord(); // boxNum
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound); // var18
+	int16_t var1A = args[0]; // boxNum
+	int index = findObjectByName(args[1], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound); // var18
 	if (index == -1) {
 		ret = false;
 	}
 	if (ret) {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
-			int16_t var1E = getObjectTransformXPos(index);
-			int16_t var20 = getObjectTransformXPos(index);
-			int16_t var22 = getObjectTransformYPos(index);
-			int16_t var24 = getObjectTransformYPos(index);
+			int16_t var1E = getObjectTransformXPos(index, &args[2]);
+			int16_t var20 = getObjectTransformXPos(index, &args[5]);
+			int16_t var22 = getObjectTransformYPos(index, &args[8]);
+			int16_t var24 = getObjectTransformYPos(index, &args[11]);
 			bool foundBox = false;
 			for (int i = 0; i < _boxesCountTable[var1A]; ++i) {
 				Box *box = derefBox(var1A, i);
@@ -713,21 +1045,21 @@ bool Game::cop_isObjectNotInBox() {
 	return false;
 }
 
-bool Game::cop_isObjectNotIntersectingBox() {
+bool Game::cop_isObjectNotIntersectingBox(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isObjectNotIntersectingBox()");
-	int16_t var1A = _objectScript.fetchNextWord();
-	int var18 = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int16_t var1A = args[0];
+	int var18 = findObjectByName(args[1], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (var18 != -1) {
 		SceneObject *so = derefSceneObject(var18);
 		if (so->statePrev != 0) {
-			int16_t var1E = getObjectTransformXPos(var18);
-			int16_t var22 = getObjectTransformYPos(var18);
-			var18 = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+			int16_t var1E = getObjectTransformXPos(var18, &args[2]);
+			int16_t var22 = getObjectTransformYPos(var18, &args[5]);
+			var18 = findObjectByName(args[8], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 			if (var18 != -1) {
 				so = derefSceneObject(var18);
 				if (so->statePrev != 0) {
-					int16_t var20 = getObjectTransformXPos(var18);
-					int16_t var24 = getObjectTransformYPos(var18);
+					int16_t var20 = getObjectTransformXPos(var18, &args[9]);
+					int16_t var24 = getObjectTransformYPos(var18, &args[12]);
 					bool foundBox = false;
 					for (int i = 0; i < _boxesCountTable[var1A]; ++i) {
 						if (intersectsBox(var1A, i, var1E, var22, var20, var24)) {
@@ -756,31 +1088,31 @@ bool Game::cop_isObjectNotIntersectingBox() {
 	return false;
 }
 
-bool Game::cop_isCurrentBagObject() {
+bool Game::cop_isCurrentBagObject(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isCurrentBagObject");
-	const char *name = _objectScript.fetchNextString();
+	const char *name = _objectScript.getString(args[0]);
 	int index = findBagObjectByName(name);
 	return index != -1 && _currentBagObject == index;
 }
 
-bool Game::cop_isLifeBarDisplayed() {
+bool Game::cop_isLifeBarDisplayed(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isLifeBarDisplayed");
 	return _lifeBarDisplayed;
 }
 
-bool Game::cop_isLifeBarNotDisplayed() {
+bool Game::cop_isLifeBarNotDisplayed(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isLifeBarNotDisplayed");
 	return !_lifeBarDisplayed;
 }
 
-bool Game::cop_testLastDialogue() {
+bool Game::cop_testLastDialogue(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_testLastDialogue");
-	return testExpr(_lastDialogueEndedId) && _dialogueEndedFlag != 0;
+	return testExpr(_lastDialogueEndedId, args) && _dialogueEndedFlag != 0;
 }
 
-bool Game::cop_isNextScene() {
+bool Game::cop_isNextScene(const int *args) {
 	debug(DBG_OPCODES, "Game::cop_isNextScene");
-	int scene = _objectScript.fetchNextWord();
+	int scene = args[0];
 	for (int i = 0; i < _sceneConditionsCount; ++i) {
 		if (_nextScenesTable[i].num == scene) {
 			return true;
@@ -789,12 +1121,12 @@ bool Game::cop_isNextScene() {
 	return false;
 }
 
-void Game::oop_initializeObject() {
+void Game::oop_initializeObject(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_initializeObject");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t op = _objectScript.fetchNextWord();
+		int16_t op = args[1];
 		if (op == 0) {
 			if (so->state != 0) {
 				so->x = so->xPrev;
@@ -827,261 +1159,228 @@ void Game::oop_initializeObject() {
 				so->mode = mode;
 			}
 		}
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 }
 
-void Game::oop_evalCurrentObjectX() {
+void Game::oop_evalCurrentObjectX(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalCurrentObjectX()");
 	SceneObject *so = derefSceneObject(_objectScript.currentObjectNum);
 	if (so->state != 0) {
-		_objectScript.dataOffset += 6;
-		evalExpr(&so->x);
-	} else {
-		_objectScript.dataOffset += 6 + 4;
+		evalExpr(&so->x, &args[3]);
 	}
 }
 
-void Game::oop_evalCurrentObjectY() {
+void Game::oop_evalCurrentObjectY(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalCurrentObjectY()");
 	SceneObject *so = derefSceneObject(_objectScript.currentObjectNum);
 	if (so->state != 0) {
-		_objectScript.dataOffset += 6;
-		evalExpr(&so->y);
-	} else {
-		_objectScript.dataOffset += 6 + 4;
+		evalExpr(&so->y, &args[3]);
 	}
 }
 
-void Game::oop_evalObjectX() {
+void Game::oop_evalObjectX(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectX()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->x);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->x, &args[1]);
 	}
 }
 
-void Game::oop_evalObjectY() {
+void Game::oop_evalObjectY(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectY()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->y);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->y, &args[1]);
 	}
 }
 
-void Game::oop_evalObjectZ() {
+void Game::oop_evalObjectZ(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectZ()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->z);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->z, &args[1]);
 	}
 }
 
-void Game::oop_setObjectFlip() {
+void Game::oop_setObjectFlip(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectFlip()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->flip = _objectScript.fetchNextWord();
-	} else {
-		_objectScript.dataOffset += 2;
+		so->flip = args[1];
 	}
 }
 
-void Game::oop_adjustObjectPos_vv0000() {
+void Game::oop_adjustObjectPos_vv0000(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_adjustObjectPos_vv0000()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
 		changeObjectMotionFrame(_objectScript.currentObjectNum, index, _objectScript.objectFound, a2, a0, 0, 0, 0, 0);
-	} else {
-		_objectScript.dataOffset += 4;
 	}
 }
 
-void Game::oop_adjustObjectPos_vv1v00() {
+void Game::oop_adjustObjectPos_vv1v00(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_adjustObjectPos_vv1v00()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
-		int16_t a4 = _objectScript.fetchNextWord();
-		_objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
+		int16_t a4 = args[3];
 		changeObjectMotionFrame(_objectScript.currentObjectNum, index, _objectScript.objectFound, a2, a0, 1, a4, 0, 0);
-	} else {
-		_objectScript.dataOffset += 8;
 	}
 }
 
-void Game::oop_adjustObjectPos_vv1v1v() {
+void Game::oop_adjustObjectPos_vv1v1v(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_adjustObjectPos_vv1v1v()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
-		int16_t a4 = _objectScript.fetchNextWord();
-		int16_t a6 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
+		int16_t a4 = args[3];
+		int16_t a6 = args[4];
 		changeObjectMotionFrame(_objectScript.currentObjectNum, index, _objectScript.objectFound, a2, a0, 1, a4, 1, a6);
-	} else {
-		_objectScript.dataOffset += 8;
 	}
 }
 
-void Game::oop_setupObjectPos_121() {
+void Game::oop_setupObjectPos_121(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_121()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 1);
-	} else {
-		_objectScript.dataOffset += 16;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 1, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_setupObjectPos_122() {
+void Game::oop_setupObjectPos_122(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_122()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 2);
-	} else {
-		_objectScript.dataOffset += 28;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 2, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_setupObjectPos_123() {
+void Game::oop_setupObjectPos_123(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_123()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 3);
-	} else {
-		_objectScript.dataOffset += 20;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, 2, 3, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_adjustObjectPos_1v0000() {
+void Game::oop_adjustObjectPos_1v0000(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_adjustObjectPos_1v0000()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		int16_t a0 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
 		changeObjectMotionFrame(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, a0, 0, 0, 0, 0);
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 }
 
-void Game::oop_adjustObjectPos_1v1v1v() {
+void Game::oop_adjustObjectPos_1v1v1v(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_adjustObjectPos_1v1v1v()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
-		int16_t a4 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
+		int16_t a4 = args[3];
 		changeObjectMotionFrame(_objectScript.currentObjectNum, index, _objectScript.objectFound, 1, a0, 1, a2, 1, a4);
-	} else {
-		_objectScript.dataOffset += 6;
 	}
 }
 
-void Game::oop_setupObjectPos_021() {
+void Game::oop_setupObjectPos_021(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_021()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 1);
-	} else {
-		_objectScript.dataOffset += 14;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 1, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_setupObjectPos_022() {
+void Game::oop_setupObjectPos_022(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_022()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 2);
-	} else {
-		_objectScript.dataOffset += 26;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 2, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_setupObjectPos_023() {
+void Game::oop_setupObjectPos_023(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setupObjectPos_023()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
-		setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 3);
-	} else {
-		_objectScript.dataOffset += 18;
+		if (!setupObjectPos(_objectScript.currentObjectNum, index, _objectScript.objectFound, 0, 2, 3, &args[1])) {
+			_objectScript.dataOffset = _objectScript.getObjectNameEndDataOffset();
+		}
 	}
 }
 
-void Game::oop_evalObjectVar() {
+void Game::oop_evalObjectVar(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectVar()");
-	int var = _objectScript.fetchNextWord();
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int var = args[0];
+	int index = findObjectByName(args[1], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		assert(var >= 0 && var < 10);
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->varsTable[var]);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->varsTable[var], &args[2]);
 	}
 }
 
-void Game::oop_translateObjectXPos() {
+void Game::oop_translateObjectXPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_translateObjectXPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
-		int16_t a4 = _objectScript.fetchNextWord();
-		int16_t a6 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
+		int16_t a4 = args[3];
+		int16_t a6 = args[4];
 		int16_t var1A = getObjectTranslateXPos(index, a0, a2, a4);
 		if (a2 / 2 >= var1A) {
 			so->x -= MIN<int16_t>(a6, var1A);
 		} else {
 			so->x += MIN<int16_t>(a6, a2 - var1A);
 		}
-	} else {
-		_objectScript.dataOffset += 8;
 	}
 }
 
-void Game::oop_translateObjectYPos() {
+void Game::oop_translateObjectYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_translateObjectYPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		int16_t a0 = _objectScript.fetchNextWord();
-		int16_t a2 = _objectScript.fetchNextWord();
-		int16_t a4 = _objectScript.fetchNextWord();
-		int16_t a6 = _objectScript.fetchNextWord();
+		int16_t a0 = args[1];
+		int16_t a2 = args[2];
+		int16_t a4 = args[3];
+		int16_t a6 = args[4];
 		int16_t var1A = getObjectTranslateYPos(index, a0, a2, a4);
 		if (a2 / 2 >= var1A) {
 			so->y -= MIN<int16_t>(a6, var1A);
 		} else {
 			so->y += MIN<int16_t>(a6, a2 - var1A);
 		}
-	} else {
-		_objectScript.dataOffset += 8;
 	}
 }
 
-void Game::oop_setObjectMode() {
+void Game::oop_setObjectMode(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectMode()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
-	int mode = _objectScript.fetchNextWord();
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int mode = args[1];
 	int modeRndMul = 0;
 	if (mode == 2) {
-		modeRndMul = _objectScript.fetchNextWord();
+		modeRndMul = args[2];
 	}
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
@@ -1092,116 +1391,100 @@ void Game::oop_setObjectMode() {
 	}
 }
 
-void Game::oop_setObjectInitPos() {
+void Game::oop_setObjectInitPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectInitPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->xInit = _objectScript.fetchNextWord();
-		so->yInit = _objectScript.fetchNextWord();
-	} else {
-		_objectScript.dataOffset += 4;
+		so->xInit = args[1];
+		so->yInit = args[2];
 	}
 }
 
-void Game::oop_setObjectTransformInitPos() {
+void Game::oop_setObjectTransformInitPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectTransformInitPos()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->xInit = getObjectTransformXPos(_objectScript.currentObjectNum);
-		so->yInit = getObjectTransformYPos(_objectScript.currentObjectNum);
-	} else {
-		_objectScript.dataOffset += 12;
+		so->xInit = getObjectTransformXPos(_objectScript.currentObjectNum, &args[1]);
+		so->yInit = getObjectTransformYPos(_objectScript.currentObjectNum, &args[4]);
 	}
 }
 
-void Game::oop_evalObjectXInit() {
+void Game::oop_evalObjectXInit(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectXInit()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->xInit);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->xInit, &args[1]);
 	}
 }
 
-void Game::oop_evalObjectYInit() {
+void Game::oop_evalObjectYInit(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectYInit()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->yInit);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->yInit, &args[1]);
 	}
 }
 
-void Game::oop_evalObjectZInit() {
+void Game::oop_evalObjectZInit(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalObjectZInit()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		evalExpr(&so->zInit);
-	} else {
-		_objectScript.dataOffset += 4;
+		evalExpr(&so->zInit, &args[1]);
 	}
 }
 
-void Game::oop_setObjectFlipInit() {
+void Game::oop_setObjectFlipInit(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectFlipInit()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->flipInit = _objectScript.fetchNextWord();
-	} else {
-		_objectScript.dataOffset += 2;
+		so->flipInit = args[1];
 	}
 }
 
-void Game::oop_setObjectCel() {
+void Game::oop_setObjectCel(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setObjectCel()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->motionNum = _objectScript.fetchNextWord() - 1;
-		so->motionFrameNum = _objectScript.fetchNextWord() - 1;
-	} else {
-		_objectScript.dataOffset += 4;
+		so->motionNum = args[1] - 1;
+		so->motionFrameNum = args[2] - 1;
 	}
 }
 
-void Game::oop_resetObjectCel() {
+void Game::oop_resetObjectCel(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_resetObjectCel()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
-		so->motionNum = _objectScript.fetchNextWord() - 1;
+		so->motionNum = args[1] - 1;
 		so->motionFrameNum = 0;
-	} else {
-		_objectScript.dataOffset += 2;
 	}
 }
 
-void Game::oop_evalVar() {
+void Game::oop_evalVar(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalVar()");
-	int var = _objectScript.fetchNextWord();
+	int var = args[0];
 	assert(var >= 0 && var < NUM_VARS);
-	evalExpr(&_varsTable[var]);
+	evalExpr(&_varsTable[var], &args[1]);
 }
 
-void Game::oop_getSceneNumberInVar() {
+void Game::oop_getSceneNumberInVar(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_getSceneNumberInVar()");
-	int var = _objectScript.fetchNextWord();
+	int var = args[0];
 	assert(var >= 0 && var < NUM_VARS);
 	_varsTable[var] = _sceneNumber;
 }
 
-void Game::oop_disableBox() {
+void Game::oop_disableBox(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_disableBox()");
-	int box = _objectScript.fetchNextWord();
-	int index = _objectScript.fetchNextWord();
+	int box = args[0];
+	int index = args[1];
 	// FIXME: workaround no box for using raft (C2_17.SCN, FLY*.SCN)
 	if (_objectScript.currentObjectNum == 0 && (_objectScript.statementNum == 38 || _objectScript.statementNum == 39)) {
 		return;
@@ -1209,70 +1492,62 @@ void Game::oop_disableBox() {
 	derefBox(box, index)->state = 0;
 }
 
-void Game::oop_enableBox() {
+void Game::oop_enableBox(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_enableBox()");
-	int box = _objectScript.fetchNextWord();
-	int index = _objectScript.fetchNextWord();
+	int box = args[0];
+	int index = args[1];
 	derefBox(box, index)->state = 1;
 }
 
-void Game::oop_evalBoxesXPos() {
+void Game::oop_evalBoxesXPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalBoxesXPos()");
 	for (int b = 0; b < 10; ++b) {
 		for (int i = 0; i < _boxesCountTable[b]; ++i) {
 			Box *box = derefBox(b, i);
-			evalExpr(&box->x1);
-			_objectScript.dataOffset -= 4;
-			evalExpr(&box->x2);
-			_objectScript.dataOffset -= 4;
+			evalExpr(&box->x1, args);
+			evalExpr(&box->x2, args);
 		}
 	}
-	_objectScript.dataOffset += 4;
 }
 
-void Game::oop_evalBoxesYPos() {
+void Game::oop_evalBoxesYPos(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_evalBoxesYPos()");
 	for (int b = 0; b < 10; ++b) {
 		for (int i = 0; i < _boxesCountTable[b]; ++i) {
 			Box *box = derefBox(b, i);
-			evalExpr(&box->y1);
-			_objectScript.dataOffset -= 4;
-			evalExpr(&box->y2);
-			_objectScript.dataOffset -= 4;
+			evalExpr(&box->y1, args);
+			evalExpr(&box->y2, args);
 		}
 	}
-	_objectScript.dataOffset += 4;
 }
 
-void Game::oop_setBoxToObject() {
+void Game::oop_setBoxToObject(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_setBoxToObject()");
-	int16_t var1A = _objectScript.fetchNextWord();
-	int16_t var1C = _objectScript.fetchNextWord();
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int16_t var1A = args[0];
+	int16_t var1C = args[1];
+	int index = findObjectByName(args[2], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
 		if (so->statePrev != 0) {
-			int16_t var1E = getObjectTransformXPos(index);
-			int16_t var20 = getObjectTransformXPos(index);
-			int16_t var22 = getObjectTransformYPos(index);
-			int16_t var24 = getObjectTransformYPos(index);
+			int16_t var1E = getObjectTransformXPos(index, &args[3]);
+			int16_t var20 = getObjectTransformXPos(index, &args[6]);
+			int16_t var22 = getObjectTransformYPos(index, &args[9]);
+			int16_t var24 = getObjectTransformYPos(index, &args[12]);
 			Box *box = derefBox(var1A, var1C);
 			box->x1 = MIN(var1E, var20);
 			box->x2 = MAX(var1E, var20);
 			box->y1 = MIN(var24, var22);
 			box->y2 = MAX(var24, var22);
-			return;
 		}
 	}
-	_objectScript.dataOffset += 24;
 }
 
-void Game::oop_clipBoxes() {
+void Game::oop_clipBoxes(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_clipBoxes()");
-	int16_t x1 = _objectScript.fetchNextWord();
-	int16_t y1 = _objectScript.fetchNextWord();
-	int16_t x2 = _objectScript.fetchNextWord();
-	int16_t y2 = _objectScript.fetchNextWord();
+	int16_t x1 = args[0];
+	int16_t y1 = args[1];
+	int16_t x2 = args[2];
+	int16_t y2 = args[3];
 	for (int b = 0; b < 10; ++b) {
 		for (int i = 0; i < _boxesCountTable[b]; ++i) {
 			Box *box = derefBox(b, i);
@@ -1284,7 +1559,7 @@ void Game::oop_clipBoxes() {
 	}
 }
 
-void Game::oop_saveObjectStatus() {
+void Game::oop_saveObjectStatus(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_saveObjectStatus()");
 	SceneObject *so = derefSceneObject(_objectScript.currentObjectNum);
 	int xPrev;
@@ -1293,7 +1568,7 @@ void Game::oop_saveObjectStatus() {
 	} else {
 		xPrev = so->xPrev;
 	}
-	int index = _objectScript.fetchNextWord();
+	int index = args[0];
 	SceneObjectStatus *stat = derefSceneObjectStatus(index);
 	stat->x = xPrev;
 	stat->y = so->yPrev;
@@ -1303,9 +1578,9 @@ void Game::oop_saveObjectStatus() {
 	stat->flip = so->flipPrev;
 }
 
-void Game::oop_addObjectToBag() {
+void Game::oop_addObjectToBag(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_addObjectToBag()");
-	int index = findObjectByName(_objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
+	int index = findObjectByName(args[0], _objectScript.currentObjectNum, _objectScript.testObjectNum, &_objectScript.objectFound);
 	if (index != -1) {
 		SceneObject *so = derefSceneObject(index);
 		if (findBagObjectByName(so->name) == -1) {
@@ -1329,9 +1604,9 @@ void Game::oop_addObjectToBag() {
 	}
 }
 
-void Game::oop_removeObjectFromBag() {
+void Game::oop_removeObjectFromBag(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_removeObjectFromBag()");
-	const char *name = _objectScript.fetchNextString();
+	const char *name = _objectScript.getString(args[0]);
 	int index = findBagObjectByName(name);
 	if (index != -1) {
 		if (_currentBagObject == index) {
@@ -1354,10 +1629,10 @@ void Game::oop_removeObjectFromBag() {
 	}
 }
 
-void Game::oop_playSoundLowerEqualPriority() {
+void Game::oop_playSoundLowerEqualPriority(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_playSoundLowerEqualPriority()");
-	int num = _objectScript.fetchNextWord();
-	int priority = _objectScript.fetchNextWord();
+	int num = args[0];
+	int priority = args[1];
 	if (priority > _currentPlayingSoundPriority) {
 		if (win16_sndPlaySound(22) == 0) {
 			return;
@@ -1370,10 +1645,10 @@ void Game::oop_playSoundLowerEqualPriority() {
 	_currentPlayingSoundPriority = priority;
 }
 
-void Game::oop_playSoundLowerPriority() {
+void Game::oop_playSoundLowerPriority(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_playSoundLowerPriority()");
-	int num = _objectScript.fetchNextWord();
-	int priority = _objectScript.fetchNextWord();
+	int num = args[0];
+	int priority = args[1];
 	if (priority >= _currentPlayingSoundPriority) {
 		if (win16_sndPlaySound(22) == 0) {
 			return;
@@ -1386,19 +1661,19 @@ void Game::oop_playSoundLowerPriority() {
 	_currentPlayingSoundPriority = priority;
 }
 
-void Game::oop_startDialogue() {
+void Game::oop_startDialogue(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_startDialogue()");
-	_scriptDialogId = _objectScript.fetchNextString();
-	_scriptDialogFileName = _objectScript.fetchNextString();
-	_scriptDialogSprite1 = _objectScript.fetchNextString();
-	_scriptDialogSprite2 = _objectScript.fetchNextString();
+	_scriptDialogId = _objectScript.getString(args[0]);
+	_scriptDialogFileName = _objectScript.getString(args[1]);
+	_scriptDialogSprite1 = _objectScript.getString(args[2]);
+	_scriptDialogSprite2 = _objectScript.getString(args[3]);
 	_startDialogue = true;
 }
 
-void Game::oop_switchSceneClearBoxes() {
+void Game::oop_switchSceneClearBoxes(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_switchSceneClearBoxes()");
 	bool foundScene = false;
-	int num = _objectScript.fetchNextWord();
+	int num = args[0];
 	for (int i = 0; i < _sceneConditionsCount; ++i) {
 		if (_nextScenesTable[i].num == num) {
 			_objectScript.nextScene = i;
@@ -1413,10 +1688,10 @@ void Game::oop_switchSceneClearBoxes() {
 	}
 }
 
-void Game::oop_switchSceneCopyBoxes() {
+void Game::oop_switchSceneCopyBoxes(const int *args) {
 	debug(DBG_OPCODES, "Game::oop_switchSceneCopyBoxes()");
 	bool foundScene = false;
-	int num = _objectScript.fetchNextWord();
+	int num = args[0];
 	for (int i = 0; i < _sceneConditionsCount; ++i) {
 		if (_nextScenesTable[i].num == num) {
 			_objectScript.nextScene = i;
@@ -499,6 +499,7 @@ static void parse_BoxDescription(char **s, Game *g) {
 }
 
 void Game::parseSCN(const char *fileName) {
+	TraceScope trace("parseSCN");
 	debug(DBG_GAME, "Game::parseSCN()");
 
 	FileHolder fp(_fs, fileName);
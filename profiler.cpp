@@ -0,0 +1,334 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifdef BERMUDA_WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "profiler.h"
+
+ScriptProfiler::ScriptProfiler()
+	: _enabled(false), _filePath(0), _opcodesTable(0), _opcodesCount(0), _animationsTable(0), _animationsCount(0), _objectsTable(0), _objectsCount(0),
+	_tickStartTime(0), _tickMaxTime(0), _currentAnimation(0), _currentObject(0), _objectStartTime(0) {
+	memset(&_ticks, 0, sizeof(_ticks));
+}
+
+ScriptProfiler::~ScriptProfiler() {
+	fini();
+}
+
+void ScriptProfiler::init(const char *filePath) {
+	_filePath = strdup(filePath);
+	_opcodesTable = (Opcode *)calloc(kOpcodesTableSize, sizeof(Opcode));
+	_animationsTable = (Animation *)calloc(kAnimationsTableSize, sizeof(Animation));
+	_objectsTable = (Object *)calloc(kObjectsTableSize, sizeof(Object));
+	if (!_filePath || !_opcodesTable || !_animationsTable || !_objectsTable) {
+		error("Unable to allocate script profiler tables");
+	}
+	_enabled = true;
+}
+
+void ScriptProfiler::fini() {
+	if (_enabled) {
+		dump();
+		_enabled = false;
+	}
+	free(_filePath);
+	_filePath = 0;
+	free(_opcodesTable);
+	_opcodesTable = 0;
+	free(_animationsTable);
+	_animationsTable = 0;
+	free(_objectsTable);
+	_objectsTable = 0;
+}
+
+uint64_t ScriptProfiler::getTime() {
+#ifdef BERMUDA_WIN32
+	static LARGE_INTEGER frequency;
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart * (1000000000. / frequency.QuadPart));
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static void addTime(ProfileCounter *c, uint64_t dt) {
+	++c->count;
+	c->time += dt;
+}
+
+void ScriptProfiler::beginTick() {
+	_tickStartTime = getTime();
+}
+
+void ScriptProfiler::endTick() {
+	const uint64_t dt = getTime() - _tickStartTime;
+	addTime(&_ticks, dt);
+	if (dt > _tickMaxTime) {
+		_tickMaxTime = dt;
+	}
+}
+
+void ScriptProfiler::beginObject(const char *name, const char *animationName) {
+	_currentAnimation = 0;
+	int animation = -1;
+	for (int i = 0; i < _animationsCount; ++i) {
+		if (strcmp(_animationsTable[i].name, animationName) == 0) {
+			animation = i;
+			break;
+		}
+	}
+	if (animation == -1 && _animationsCount < kAnimationsTableSize) {
+		animation = _animationsCount++;
+		strncpy(_animationsTable[animation].name, animationName, sizeof(_animationsTable[animation].name) - 1);
+	}
+	if (animation != -1) {
+		_currentAnimation = &_animationsTable[animation];
+	}
+	_currentObject = 0;
+	for (int i = 0; i < _objectsCount; ++i) {
+		if (_objectsTable[i].animation == animation && strcmp(_objectsTable[i].name, name) == 0) {
+			_currentObject = &_objectsTable[i];
+			break;
+		}
+	}
+	if (!_currentObject && _objectsCount < kObjectsTableSize) {
+		_currentObject = &_objectsTable[_objectsCount++];
+		strncpy(_currentObject->name, name, sizeof(_currentObject->name) - 1);
+		_currentObject->animation = animation;
+	}
+	_objectStartTime = getTime();
+}
+
+void ScriptProfiler::endObject() {
+	const uint64_t dt = getTime() - _objectStartTime;
+	if (_currentAnimation) {
+		addTime(&_currentAnimation->counter, dt);
+	}
+	if (_currentObject) {
+		addTime(&_currentObject->counter, dt);
+	}
+}
+
+void ScriptProfiler::addOpcode(bool condition, int num, uint64_t t0) {
+	const uint64_t dt = getTime() - t0;
+	// open addressing, the table is large enough for all the opcodes
+	uint32_t h = ((num * 2 + (condition ? 1 : 0)) * 2654435761U) % kOpcodesTableSize;
+	for (int i = 0; i < kOpcodesTableSize; ++i) {
+		Opcode *op = &_opcodesTable[h];
+		if (op->counter.count == 0) {
+			op->num = num;
+			op->condition = condition;
+			++_opcodesCount;
+		} else if (op->num != num || op->condition != condition) {
+			h = (h + 1) % kOpcodesTableSize;
+			continue;
+		}
+		addTime(&op->counter, dt);
+		break;
+	}
+}
+
+void ScriptProfiler::addStatement(int statement, uint64_t t0) {
+	const uint64_t dt = getTime() - t0;
+	if (_currentAnimation && statement < kMaxStatements) {
+		addTime(&_currentAnimation->statementsTable[statement], dt);
+		if (statement >= _currentAnimation->statementsCount) {
+			_currentAnimation->statementsCount = statement + 1;
+		}
+	}
+}
+
+static double toMicroseconds(uint64_t t) {
+	return t / 1000.;
+}
+
+static double averageMicroseconds(const ProfileCounter *c) {
+	return c->count ? toMicroseconds(c->time) / c->count : 0.;
+}
+
+void ScriptProfiler::dumpCsv(FILE *fp) {
+	fprintf(fp, "type,animation,name,count,total_us,average_us\n");
+	fprintf(fp, "tick,,,%u,%.3f,%.3f\n", _ticks.count, toMicroseconds(_ticks.time), averageMicroseconds(&_ticks));
+	fprintf(fp, "tick_max,,,1,%.3f,%.3f\n", toMicroseconds(_tickMaxTime), toMicroseconds(_tickMaxTime));
+	for (int i = 0; i < kOpcodesTableSize; ++i) {
+		const Opcode *op = &_opcodesTable[i];
+		if (op->counter.count != 0) {
+			fprintf(fp, "%s,,%d,%u,%.3f,%.3f\n", op->condition ? "condition" : "operator", op->num, op->counter.count, toMicroseconds(op->counter.time), averageMicroseconds(&op->counter));
+		}
+	}
+	for (int i = 0; i < _animationsCount; ++i) {
+		const Animation *a = &_animationsTable[i];
+		fprintf(fp, "animation,%s,,%u,%.3f,%.3f\n", a->name, a->counter.count, toMicroseconds(a->counter.time), averageMicroseconds(&a->counter));
+		for (int j = 0; j < a->statementsCount; ++j) {
+			const ProfileCounter *c = &a->statementsTable[j];
+			if (c->count != 0) {
+				fprintf(fp, "statement,%s,%d,%u,%.3f,%.3f\n", a->name, j, c->count, toMicroseconds(c->time), averageMicroseconds(c));
+			}
+		}
+	}
+	for (int i = 0; i < _objectsCount; ++i) {
+		const Object *o = &_objectsTable[i];
+		const char *animationName = (o->animation != -1) ? _animationsTable[o->animation].name : "";
+		fprintf(fp, "object,%s,%s,%u,%.3f,%.3f\n", animationName, o->name, o->counter.count, toMicroseconds(o->counter.time), averageMicroseconds(&o->counter));
+	}
+}
+
+static void dumpJsonCounter(FILE *fp, const ProfileCounter *c) {
+	fprintf(fp, "\"count\": %u, \"total_us\": %.3f, \"average_us\": %.3f", c->count, toMicroseconds(c->time), averageMicroseconds(c));
+}
+
+static void dumpJsonString(FILE *fp, const char *s) {
+	fputc('"', fp);
+	for (; *s; ++s) {
+		if (*s == '"' || *s == '\\') {
+			fputc('\\', fp);
+		}
+		fputc(*s, fp);
+	}
+	fputc('"', fp);
+}
+
+void ScriptProfiler::dumpJson(FILE *fp) {
+	fprintf(fp, "{\n\t\"ticks\": { ");
+	dumpJsonCounter(fp, &_ticks);
+	fprintf(fp, ", \"max_us\": %.3f },\n", toMicroseconds(_tickMaxTime));
+	fprintf(fp, "\t\"opcodes\": [");
+	bool first = true;
+	for (int i = 0; i < kOpcodesTableSize; ++i) {
+		const Opcode *op = &_opcodesTable[i];
+		if (op->counter.count != 0) {
+			fprintf(fp, "%s\n\t\t{ \"type\": \"%s\", \"num\": %d, ", first ? "" : ",", op->condition ? "condition" : "operator", op->num);
+			dumpJsonCounter(fp, &op->counter);
+			fprintf(fp, " }");
+			first = false;
+		}
+	}
+	fprintf(fp, "\n\t],\n\t\"animations\": [");
+	for (int i = 0; i < _animationsCount; ++i) {
+		const Animation *a = &_animationsTable[i];
+		fprintf(fp, "%s\n\t\t{ \"name\": ", (i == 0) ? "" : ",");
+		dumpJsonString(fp, a->name);
+		fprintf(fp, ", ");
+		dumpJsonCounter(fp, &a->counter);
+		fprintf(fp, ", \"statements\": [");
+		first = true;
+		for (int j = 0; j < a->statementsCount; ++j) {
+			const ProfileCounter *c = &a->statementsTable[j];
+			if (c->count != 0) {
+				fprintf(fp, "%s\n\t\t\t{ \"num\": %d, ", first ? "" : ",", j);
+				dumpJsonCounter(fp, c);
+				fprintf(fp, " }");
+				first = false;
+			}
+		}
+		fprintf(fp, " ] }");
+	}
+	fprintf(fp, "\n\t],\n\t\"objects\": [");
+	for (int i = 0; i < _objectsCount; ++i) {
+		const Object *o = &_objectsTable[i];
+		fprintf(fp, "%s\n\t\t{ \"name\": ", (i == 0) ? "" : ",");
+		dumpJsonString(fp, o->name);
+		fprintf(fp, ", \"animation\": ");
+		dumpJsonString(fp, (o->animation != -1) ? _animationsTable[o->animation].name : "");
+		fprintf(fp, ", ");
+		dumpJsonCounter(fp, &o->counter);
+		fprintf(fp, " }");
+	}
+	fprintf(fp, "\n\t]\n}\n");
+}
+
+void ScriptProfiler::dump() {
+	if (!_enabled) {
+		return;
+	}
+	FILE *fp = fopen(_filePath, "w");
+	if (!fp) {
+		warning("Unable to write script profile to '%s'", _filePath);
+		return;
+	}
+	const char *ext = strrchr(_filePath, '.');
+	if (ext && strcasecmp(ext, ".json") == 0) {
+		dumpJson(fp);
+	} else {
+		dumpCsv(fp);
+	}
+	fclose(fp);
+	debug(DBG_INFO, "Written script profile to '%s'", _filePath);
+}
+
+TraceProfiler g_traceProfiler;
+
+TraceProfiler::TraceProfiler()
+	: _enabled(false), _filePath(0), _startTime(0) {
+	memset(_threadsTable, 0, sizeof(_threadsTable));
+}
+
+TraceProfiler::~TraceProfiler() {
+	fini();
+}
+
+void TraceProfiler::init(const char *filePath) {
+	_filePath = strdup(filePath);
+	if (!_filePath) {
+		error("Unable to allocate trace profiler tables");
+	}
+	for (int i = 0; i < kThreadsCount; ++i) {
+		_threadsTable[i].eventsTable = (Event *)malloc(kMaxEvents * sizeof(Event));
+		if (!_threadsTable[i].eventsTable) {
+			error("Unable to allocate trace profiler tables");
+		}
+	}
+	_startTime = ScriptProfiler::getTime();
+	_enabled = true;
+}
+
+void TraceProfiler::fini() {
+	if (_enabled) {
+		_enabled = false;
+		dump();
+	}
+	free(_filePath);
+	_filePath = 0;
+	for (int i = 0; i < kThreadsCount; ++i) {
+		free(_threadsTable[i].eventsTable);
+	}
+	memset(_threadsTable, 0, sizeof(_threadsTable));
+}
+
+void TraceProfiler::dump() {
+	FILE *fp = fopen(_filePath, "w");
+	if (!fp) {
+		warning("Unable to write trace to '%s'", _filePath);
+		return;
+	}
+	static const char *threadNames[] = { "game", "audio" };
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (int i = 0; i < kThreadsCount; ++i) {
+		fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", (i == 0) ? "" : ",\n", i, threadNames[i]);
+	}
+	for (int i = 0; i < kThreadsCount; ++i) {
+		const Thread *t = &_threadsTable[i];
+		for (int j = 0; j < t->eventsCount; ++j) {
+			const Event *ev = &t->eventsTable[j];
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"bs\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ev->name, i, toMicroseconds(ev->start - _startTime), toMicroseconds(ev->duration));
+		}
+		if (t->droppedEventsCount != 0) {
+			warning("Trace %s thread dropped %d events", threadNames[i], t->droppedEventsCount);
+		}
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(fp);
+	debug(DBG_INFO, "Written trace to '%s'", _filePath);
+}
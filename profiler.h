@@ -0,0 +1,151 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef PROFILER_H__
+#define PROFILER_H__
+
+#include "intern.h"
+
+struct ProfileCounter {
+	uint32_t count;
+	uint64_t time; // nanoseconds
+};
+
+// object scripts execution counters, dumped as .csv or .json (depending on the file extension)
+struct ScriptProfiler {
+	enum {
+		kOpcodesTableSize = 256,
+		kAnimationsTableSize = 128,
+		kObjectsTableSize = 512,
+		kMaxStatements = 512
+	};
+
+	struct Opcode {
+		int num;
+		bool condition;
+		ProfileCounter counter;
+	};
+
+	struct Animation {
+		char name[20];
+		ProfileCounter counter;
+		int statementsCount;
+		ProfileCounter statementsTable[kMaxStatements];
+	};
+
+	struct Object {
+		char name[20];
+		int animation;
+		ProfileCounter counter;
+	};
+
+	ScriptProfiler();
+	~ScriptProfiler();
+
+	void init(const char *filePath);
+	void fini();
+
+	static uint64_t getTime();
+
+	void beginTick();
+	void endTick();
+	void beginObject(const char *name, const char *animationName);
+	void endObject();
+	void addOpcode(bool condition, int num, uint64_t t0);
+	void addStatement(int statement, uint64_t t0);
+
+	void dump();
+	void dumpCsv(FILE *fp);
+	void dumpJson(FILE *fp);
+
+	bool _enabled;
+	char *_filePath;
+	Opcode *_opcodesTable;
+	int _opcodesCount;
+	Animation *_animationsTable;
+	int _animationsCount;
+	Object *_objectsTable;
+	int _objectsCount;
+	ProfileCounter _ticks;
+	uint64_t _tickStartTime;
+	uint64_t _tickMaxTime;
+	Animation *_currentAnimation;
+	Object *_currentObject;
+	uint64_t _objectStartTime;
+};
+
+// main loop phases timings, written as a Chrome trace (about://tracing, Perfetto)
+struct TraceProfiler {
+	enum {
+		kThreadGame,
+		kThreadAudio,
+		kThreadsCount
+	};
+	enum {
+		kMaxEvents = 1 << 18 // per thread
+	};
+
+	struct Event {
+		const char *name;
+		uint64_t start;
+		uint64_t duration;
+	};
+
+	// each table has a single writer thread
+	struct Thread {
+		Event *eventsTable;
+		int eventsCount;
+		int droppedEventsCount;
+	};
+
+	TraceProfiler();
+	~TraceProfiler();
+
+	void init(const char *filePath);
+	void fini();
+
+	void addEvent(int thread, const char *name, uint64_t start) {
+		Thread *t = &_threadsTable[thread];
+		if (t->eventsCount < kMaxEvents) {
+			Event *ev = &t->eventsTable[t->eventsCount++];
+			ev->name = name;
+			ev->start = start;
+			ev->duration = ScriptProfiler::getTime() - start;
+		} else {
+			++t->droppedEventsCount;
+		}
+	}
+
+	void dump();
+
+	bool _enabled;
+	char *_filePath;
+	uint64_t _startTime;
+	Thread _threadsTable[kThreadsCount];
+};
+
+extern TraceProfiler g_traceProfiler;
+
+// times the enclosing block, only reads a flag when tracing is disabled
+struct TraceScope {
+	const char *_name;
+	int _thread;
+	uint64_t _start;
+
+	TraceScope(const char *name, int thread = TraceProfiler::kThreadGame)
+		: _name(0), _thread(thread), _start(0) {
+		if (g_traceProfiler._enabled) {
+			_name = name;
+			_start = ScriptProfiler::getTime();
+		}
+	}
+	~TraceScope() {
+		if (_name) {
+			g_traceProfiler.addEvent(_thread, _name, _start);
+		}
+	}
+};
+
+#endif // PROFILER_H__
@@ -0,0 +1,202 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "profiler.h"
+#include "random.h"
+#include "recorder.h"
+#include "systemstub.h"
+
+static const uint32_t kRecordTag = 0x52495342; // 'BSIR'
+static const uint32_t kRecordVersion = 2;
+
+enum {
+	kInputEnter = 1 << 0,
+	kInputSpace = 1 << 1,
+	kInputShift = 1 << 2,
+	kInputCtrl = 1 << 3,
+	kInputTab = 1 << 4,
+	kInputEscape = 1 << 5,
+	kInputLeftMouseButton = 1 << 6,
+	kInputRightMouseButton = 1 << 7,
+	kInputSave = 1 << 8,
+	kInputLoad = 1 << 9
+};
+
+InputRecorder::InputRecorder()
+	: _mode(kModeNone), _ticksCount(0), _frameHash(0), _frameCaptured(false), _capturedFrameHash(0), _framesHash(0), _mismatchesCount(0), _firstMismatchTick(0),
+	_startTime(0), _tickStartTime(0), _tickTimesTable(0), _tickTimesSize(0) {
+}
+
+InputRecorder::~InputRecorder() {
+	fini();
+}
+
+bool InputRecorder::initRecord(const char *filePath, const RandomGenerator *rnd) {
+	if (!_f.open(filePath, "wb")) {
+		warning("Unable to open '%s' for recording", filePath);
+		return false;
+	}
+	_f.writeUint32LE(kRecordTag);
+	_f.writeUint32LE(kRecordVersion);
+	_f.writeUint32LE(rnd->_randomSeed);
+	_mode = kModeRecord;
+	debug(DBG_INFO, "Recording input to '%s'", filePath);
+	return true;
+}
+
+bool InputRecorder::initReplay(const char *filePath, RandomGenerator *rnd) {
+	if (!_f.open(filePath, "rb")) {
+		warning("Unable to open '%s' for replay", filePath);
+		return false;
+	}
+	const uint32_t tag = _f.readUint32LE();
+	const uint32_t version = _f.readUint32LE();
+	if (tag != kRecordTag || version != kRecordVersion) {
+		warning("Unsupported input recording '%s' tag 0x%X version %d", filePath, tag, version);
+		_f.close();
+		return false;
+	}
+	rnd->_randomSeed = _f.readUint32LE();
+	_mode = kModeReplay;
+	debug(DBG_INFO, "Replaying input from '%s'", filePath);
+	return true;
+}
+
+void InputRecorder::fini() {
+	if (_mode != kModeNone) {
+		dumpStats();
+		_f.close();
+		_mode = kModeNone;
+	}
+	free(_tickTimesTable);
+	_tickTimesTable = 0;
+	_tickTimesSize = 0;
+}
+
+bool InputRecorder::beginTick(PlayerInput *pi) {
+	if (_mode == kModeReplay) {
+		_f.read(_tickData, sizeof(_tickData));
+		_frameHash = _f.readUint32LE();
+		if (_f.ioErr()) {
+			return false;
+		}
+		pi->dirMask = _tickData[0];
+		pi->stateSlot = _tickData[1];
+		const uint16_t mask = READ_LE_UINT16(_tickData + 2);
+		pi->enter = (mask & kInputEnter) != 0;
+		pi->space = (mask & kInputSpace) != 0;
+		pi->shift = (mask & kInputShift) != 0;
+		pi->ctrl = (mask & kInputCtrl) != 0;
+		pi->tab = (mask & kInputTab) != 0;
+		pi->escape = (mask & kInputEscape) != 0;
+		pi->leftMouseButton = (mask & kInputLeftMouseButton) != 0;
+		pi->rightMouseButton = (mask & kInputRightMouseButton) != 0;
+		pi->save = (mask & kInputSave) != 0;
+		pi->load = (mask & kInputLoad) != 0;
+		pi->mouseX = (int16_t)READ_LE_UINT16(_tickData + 4);
+		pi->mouseY = (int16_t)READ_LE_UINT16(_tickData + 6);
+		pi->fastMode = true;
+	} else {
+		uint16_t mask = 0;
+		if (pi->enter) mask |= kInputEnter;
+		if (pi->space) mask |= kInputSpace;
+		if (pi->shift) mask |= kInputShift;
+		if (pi->ctrl) mask |= kInputCtrl;
+		if (pi->tab) mask |= kInputTab;
+		if (pi->escape) mask |= kInputEscape;
+		if (pi->leftMouseButton) mask |= kInputLeftMouseButton;
+		if (pi->rightMouseButton) mask |= kInputRightMouseButton;
+		if (pi->save) mask |= kInputSave;
+		if (pi->load) mask |= kInputLoad;
+		_tickData[0] = pi->dirMask;
+		_tickData[1] = pi->stateSlot;
+		_tickData[2] = mask & 255;
+		_tickData[3] = mask >> 8;
+		_tickData[4] = pi->mouseX & 255;
+		_tickData[5] = (pi->mouseX >> 8) & 255;
+		_tickData[6] = pi->mouseY & 255;
+		_tickData[7] = (pi->mouseY >> 8) & 255;
+	}
+	_tickStartTime = ScriptProfiler::getTime();
+	if (_ticksCount == 0) {
+		_startTime = _tickStartTime;
+	}
+	return true;
+}
+
+void InputRecorder::captureFrame(const uint8_t *bits, int w, int h, int pitch) {
+	_capturedFrameHash = hashFrame(bits, w, h, pitch);
+	_frameCaptured = true;
+}
+
+void InputRecorder::endTick(const uint8_t *bits, int w, int h, int pitch) {
+	const uint32_t hash = _frameCaptured ? _capturedFrameHash : hashFrame(bits, w, h, pitch);
+	_frameCaptured = false;
+	const uint64_t dt = ScriptProfiler::getTime() - _tickStartTime;
+	if (_mode == kModeRecord) {
+		_f.write(_tickData, sizeof(_tickData));
+		_f.writeUint32LE(hash);
+	} else if (hash != _frameHash) {
+		if (_mismatchesCount == 0) {
+			_firstMismatchTick = _ticksCount;
+			warning("Frame hash mismatch at tick %d, 0x%08X expected 0x%08X", _ticksCount, hash, _frameHash);
+		}
+		++_mismatchesCount;
+	}
+	_framesHash = (_framesHash ^ hash) * 16777619;
+	if (_ticksCount >= _tickTimesSize) {
+		_tickTimesSize = _tickTimesSize ? _tickTimesSize * 2 : 4096;
+		_tickTimesTable = (uint32_t *)realloc(_tickTimesTable, _tickTimesSize * sizeof(uint32_t));
+		if (!_tickTimesTable) {
+			error("Unable to allocate %d tick times", _tickTimesSize);
+		}
+	}
+	_tickTimesTable[_ticksCount] = (uint32_t)(dt / 1000);
+	++_ticksCount;
+}
+
+// FNV-1a
+uint32_t InputRecorder::hashFrame(const uint8_t *bits, int w, int h, int pitch) {
+	uint32_t hash = 2166136261U;
+	if (!bits) {
+		return hash;
+	}
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) {
+			hash = (hash ^ bits[x]) * 16777619;
+		}
+		bits += pitch;
+	}
+	return hash;
+}
+
+static int compareTickTimes(const void *a, const void *b) {
+	const uint32_t t1 = *(const uint32_t *)a;
+	const uint32_t t2 = *(const uint32_t *)b;
+	return (t1 < t2) ? -1 : ((t1 > t2) ? 1 : 0);
+}
+
+void InputRecorder::dumpStats() {
+	if (_ticksCount == 0) {
+		return;
+	}
+	const uint64_t elapsed = ScriptProfiler::getTime() - _startTime;
+	qsort(_tickTimesTable, _ticksCount, sizeof(uint32_t), compareTickTimes);
+	const uint32_t p50 = _tickTimesTable[_ticksCount * 50 / 100];
+	const uint32_t p90 = _tickTimesTable[_ticksCount * 90 / 100];
+	const uint32_t p99 = _tickTimesTable[_ticksCount * 99 / 100];
+	const uint32_t max = _tickTimesTable[_ticksCount - 1];
+	fprintf(stdout, "%s %d ticks in %.3f s, %.1f ticks/sec\n", (_mode == kModeRecord) ? "Recorded" : "Replayed",
+		_ticksCount, elapsed / 1000000000., elapsed ? _ticksCount * 1000000000. / elapsed : 0.);
+	fprintf(stdout, "Tick latency p50 %d us, p90 %d us, p99 %d us, max %d us\n", p50, p90, p99, max);
+	fprintf(stdout, "Frames hash 0x%08X\n", _framesHash);
+	if (_mode == kModeReplay) {
+		if (_mismatchesCount != 0) {
+			fprintf(stdout, "%d frames mismatch, first at tick %d\n", _mismatchesCount, _firstMismatchTick);
+		} else {
+			fprintf(stdout, "All frames match\n");
+		}
+	}
+}
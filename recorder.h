@@ -0,0 +1,56 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef RECORDER_H__
+#define RECORDER_H__
+
+#include "intern.h"
+#include "file.h"
+
+struct PlayerInput;
+struct RandomGenerator;
+
+// records the player input of each game tick, along with a hash of the rendered frame
+struct InputRecorder {
+	enum {
+		kModeNone,
+		kModeRecord,
+		kModeReplay
+	};
+
+	InputRecorder();
+	~InputRecorder();
+
+	bool initRecord(const char *filePath, const RandomGenerator *rnd);
+	bool initReplay(const char *filePath, RandomGenerator *rnd);
+	void fini();
+
+	bool beginTick(PlayerInput *pi);
+	// hashes the composited frame, before the background is restored under the objects
+	void captureFrame(const uint8_t *bits, int w, int h, int pitch);
+	// bits is hashed if no frame was captured during the tick
+	void endTick(const uint8_t *bits, int w, int h, int pitch);
+
+	static uint32_t hashFrame(const uint8_t *bits, int w, int h, int pitch);
+
+	void dumpStats();
+
+	int _mode;
+	File _f;
+	uint32_t _ticksCount;
+	uint32_t _frameHash;
+	bool _frameCaptured;
+	uint32_t _capturedFrameHash;
+	uint32_t _framesHash;
+	uint32_t _mismatchesCount;
+	uint32_t _firstMismatchTick;
+	uint64_t _startTime;
+	uint64_t _tickStartTime;
+	uint32_t *_tickTimesTable; // microseconds
+	uint32_t _tickTimesSize;
+	uint8_t _tickData[8];
+};
+
+#endif // RECORDER_H__
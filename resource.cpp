@@ -7,6 +7,7 @@
 #include "file.h"
 #include "fs.h"
 #include "game.h"
+#include "mixer.h"
 #include "str.h"
 
 static const bool kDumpObjectScript = false;
@@ -24,9 +25,23 @@ void Game::allocateTables() {
 	if (!_bitmapBuffer2) {
 		error("Unable to allocate bitmap buffer 2 (%d bytes)", kBitmapBufferDefaultSize);
 	}
+	_depthMask = (uint8_t *)malloc(kGameScreenWidth * kGameScreenHeight);
+	if (!_depthMask) {
+		error("Unable to allocate depth mask (%d bytes)", kGameScreenWidth * kGameScreenHeight);
+	}
+	for (int i = 0; i < NUM_SCENE_OBJECT_FRAMES; ++i) {
+		DecodedFrame *df = &_decodedFramesTable[i];
+		df->data = 0;
+		df->spans = 0;
+		df->dataSize = 0;
+		df->prev = df->next = -1;
+	}
+	_decodedFramesHead = _decodedFramesTail = -1;
+	_decodedFramesSize = 0;
 }
 
 void Game::deallocateTables() {
+	clearDecodedFrames(0);
 	if (_bitmapBuffer0) {
 		free(_bitmapBuffer0);
 		_bitmapBuffer0 = 0;
@@ -35,6 +50,10 @@ void Game::deallocateTables() {
 		free(_bitmapBuffer2);
 		_bitmapBuffer2 = 0;
 	}
+	if (_depthMask) {
+		free(_depthMask);
+		_depthMask = 0;
+	}
 	if (_tempDecodeBuffer) {
 		free(_tempDecodeBuffer);
 		_tempDecodeBuffer = 0;
@@ -57,13 +76,16 @@ void Game::loadCommonSprites() {
 	}
 	memcpy(_bagBackgroundImage.bits, _bitmapBuffer1.bits, bagBitmapSize);
 
-	loadFile("..\\bermuda.spr", _tempDecodeBuffer);
-	int decodedSize = READ_LE_UINT32(_tempDecodeBuffer + 2);
+	const uint8_t *sprData = _fs.mapFile("..\\bermuda.spr", 0);
+	if (!sprData) {
+		sprData = loadFile("..\\bermuda.spr", _tempDecodeBuffer);
+	}
+	int decodedSize = READ_LE_UINT32(sprData + 2);
 	_bermudaSprData = (uint8_t *)malloc(decodedSize);
 	if (!_bermudaSprData) {
 		error("Unable to allocate bermuda.spr buffer (%d bytes)", decodedSize);
 	}
-	decodeLzss(_tempDecodeBuffer + 2, _bermudaSprData);
+	decodeLzss(sprData + 2, _bermudaSprData);
 	_bermudaSprDataTable[0] = _bermudaSprData;
 	for (int i = 1; i < 3; ++i) {
 		_bermudaSprDataTable[i] = _bermudaSprDataTable[i - 1] + getBitmapSize(_bermudaSprDataTable[i - 1]);
@@ -144,9 +166,58 @@ uint8_t *Game::loadFile(const char *fileName, uint8_t *dst, uint32_t *dstSize) {
 	return dst;
 }
 
+struct WGPChunk {
+	const uint8_t *src;
+	uint8_t *dst;
+};
+
+static void decodeWGPChunk(void *param, int num) {
+	const WGPChunk *chunk = (const WGPChunk *)param + num;
+	decodeLzss(chunk->src, chunk->dst);
+}
+
+int Game::decodeWGPChunks(const uint8_t *src, int srcSize, uint8_t *dst) {
+	int count = 0;
+	for (int offset = 0; offset + 2 <= srcSize; ) {
+		const int sz = READ_LE_UINT16(src + offset);
+		offset += 2 + sz;
+		if (sz != 0) {
+			++count;
+		}
+	}
+	WGPChunk *chunks = (WGPChunk *)malloc(count * sizeof(WGPChunk));
+	if (!chunks) {
+		error("Unable to allocate %d wgp chunks", count);
+	}
+	int len = 0;
+	count = 0;
+	for (int offset = 0; offset + 2 <= srcSize; ) {
+		const int sz = READ_LE_UINT16(src + offset);
+		offset += 2;
+		if (sz != 0) {
+			if (offset + sz > srcSize) {
+				error("Truncated wgp chunk at offset %d", offset);
+			}
+			chunks[count].src = src + offset;
+			chunks[count].dst = dst + len;
+			++count;
+			len += READ_LE_UINT32(src + offset);
+			if (len > kBitmapBufferDefaultSize) {
+				error("Invalid wgp decoded size %d", len);
+			}
+			offset += sz;
+		}
+	}
+	_threadPool.run(decodeWGPChunk, chunks, count);
+	free(chunks);
+	return len;
+}
+
 void Game::loadWGP(const char *fileName) {
+	TraceScope trace("loadWGP");
 	debug(DBG_RES, "Game::loadWGP('%s')", fileName);
 	FileHolder fp(_fs, fileName);
+	const uint8_t *mappedData = _fs.mapFile(fileName, 0);
 	int offs = kOffsetBitmapBits;
 	int len = 0;
 	int tag = fp->readUint16LE();
@@ -157,7 +228,15 @@ void Game::loadWGP(const char *fileName) {
 	} else if (tag == 0x5057) {
 		len = 0;
 		int dataSize = fp->size();
-		do {
+		if (mappedData) {
+			len = decodeWGPChunks(mappedData + 2, dataSize - 2, _bitmapBuffer0);
+			dataSize = 0;
+		} else if (dataSize - 2 <= kBitmapBufferDefaultSize) {
+			fp->read(_bitmapBuffer2, dataSize - 2);
+			len = decodeWGPChunks(_bitmapBuffer2, dataSize - 2, _bitmapBuffer0);
+			dataSize = 0;
+		}
+		while (dataSize > 0) {
 			const int sz = fp->readUint16LE();
 			if (fp->ioErr()) {
 				break;
@@ -168,13 +247,17 @@ void Game::loadWGP(const char *fileName) {
 				dataSize -= sz;
 			}
 			dataSize -= 2;
-		} while (dataSize > 0);
+		}
 		offs += 4;
 		len += 4;
 	} else if (tag == 0x505A) {
-		const int sz = fp->size() - 2;
-		fp->read(_bitmapBuffer2, sz);
-		len = decodeZlib(_bitmapBuffer2, _bitmapBuffer0);
+		if (mappedData) {
+			len = decodeZlib(mappedData + 2, _bitmapBuffer0);
+		} else {
+			const int sz = fp->size() - 2;
+			fp->read(_bitmapBuffer2, sz);
+			len = decodeZlib(_bitmapBuffer2, _bitmapBuffer0);
+		}
 	} else {
 		error("Invalid wgp format %X", tag);
 	}
@@ -187,11 +270,27 @@ void Game::loadWGP(const char *fileName) {
 	_bitmapBuffer3 = _bitmapBuffer1;
 	_bitmapBuffer3.bits = _bitmapBuffer0 + offs;
 	memcpy(_bitmapBuffer1.bits, _bitmapBuffer3.bits, len - offs);
+	_dirtyFullScreen = true;
+	_depthMaskDirty = true; // color range boxes depend on the background pixels
+}
+
+// returns the len bytes at the file position, from the file mapping if any or copied to the arena
+static const uint8_t *readMappedData(File *fp, const uint8_t *mappedData, uint32_t mappedSize, Arena *arena, int len) {
+	const uint32_t offset = fp->tell();
+	if (mappedData && offset + len <= mappedSize) {
+		fp->seek(len, SEEK_CUR);
+		return mappedData + offset;
+	}
+	uint8_t *data = (uint8_t *)arena->allocate(len);
+	fp->read(data, len);
+	return data;
 }
 
 void Game::loadSPR(const char *fileName, SceneAnimation *sa) {
 	debug(DBG_RES, "Game::loadSPR('%s')", fileName);
 	FileHolder fp(_fs, fileName);
+	uint32_t mappedSize = 0;
+	const uint8_t *mappedData = _fs.mapFile(fileName, &mappedSize);
 	int (*decode)(const uint8_t *, uint8_t *) = 0;
 	const int tag = fp->readUint16LE();
 	if (tag == 0x3553) {
@@ -216,12 +315,9 @@ void Game::loadSPR(const char *fileName, SceneAnimation *sa) {
 		assert(_sceneObjectFramesCount + num <= NUM_SCENE_OBJECT_FRAMES);
 		for (int i = 0; i < num; ++i) {
 			int len = fp->readUint16LE();
+			unloadDecodedFrame(_sceneObjectFramesCount);
 			SceneObjectFrame *frame = &_sceneObjectFramesTable[_sceneObjectFramesCount];
-			frame->data = (uint8_t *)malloc(len);
-			if (!frame->data) {
-				error("Unable to allocate %d bytes", len);
-			}
-			fp->read(frame->data, len);
+			frame->data = readMappedData(fp._fp, mappedData, mappedSize, &_sceneArena, len);
 			frame->hdr.num = fp->readUint16LE();
 			frame->hdr.w = fp->readUint16LE();
 			frame->hdr.h = fp->readUint16LE();
@@ -242,21 +338,25 @@ static void dumpObjectScript(SceneAnimation *sa, const char *dirPath, const char
 		snprintf(filePath, sizeof(filePath), "%s/dumps/%s.script", dirPath, name + 1);
 		File f;
 		if (f.open(filePath, "wb")) {
-			f.write(sa->scriptData, sa->scriptSize);
+			f.write((uint8_t *)sa->scriptData, sa->scriptSize);
 			f.close();
 		}
 	}
 }
 
 void Game::loadMOV(const char *fileName) {
+	TraceScope trace("loadMOV");
 	debug(DBG_RES, "Game::loadMOV('%s')", fileName);
 	FileHolder fp(_fs, fileName);
+	uint32_t mappedSize = 0;
+	const uint8_t *mappedData = _fs.mapFile(fileName, &mappedSize);
 	int tag = fp->readUint16LE();
 	if (tag != 0x354D) {
 		error("Invalid mov format %X", tag);
 	}
 	assert(_animationsCount < NUM_SCENE_ANIMATIONS);
 	SceneAnimation *sa = &_animationsTable[_animationsCount];
+	_animationsArenaMarkTable[_animationsCount] = _sceneArena.mark();
 
 	char sprName[128];
 	int len = fp->readUint16LE();
@@ -386,12 +486,13 @@ void Game::loadMOV(const char *fileName) {
 			break;
 		case 4:
 			sa->scriptSize = fp->readUint16LE();
+			sa->scriptCode = 0;
 			if (sa->scriptSize != 0) {
-				sa->scriptData = (uint8_t *)malloc(sa->scriptSize);
-				fp->read(sa->scriptData, sa->scriptSize);
+				sa->scriptData = readMappedData(fp._fp, mappedData, mappedSize, &_sceneArena, sa->scriptSize);
 				if (kDumpObjectScript) {
 					dumpObjectScript(sa, _savePath, fileName);
 				}
+				sa->scriptCode = compileObjectScript(sa->scriptData, sa->scriptSize);
 			}
 			break;
 		case 5:
@@ -420,16 +521,63 @@ void Game::loadMOV(const char *fileName) {
 	stringToLowerCase(sa->name);
 
 	++_animationsCount;
+	++_sceneObjectsGeneration;
 
-//	for (int i = sa->firstSoundBufferIndex; i < _soundBuffersCount; ++i) {
-//		SoundBuffer *sb = &_soundBuffersTable[i];
-//		sb->buffer = loadFile(sb->filename);
-//	}
+	// the decoded sounds of the animations no longer loaded are released
+	const char *soundNames[NUM_SOUND_BUFFERS];
+	for (int i = 0; i < _soundBuffersCount; ++i) {
+		soundNames[i] = _soundBuffersTable[i].filename;
+	}
+	_mixer->trimSoundsCache(soundNames, _soundBuffersCount);
+	preloadSoundBuffers(sa->firstSoundBufferIndex, sa->soundBuffersCount);
 
 	_loadDataState = 2;
 //	_skipUpdateScreen = false;
 }
 
+struct SoundBuffersPreload {
+	Game *g;
+	int count;
+	char filenames[Game::NUM_SOUND_BUFFERS][40];
+};
+
+static void preloadSoundBuffersJob(void *param) {
+	SoundBuffersPreload *sbp = (SoundBuffersPreload *)param;
+	for (int i = 0; i < sbp->count; ++i) {
+		File *f = sbp->g->_fs.openFile(sbp->filenames[i], false);
+		if (f) {
+			sbp->g->_mixer->preloadSound(f, sbp->filenames[i]);
+			sbp->g->_fs.closeFile(f);
+		}
+	}
+}
+
+void Game::preloadSoundBuffers(int first, int count) {
+	if (!_mixer->canPreloadSounds()) {
+		return;
+	}
+	SoundBuffersPreload *sbp = (SoundBuffersPreload *)malloc(sizeof(SoundBuffersPreload));
+	if (!sbp) {
+		return;
+	}
+	sbp->g = this;
+	sbp->count = 0;
+	for (int i = first; i < first + count; ++i) {
+		const char *filename = _soundBuffersTable[i].filename;
+		if (!_mixer->isSoundCached(filename)) {
+			memcpy(sbp->filenames[sbp->count], filename, sizeof(sbp->filenames[0]));
+			++sbp->count;
+		}
+	}
+	debug(DBG_RES, "Game::preloadSoundBuffers() %d/%d sounds", sbp->count, count);
+	if (sbp->count == 0) {
+		free(sbp);
+		return;
+	}
+	// the sounds are opened and decoded on the background thread, the mixer caches them on the next play
+	_backgroundThread.post(preloadSoundBuffersJob, sbp);
+}
+
 void Game::loadKBR(const char *fileName) {
 	_keyboardReplaySize = 0;
 	_keyboardReplayOffset = 0;
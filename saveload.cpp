@@ -250,6 +250,7 @@ void Game::loadState(File *f, int slot, bool switchScene) {
 	for (int i = 0; i < _sceneObjectsCount; ++i) {
 		saveOrLoad_sceneObject(_sceneObjectsTable[i]);
 	}
+	++_sceneObjectsGeneration;
 	n = loadInt16();
 	assert(n <= NUM_BOXES);
 	for (int i = 0; i < n; ++i) {
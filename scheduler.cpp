@@ -0,0 +1,82 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "scheduler.h"
+#include "systemstub.h"
+
+TickScheduler::TickScheduler()
+	: _stub(0), _tickDuration(0) {
+}
+
+void TickScheduler::init(SystemStub *stub, int tickDuration) {
+	_stub = stub;
+	_tickDuration = tickDuration;
+	_startTimeStamp = _deadline = stub->getTimeStamp();
+	_ticksCount = 0;
+	_idleTime = 0;
+	_lateTicksCount = 0;
+	_resyncsCount = 0;
+	_jitterSum = _jitterMax = 0;
+	memset(_jitterHistogram, 0, sizeof(_jitterHistogram));
+}
+
+void TickScheduler::waitNextTick() {
+	uint32_t now = _stub->getTimeStamp();
+	if (_stub->_pi.fastMode) {
+		_stub->processEvents();
+		_deadline = _stub->getTimeStamp();
+		return;
+	}
+	// the next deadline derives from the previous one and not from the current time, so that ticks do not drift
+	_deadline += _tickDuration;
+	uint32_t jitter = 0;
+	if ((int32_t)(now - _deadline) > (int32_t)_tickDuration) {
+		// more than a tick late (loading, debugger...), restart the schedule instead of running the missed ticks back to back
+		jitter = now - _deadline;
+		_deadline = now;
+		++_resyncsCount;
+	}
+	if ((int32_t)(_deadline - now) <= 0) {
+		_stub->processEvents();
+	} else {
+		while (!_stub->_quit) {
+			const int32_t timeout = _deadline - now;
+			if (timeout <= 0) {
+				break;
+			}
+			_stub->waitEvents(timeout);
+			const uint32_t timeStamp = _stub->getTimeStamp();
+			_idleTime += timeStamp - now;
+			now = timeStamp;
+		}
+	}
+	jitter += now - _deadline;
+	if (jitter != 0) {
+		++_lateTicksCount;
+	}
+	_jitterSum += jitter;
+	if (jitter > _jitterMax) {
+		_jitterMax = jitter;
+	}
+	++_jitterHistogram[MIN(jitter, (uint32_t)kJitterHistogramSize - 1)];
+	++_ticksCount;
+}
+
+void TickScheduler::dumpStats() {
+	if (_ticksCount == 0) {
+		return;
+	}
+	uint32_t p99 = 0;
+	for (uint32_t count = 0; p99 < kJitterHistogramSize - 1; ++p99) {
+		count += _jitterHistogram[p99];
+		if (count >= _ticksCount * 99 / 100) {
+			break;
+		}
+	}
+	const uint32_t elapsed = _stub->getTimeStamp() - _startTimeStamp;
+	debug(DBG_INFO, "%d ticks, jitter avg %.2f ms, p99 %d ms, max %d ms, %d late, %d resyncs",
+		_ticksCount, _jitterSum / (float)_ticksCount, p99, _jitterMax, _lateTicksCount, _resyncsCount);
+	debug(DBG_INFO, "Idle %.1f%% of %d ms", elapsed ? _idleTime * 100. / elapsed : 0., elapsed);
+}
@@ -0,0 +1,38 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef SCHEDULER_H__
+#define SCHEDULER_H__
+
+#include "intern.h"
+
+struct SystemStub;
+
+// paces the game ticks on fixed deadlines, blocking on input events in between
+struct TickScheduler {
+	enum {
+		kJitterHistogramSize = 64 // ms
+	};
+
+	TickScheduler();
+
+	void init(SystemStub *stub, int tickDuration);
+	void waitNextTick();
+	void dumpStats();
+
+	SystemStub *_stub;
+	uint32_t _tickDuration;
+	uint32_t _deadline;
+	uint32_t _startTimeStamp;
+	uint32_t _ticksCount;
+	uint32_t _idleTime;
+	uint32_t _lateTicksCount;
+	uint32_t _resyncsCount;
+	uint32_t _jitterSum;
+	uint32_t _jitterMax;
+	uint32_t _jitterHistogram[kJitterHistogramSize];
+};
+
+#endif // SCHEDULER_H__
@@ -30,6 +30,7 @@ struct PlayerInput {
 	bool load;
 	int stateSlot;
 	bool fastMode;
+	bool dumpProfile;
 };
 
 enum {
@@ -65,6 +66,8 @@ struct SystemStub {
 	virtual void unlockYUV() = 0;
 
 	virtual void processEvents() = 0;
+	// blocks until an input event is received or timeout ms elapsed, then processes the pending events
+	virtual void waitEvents(int timeout) = 0;
 	virtual void sleep(int duration) = 0;
 	virtual uint32_t getTimeStamp() = 0;
 
@@ -78,5 +81,6 @@ struct SystemStub {
 };
 
 extern SystemStub *SystemStub_SDL_create();
+extern SystemStub *SystemStub_Null_create(const char *inputPath, const char *audioPath, int duration);
 
 #endif // SYSTEMSTUB_H__
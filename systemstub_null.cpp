@@ -0,0 +1,406 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "blitter.h"
+#include "file.h"
+#include "mixer.h"
+#include "systemstub.h"
+
+enum {
+	kSoundSampleRate = 22050,
+	kMaxInputEvents = 4096
+};
+
+enum {
+	kInputUp,
+	kInputDown,
+	kInputLeft,
+	kInputRight,
+	kInputEnter,
+	kInputSpace,
+	kInputShift,
+	kInputCtrl,
+	kInputTab,
+	kInputEscape,
+	kInputLeftMouseButton,
+	kInputRightMouseButton,
+	kInputMouse,
+	kInputQuit
+};
+
+static const struct {
+	const char *name;
+	int input;
+} _inputNames[] = {
+	{ "up", kInputUp },
+	{ "down", kInputDown },
+	{ "left", kInputLeft },
+	{ "right", kInputRight },
+	{ "enter", kInputEnter },
+	{ "space", kInputSpace },
+	{ "shift", kInputShift },
+	{ "ctrl", kInputCtrl },
+	{ "tab", kInputTab },
+	{ "escape", kInputEscape },
+	{ "lmb", kInputLeftMouseButton },
+	{ "rmb", kInputRightMouseButton },
+	{ "mouse", kInputMouse },
+	{ "quit", kInputQuit },
+	{ 0, -1 }
+};
+
+struct InputEvent {
+	uint32_t timeStamp;
+	int input;
+	int value1, value2;
+};
+
+struct SystemStub_Null : SystemStub {
+	uint32_t _palette[256];
+	uint32_t *_offscreenBuffer;
+	int _w, _h;
+	uint8_t *_videoBuffer;
+	int _videoPitch;
+	const Blitter *_blitter;
+	Mixer *_mixer;
+	AudioCallback _audioProc;
+	void *_audioData;
+	int16_t *_audioBuffer;
+	int _audioBufferSize;
+	uint32_t _audioSamplesFrac;
+	uint32_t _audioSamplesCount;
+	File _audioFile;
+	bool _audioFileOpened;
+	uint32_t _timeStamp;
+	uint32_t _duration;
+	InputEvent *_inputEvents;
+	int _inputEventsCount;
+	int _inputEventsPos;
+	uint32_t _framesCount;
+
+	SystemStub_Null(const char *inputPath, const char *audioPath, int duration);
+	virtual ~SystemStub_Null();
+
+	virtual void init(const char *title, int w, int h, bool fullscreen, int screenMode);
+	virtual void destroy();
+	virtual void setIcon(const uint8_t *data, int size) {}
+	virtual void showCursor(bool show) {}
+	virtual void setPalette(const uint8_t *pal, int n);
+	virtual void fillRect(int x, int y, int w, int h, uint8_t color);
+	virtual void copyRect(int x, int y, int w, int h, const uint8_t *buf, int pitch, bool transparent);
+	virtual void darkenRect(int x, int y, int w, int h);
+	virtual void copyRectWidescreen(int w, int h, const uint8_t *buf, int pitch) {}
+	virtual void clearWidescreen() {}
+	virtual void updateScreen();
+	virtual void setYUV(bool flag, int w, int h);
+	virtual uint8_t *lockYUV(int *pitch);
+	virtual void unlockYUV() {}
+	virtual void processEvents();
+	virtual void waitEvents(int timeout);
+	virtual void sleep(int duration);
+	virtual uint32_t getTimeStamp();
+	virtual void lockAudio() {}
+	virtual void unlockAudio() {}
+	virtual void startAudio(AudioCallback callback, void *param);
+	virtual void stopAudio();
+	virtual int getOutputSampleRate();
+	virtual Mixer *getMixer() { return _mixer; }
+
+	void loadInputEvents(const char *path);
+	void handleInputEvent(const InputEvent &ev);
+	void mixAudio(int samples);
+};
+
+SystemStub *SystemStub_Null_create(const char *inputPath, const char *audioPath, int duration) {
+	return new SystemStub_Null(inputPath, audioPath, duration);
+}
+
+SystemStub_Null::SystemStub_Null(const char *inputPath, const char *audioPath, int duration)
+	: _offscreenBuffer(0), _videoBuffer(0), _audioProc(0), _audioData(0), _audioBuffer(0), _audioBufferSize(0),
+	_audioFileOpened(false), _timeStamp(0), _duration(duration), _inputEvents(0), _inputEventsCount(0), _inputEventsPos(0) {
+	_mixer = Mixer_Software_create(this);
+	if (inputPath) {
+		loadInputEvents(inputPath);
+	}
+	if (audioPath) {
+		_audioFileOpened = _audioFile.open(audioPath, "wb");
+		if (!_audioFileOpened) {
+			warning("Unable to open '%s' for writing", audioPath);
+		}
+	}
+}
+
+SystemStub_Null::~SystemStub_Null() {
+	delete _mixer;
+	free(_inputEvents);
+}
+
+void SystemStub_Null::init(const char *title, int w, int h, bool fullscreen, int screenMode) {
+	_quit = false;
+	memset(&_pi, 0, sizeof(_pi));
+	memset(_palette, 0, sizeof(_palette));
+	_offscreenBuffer = (uint32_t *)calloc(w * h, sizeof(uint32_t));
+	if (!_offscreenBuffer) {
+		error("SystemStub_Null::init() Unable to allocate offscreen buffer");
+	}
+	_w = w;
+	_h = h;
+	_blitter = getBlitter();
+	_audioSamplesFrac = 0;
+	_audioSamplesCount = 0;
+	_framesCount = 0;
+	_mixer->open();
+}
+
+void SystemStub_Null::destroy() {
+	_mixer->close();
+	free(_offscreenBuffer);
+	_offscreenBuffer = 0;
+	free(_videoBuffer);
+	_videoBuffer = 0;
+	free(_audioBuffer);
+	_audioBuffer = 0;
+	_audioBufferSize = 0;
+	if (_audioFileOpened) {
+		_audioFile.close();
+		_audioFileOpened = false;
+	}
+	debug(DBG_INFO, "SystemStub_Null::destroy() frames %d time %d ms audio samples %d", _framesCount, _timeStamp, _audioSamplesCount);
+}
+
+void SystemStub_Null::setPalette(const uint8_t *pal, int n) {
+	for (int i = 0; i < n; ++i) {
+		_palette[i] = (pal[2] << 16) | (pal[1] << 8) | pal[0];
+		pal += 4;
+	}
+}
+
+void SystemStub_Null::fillRect(int x, int y, int w, int h, uint8_t color) {
+	assert(x >= 0 && x + w <= _w && y >= 0 && y + h <= _h);
+	uint32_t *dst = _offscreenBuffer + y * _w + x;
+	const uint32_t rgb = _palette[color];
+	for (int j = 0; j < h; ++j) {
+		_blitter->fill32(dst, w, rgb);
+		dst += _w;
+	}
+}
+
+void SystemStub_Null::copyRect(int x, int y, int w, int h, const uint8_t *buf, int pitch, bool transparent) {
+	assert(x >= 0 && x + w <= _w && y >= 0 && y + h <= _h);
+	uint32_t *dst = _offscreenBuffer + y * _w + x;
+	buf += (h - 1) * pitch;
+	for (int j = 0; j < h; ++j) {
+		if (transparent) {
+			_blitter->expandPaletteTransparent(dst, buf, w, _palette);
+		} else {
+			_blitter->expandPalette(dst, buf, w, _palette);
+		}
+		dst += _w;
+		buf -= pitch;
+	}
+}
+
+void SystemStub_Null::darkenRect(int x, int y, int w, int h) {
+	assert(x >= 0 && x + w <= _w && y >= 0 && y + h <= _h);
+	const uint32_t mask = getDarkenMask(0xFF00FF, 0xFF00);
+	uint32_t *dst = _offscreenBuffer + y * _w + x;
+	for (int j = 0; j < h; ++j) {
+		_blitter->darken32(dst, w, mask);
+		dst += _w;
+	}
+}
+
+void SystemStub_Null::updateScreen() {
+	++_framesCount;
+}
+
+void SystemStub_Null::setYUV(bool flag, int w, int h) {
+	free(_videoBuffer);
+	_videoBuffer = 0;
+	if (flag) {
+		// YUY2, 2 bytes per pixel
+		_videoPitch = w * sizeof(uint16_t);
+		_videoBuffer = (uint8_t *)malloc(_videoPitch * h);
+	}
+}
+
+uint8_t *SystemStub_Null::lockYUV(int *pitch) {
+	*pitch = _videoPitch;
+	return _videoBuffer;
+}
+
+void SystemStub_Null::processEvents() {
+	while (_inputEventsPos < _inputEventsCount && _inputEvents[_inputEventsPos].timeStamp <= _timeStamp) {
+		handleInputEvent(_inputEvents[_inputEventsPos]);
+		++_inputEventsPos;
+	}
+	if (_duration != 0 && _timeStamp >= _duration) {
+		_quit = true;
+	}
+}
+
+void SystemStub_Null::waitEvents(int timeout) {
+	// wakes up on the next scripted input event
+	if (_inputEventsPos < _inputEventsCount) {
+		const uint32_t timeStamp = _inputEvents[_inputEventsPos].timeStamp;
+		if (timeStamp <= _timeStamp) {
+			timeout = 0;
+		} else if (timeStamp - _timeStamp < (uint32_t)timeout) {
+			timeout = timeStamp - _timeStamp;
+		}
+	}
+	sleep(timeout);
+	processEvents();
+}
+
+void SystemStub_Null::sleep(int duration) {
+	if (duration > 0) {
+		_timeStamp += duration;
+		// pull the samples the audio device would have consumed meanwhile
+		const uint32_t count = duration * kSoundSampleRate + _audioSamplesFrac;
+		_audioSamplesFrac = count % 1000;
+		mixAudio(count / 1000);
+	}
+}
+
+uint32_t SystemStub_Null::getTimeStamp() {
+	return _timeStamp;
+}
+
+void SystemStub_Null::startAudio(AudioCallback callback, void *param) {
+	_audioProc = callback;
+	_audioData = param;
+}
+
+void SystemStub_Null::stopAudio() {
+	_audioProc = 0;
+}
+
+int SystemStub_Null::getOutputSampleRate() {
+	return kSoundSampleRate;
+}
+
+void SystemStub_Null::loadInputEvents(const char *path) {
+	FILE *fp = fopen(path, "r");
+	if (!fp) {
+		warning("Unable to open input events file '%s'", path);
+		return;
+	}
+	_inputEvents = (InputEvent *)malloc(kMaxInputEvents * sizeof(InputEvent));
+	if (!_inputEvents) {
+		error("SystemStub_Null::loadInputEvents() Unable to allocate %d events", kMaxInputEvents);
+	}
+	uint32_t prevTimeStamp = 0;
+	char line[256];
+	for (int lineNum = 1; fgets(line, sizeof(line), fp); ++lineNum) {
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+			continue;
+		}
+		if (_inputEventsCount >= kMaxInputEvents) {
+			warning("Too many input events in '%s', ignoring from line %d", path, lineNum);
+			break;
+		}
+		// '<time ms> <input> [value1] [value2]'
+		InputEvent *ev = &_inputEvents[_inputEventsCount];
+		char name[32];
+		unsigned int timeStamp;
+		ev->value1 = 1;
+		ev->value2 = 0;
+		if (sscanf(line, "%u %31s %d %d", &timeStamp, name, &ev->value1, &ev->value2) < 2) {
+			warning("Malformed input event at line %d of '%s'", lineNum, path);
+			continue;
+		}
+		if (timeStamp < prevTimeStamp) {
+			warning("Out of order input event at line %d of '%s'", lineNum, path);
+			continue;
+		}
+		ev->input = -1;
+		for (int i = 0; _inputNames[i].name; ++i) {
+			if (strcmp(_inputNames[i].name, name) == 0) {
+				ev->input = _inputNames[i].input;
+				break;
+			}
+		}
+		if (ev->input < 0) {
+			warning("Unknown input '%s' at line %d of '%s'", name, lineNum, path);
+			continue;
+		}
+		ev->timeStamp = prevTimeStamp = timeStamp;
+		++_inputEventsCount;
+	}
+	fclose(fp);
+	debug(DBG_INFO, "Loaded %d input events from '%s'", _inputEventsCount, path);
+}
+
+void SystemStub_Null::handleInputEvent(const InputEvent &ev) {
+	const bool pressed = (ev.value1 != 0);
+	switch (ev.input) {
+	case kInputUp:
+	case kInputDown:
+	case kInputLeft:
+	case kInputRight: {
+			const uint8_t mask = 1 << (ev.input - kInputUp);
+			if (pressed) {
+				_pi.dirMask |= mask;
+			} else {
+				_pi.dirMask &= ~mask;
+			}
+		}
+		break;
+	case kInputEnter:
+		_pi.enter = pressed;
+		break;
+	case kInputSpace:
+		_pi.space = pressed;
+		break;
+	case kInputShift:
+		_pi.shift = pressed;
+		break;
+	case kInputCtrl:
+		_pi.ctrl = pressed;
+		break;
+	case kInputTab:
+		_pi.tab = pressed;
+		break;
+	case kInputEscape:
+		_pi.escape = pressed;
+		break;
+	case kInputLeftMouseButton:
+		_pi.leftMouseButton = pressed;
+		break;
+	case kInputRightMouseButton:
+		_pi.rightMouseButton = pressed;
+		break;
+	case kInputMouse:
+		_pi.mouseX = ev.value1;
+		_pi.mouseY = ev.value2;
+		break;
+	case kInputQuit:
+		_quit = true;
+		break;
+	}
+}
+
+void SystemStub_Null::mixAudio(int samples) {
+	if (!_audioProc || samples <= 0) {
+		return;
+	}
+	// S16 stereo
+	const int size = samples * 2 * sizeof(int16_t);
+	if (size > _audioBufferSize) {
+		free(_audioBuffer);
+		_audioBuffer = (int16_t *)malloc(size);
+		if (!_audioBuffer) {
+			error("SystemStub_Null::mixAudio() Unable to allocate %d bytes", size);
+		}
+		_audioBufferSize = size;
+	}
+	memset(_audioBuffer, 0, size);
+	_audioProc(_audioData, (uint8_t *)_audioBuffer, size);
+	if (_audioFileOpened) {
+		_audioFile.write(_audioBuffer, size);
+	}
+	_audioSamplesCount += samples;
+}
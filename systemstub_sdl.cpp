@@ -7,6 +7,7 @@
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif
+#include "blitter.h"
 #include "mixer.h"
 #include "scaler.h"
 #include "screenshot.h"
@@ -33,6 +34,7 @@ struct SystemStub_SDL : SystemStub {
 	SDL_Overlay *_yuv;
 #endif
 	SDL_PixelFormat *_fmt;
+	const Blitter *_blitter;
 	uint32_t *_gameBuffer;
 	uint16_t *_videoBuffer;
 	uint32_t _pal[256];
@@ -52,7 +54,7 @@ struct SystemStub_SDL : SystemStub {
 #else
 		_screen(0), _yuv(0),
 #endif
-		_fmt(0),
+		_fmt(0), _blitter(0),
 		_gameBuffer(0), _videoBuffer(0),
 		_iconData(0), _iconSize(0) {
 		_screenshot = 1;
@@ -81,6 +83,7 @@ struct SystemStub_SDL : SystemStub {
 	virtual uint8_t *lockYUV(int *pitch);
 	virtual void unlockYUV();
 	virtual void processEvents();
+	virtual void waitEvents(int timeout);
 	virtual void sleep(int duration);
 	virtual uint32_t getTimeStamp();
 	virtual void lockAudio();
@@ -92,6 +95,7 @@ struct SystemStub_SDL : SystemStub {
 
 	void updateMousePosition(int x, int y);
 	void handleEvent(const SDL_Event &ev, bool &paused);
+	void pollEvents(bool paused);
 	void setFullscreen(bool fullscreen);
 };
 
@@ -116,6 +120,8 @@ void SystemStub_SDL::init(const char *title, int w, int h, bool fullscreen, int
 	_soundSampleRate = 0;
 	_mixer->open();
 
+	_blitter = getBlitter();
+
 	_widescreen = false;
 	switch (screenMode) {
 	case SCREEN_MODE_DEFAULT: {
@@ -281,9 +287,7 @@ void SystemStub_SDL::fillRect(int x, int y, int w, int h, uint8_t color) {
 	const uint32_t fillColor = _pal[color];
 	uint32_t *p = _gameBuffer + y * _screenW + x;
 	while (h--) {
-		for (int i = 0; i < w; ++i) {
-			p[i] = fillColor;
-		}
+		_blitter->fill32(p, w, fillColor);
 		p += _screenW;
 	}
 }
@@ -295,10 +299,10 @@ void SystemStub_SDL::copyRect(int x, int y, int w, int h, const uint8_t *buf, in
 	buf += h * pitch;
 	while (h--) {
 		buf -= pitch;
-		for (int i = 0; i < w; ++i) {
-			if (!transparent || buf[i] != 0) {
-				p[i] = _pal[buf[i]];
-			}
+		if (transparent) {
+			_blitter->expandPaletteTransparent(p, buf, w, _pal);
+		} else {
+			_blitter->expandPalette(p, buf, w, _pal);
 		}
 		p += _screenW;
 	}
@@ -307,16 +311,11 @@ void SystemStub_SDL::copyRect(int x, int y, int w, int h, const uint8_t *buf, in
 void SystemStub_SDL::darkenRect(int x, int y, int w, int h) {
 	if (!clipRect(_screenW, _screenH, x, y, w, h)) return;
 
-	const uint32_t redBlueMask = _fmt->Rmask | _fmt->Bmask;
-	const uint32_t greenMask = _fmt->Gmask;
+	const uint32_t mask = getDarkenMask(_fmt->Rmask | _fmt->Bmask, _fmt->Gmask);
 
 	uint32_t *p = _gameBuffer + y * _screenW + x;
 	while (h--) {
-		for (int i = 0; i < w; ++i) {
-			uint32_t color = ((p[i] & redBlueMask) >> 1) & redBlueMask;
-			color |= ((p[i] & greenMask) >> 1) & greenMask;
-			p[i] = color;
-		}
+		_blitter->darken32(p, w, mask);
 		p += _screenW;
 	}
 }
@@ -565,7 +564,23 @@ void SystemStub_SDL::unlockYUV() {
 }
 
 void SystemStub_SDL::processEvents() {
+	pollEvents(false);
+}
+
+void SystemStub_SDL::waitEvents(int timeout) {
 	bool paused = false;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	SDL_Event ev;
+	if (SDL_WaitEventTimeout(&ev, timeout)) {
+		handleEvent(ev, paused);
+	}
+#else
+	SDL_Delay(timeout);
+#endif
+	pollEvents(paused);
+}
+
+void SystemStub_SDL::pollEvents(bool paused) {
 	while (!_quit) {
 		SDL_Event ev;
 		while (SDL_PollEvent(&ev)) {
@@ -753,6 +768,9 @@ void SystemStub_SDL::handleEvent(const SDL_Event &ev, bool &paused) {
 		case SDLK_w:
 			setFullscreen(!_fullScreenDisplay);
 			break;
+		case SDLK_p:
+			_pi.dumpProfile = true;
+			break;
 		case SDLK_KP_PLUS:
 		case SDLK_PAGEUP:
 			_pi.stateSlot = 1;
@@ -0,0 +1,294 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifdef BERMUDA_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "thread.h"
+
+#ifdef BERMUDA_PTHREAD
+struct ThreadPool_impl {
+	pthread_t _threads[ThreadPool::kMaxThreads];
+	int _threadsCount;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _jobCond;
+	pthread_cond_t _doneCond;
+	ThreadPool::JobProc _proc;
+	void *_param;
+	int _jobsCount;
+	int _nextJob;
+	int _pendingJobs;
+	int _generation;
+	bool _quit;
+
+	bool nextJob(int *num) {
+		if (_nextJob < _jobsCount) {
+			*num = _nextJob++;
+			return true;
+		}
+		return false;
+	}
+
+	void jobDone() {
+		--_pendingJobs;
+		if (_pendingJobs == 0) {
+			pthread_cond_broadcast(&_doneCond);
+		}
+	}
+
+	static void *threadProc(void *arg) {
+		ThreadPool_impl *impl = (ThreadPool_impl *)arg;
+		int generation = 0;
+		pthread_mutex_lock(&impl->_mutex);
+		while (1) {
+			while (!impl->_quit && impl->_generation == generation) {
+				pthread_cond_wait(&impl->_jobCond, &impl->_mutex);
+			}
+			if (impl->_quit) {
+				break;
+			}
+			generation = impl->_generation;
+			int num;
+			while (impl->nextJob(&num)) {
+				pthread_mutex_unlock(&impl->_mutex);
+				(impl->_proc)(impl->_param, num);
+				pthread_mutex_lock(&impl->_mutex);
+				impl->jobDone();
+			}
+		}
+		pthread_mutex_unlock(&impl->_mutex);
+		return 0;
+	}
+};
+#endif
+
+ThreadPool::ThreadPool()
+	: _threadsCount(1), _impl(0) {
+}
+
+ThreadPool::~ThreadPool() {
+	fini();
+}
+
+void ThreadPool::init(int threadsCount) {
+#ifdef BERMUDA_PTHREAD
+	if (threadsCount <= 0) {
+		threadsCount = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	threadsCount = CLIP(threadsCount, 1, (int)kMaxThreads);
+	_threadsCount = 1;
+	if (threadsCount > 1) {
+		_impl = new ThreadPool_impl;
+		pthread_mutex_init(&_impl->_mutex, 0);
+		pthread_cond_init(&_impl->_jobCond, 0);
+		pthread_cond_init(&_impl->_doneCond, 0);
+		_impl->_proc = 0;
+		_impl->_param = 0;
+		_impl->_jobsCount = _impl->_nextJob = _impl->_pendingJobs = 0;
+		_impl->_generation = 0;
+		_impl->_quit = false;
+		// the calling thread also runs jobs
+		_impl->_threadsCount = 0;
+		for (int i = 0; i < threadsCount - 1; ++i) {
+			if (pthread_create(&_impl->_threads[i], 0, ThreadPool_impl::threadProc, _impl) != 0) {
+				warning("Unable to create worker thread %d", i);
+				break;
+			}
+			++_impl->_threadsCount;
+		}
+		_threadsCount = _impl->_threadsCount + 1;
+	}
+#else
+	_threadsCount = 1;
+#endif
+	debug(DBG_INFO, "ThreadPool::init() %d threads", _threadsCount);
+}
+
+void ThreadPool::fini() {
+#ifdef BERMUDA_PTHREAD
+	if (_impl) {
+		pthread_mutex_lock(&_impl->_mutex);
+		_impl->_quit = true;
+		pthread_cond_broadcast(&_impl->_jobCond);
+		pthread_mutex_unlock(&_impl->_mutex);
+		for (int i = 0; i < _impl->_threadsCount; ++i) {
+			pthread_join(_impl->_threads[i], 0);
+		}
+		pthread_cond_destroy(&_impl->_doneCond);
+		pthread_cond_destroy(&_impl->_jobCond);
+		pthread_mutex_destroy(&_impl->_mutex);
+		delete _impl;
+		_impl = 0;
+	}
+#endif
+	_threadsCount = 1;
+}
+
+void ThreadPool::run(JobProc proc, void *param, int count) {
+#ifdef BERMUDA_PTHREAD
+	if (_impl && count > 1) {
+		pthread_mutex_lock(&_impl->_mutex);
+		_impl->_proc = proc;
+		_impl->_param = param;
+		_impl->_jobsCount = _impl->_pendingJobs = count;
+		_impl->_nextJob = 0;
+		++_impl->_generation;
+		pthread_cond_broadcast(&_impl->_jobCond);
+		int num;
+		while (_impl->nextJob(&num)) {
+			pthread_mutex_unlock(&_impl->_mutex);
+			proc(param, num);
+			pthread_mutex_lock(&_impl->_mutex);
+			_impl->jobDone();
+		}
+		while (_impl->_pendingJobs != 0) {
+			pthread_cond_wait(&_impl->_doneCond, &_impl->_mutex);
+		}
+		pthread_mutex_unlock(&_impl->_mutex);
+		return;
+	}
+#endif
+	for (int i = 0; i < count; ++i) {
+		proc(param, i);
+	}
+}
+
+#ifdef BERMUDA_PTHREAD
+struct Mutex_impl {
+	pthread_mutex_t _mutex;
+};
+#endif
+
+Mutex::Mutex()
+	: _impl(0) {
+#ifdef BERMUDA_PTHREAD
+	_impl = new Mutex_impl;
+	pthread_mutex_init(&_impl->_mutex, 0);
+#endif
+}
+
+Mutex::~Mutex() {
+#ifdef BERMUDA_PTHREAD
+	pthread_mutex_destroy(&_impl->_mutex);
+	delete _impl;
+#endif
+}
+
+void Mutex::lock() {
+#ifdef BERMUDA_PTHREAD
+	pthread_mutex_lock(&_impl->_mutex);
+#endif
+}
+
+void Mutex::unlock() {
+#ifdef BERMUDA_PTHREAD
+	pthread_mutex_unlock(&_impl->_mutex);
+#endif
+}
+
+#ifdef BERMUDA_PTHREAD
+struct BackgroundThread_impl {
+	struct Job {
+		BackgroundThread::JobProc proc;
+		void *param;
+	};
+
+	pthread_t _thread;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _jobCond;
+	Job _jobsTable[BackgroundThread::kMaxJobs];
+	int _jobsHead, _jobsCount;
+	bool _quit;
+
+	static void *threadProc(void *arg) {
+		BackgroundThread_impl *impl = (BackgroundThread_impl *)arg;
+		pthread_mutex_lock(&impl->_mutex);
+		while (1) {
+			while (!impl->_quit && impl->_jobsCount == 0) {
+				pthread_cond_wait(&impl->_jobCond, &impl->_mutex);
+			}
+			if (impl->_quit) {
+				break;
+			}
+			const Job job = impl->_jobsTable[impl->_jobsHead];
+			impl->_jobsHead = (impl->_jobsHead + 1) % BackgroundThread::kMaxJobs;
+			--impl->_jobsCount;
+			pthread_mutex_unlock(&impl->_mutex);
+			(job.proc)(job.param);
+			free(job.param);
+			pthread_mutex_lock(&impl->_mutex);
+		}
+		pthread_mutex_unlock(&impl->_mutex);
+		return 0;
+	}
+};
+#endif
+
+BackgroundThread::BackgroundThread()
+	: _impl(0) {
+}
+
+BackgroundThread::~BackgroundThread() {
+	fini();
+}
+
+void BackgroundThread::init() {
+#ifdef BERMUDA_PTHREAD
+	_impl = new BackgroundThread_impl;
+	pthread_mutex_init(&_impl->_mutex, 0);
+	pthread_cond_init(&_impl->_jobCond, 0);
+	_impl->_jobsHead = _impl->_jobsCount = 0;
+	_impl->_quit = false;
+	if (pthread_create(&_impl->_thread, 0, BackgroundThread_impl::threadProc, _impl) != 0) {
+		warning("Unable to create background thread");
+		pthread_cond_destroy(&_impl->_jobCond);
+		pthread_mutex_destroy(&_impl->_mutex);
+		delete _impl;
+		_impl = 0;
+	}
+#endif
+}
+
+void BackgroundThread::fini() {
+#ifdef BERMUDA_PTHREAD
+	if (_impl) {
+		pthread_mutex_lock(&_impl->_mutex);
+		_impl->_quit = true;
+		pthread_cond_signal(&_impl->_jobCond);
+		pthread_mutex_unlock(&_impl->_mutex);
+		pthread_join(_impl->_thread, 0);
+		for (; _impl->_jobsCount != 0; --_impl->_jobsCount) {
+			free(_impl->_jobsTable[_impl->_jobsHead].param);
+			_impl->_jobsHead = (_impl->_jobsHead + 1) % kMaxJobs;
+		}
+		pthread_cond_destroy(&_impl->_jobCond);
+		pthread_mutex_destroy(&_impl->_mutex);
+		delete _impl;
+		_impl = 0;
+	}
+#endif
+}
+
+void BackgroundThread::post(JobProc proc, void *param) {
+#ifdef BERMUDA_PTHREAD
+	if (_impl) {
+		pthread_mutex_lock(&_impl->_mutex);
+		if (_impl->_jobsCount < kMaxJobs) {
+			const int i = (_impl->_jobsHead + _impl->_jobsCount) % kMaxJobs;
+			_impl->_jobsTable[i].proc = proc;
+			_impl->_jobsTable[i].param = param;
+			++_impl->_jobsCount;
+			pthread_cond_signal(&_impl->_jobCond);
+			pthread_mutex_unlock(&_impl->_mutex);
+			return;
+		}
+		pthread_mutex_unlock(&_impl->_mutex);
+		warning("BackgroundThread::post() queue is full");
+	}
+#endif
+	proc(param);
+	free(param);
+}
@@ -0,0 +1,137 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#ifndef THREAD_H__
+#define THREAD_H__
+
+#include "intern.h"
+
+struct ThreadPool_impl;
+
+struct ThreadPool {
+	typedef void (*JobProc)(void *param, int num);
+
+	enum {
+		kMaxThreads = 8
+	};
+
+	ThreadPool();
+	~ThreadPool();
+
+	void init(int threadsCount = 0);
+	void fini();
+	// calls proc(param, num) for num in [0, count), returns once all jobs are done
+	void run(JobProc proc, void *param, int count);
+
+	int _threadsCount;
+	ThreadPool_impl *_impl;
+};
+
+struct Mutex_impl;
+
+struct Mutex {
+	Mutex();
+	~Mutex();
+
+	void lock();
+	void unlock();
+
+	Mutex_impl *_impl;
+};
+
+struct MutexLock {
+	MutexLock(Mutex &m) : _m(m) {
+		_m.lock();
+	}
+	~MutexLock() {
+		_m.unlock();
+	}
+	Mutex &_m;
+};
+
+// acquire and release accesses to the fields shared by two threads without a lock
+static inline int atomicLoad(const int *p) {
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void atomicStore(int *p, int value) {
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+static inline bool atomicCompareAndSwap(int *p, int expected, int value) {
+	return __atomic_compare_exchange_n(p, &expected, value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// statistics counters incremented from several threads, not ordered with the other accesses
+static inline void atomicAdd(int *p, int value) {
+	__atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+
+static inline void atomicAdd(uint32_t *p, uint32_t value) {
+	__atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t atomicLoad(const uint32_t *p) {
+	return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+// ring buffer with a single producer and a single consumer thread, push and pop never wait
+template <typename T, int N>
+struct SpscQueue {
+	SpscQueue()
+		: _head(0), _tail(0) {
+	}
+
+	// returns false if the queue is full
+	bool push(const T &item) {
+		const int tail = _tail;
+		const int next = (tail + 1) % N;
+		if (next == atomicLoad(&_head)) {
+			return false;
+		}
+		_items[tail] = item;
+		atomicStore(&_tail, next);
+		return true;
+	}
+
+	// returns false if the queue is empty
+	bool pop(T *item) {
+		const int head = _head;
+		if (head == atomicLoad(&_tail)) {
+			return false;
+		}
+		*item = _items[head];
+		atomicStore(&_head, (head + 1) % N);
+		return true;
+	}
+
+	T _items[N];
+	int _head; // written by the consumer
+	int _tail; // written by the producer
+};
+
+struct BackgroundThread_impl;
+
+// runs the posted jobs one after the other on a separate thread
+struct BackgroundThread {
+	typedef void (*JobProc)(void *param);
+
+	enum {
+		kMaxJobs = 16
+	};
+
+	BackgroundThread();
+	~BackgroundThread();
+
+	void init();
+	// waits for the running job, the pending ones are discarded with their param freed
+	void fini();
+	// param is malloc'ed and freed once the job is done, the job runs on the calling thread if there is no background thread
+	void post(JobProc proc, void *param);
+
+	BackgroundThread_impl *_impl;
+};
+
+#endif // THREAD_H__
@@ -0,0 +1,452 @@
+
+#include <sys/time.h>
+#include "../blitter.h"
+#include "../file.h"
+#include "../mixer.h"
+#include "../systemstub.h"
+
+enum {
+	kW = 640,
+	kH = 480,
+	kIterations = 500,
+	kClipSamples = 4096,
+	kClipChecks = 20000,
+	kGuardSize = 64,
+	kMixerRate = 22050,
+	kMixerCallbackSamples = 1024, // stereo samples per audio callback
+	kMixerCallbacks = 200,
+	kMixerRounds = 10,
+	kSoundDuration = 10 // seconds, longer than the callbacks of a round
+};
+
+static uint8_t _indexedBuffer[kW * kH];
+static uint32_t _screenBuffer[kW * kH];
+static uint32_t _referenceBuffer[kW * kH];
+static uint32_t _palette[256];
+
+static int32_t _mixBuffer[kClipSamples];
+static int16_t _clipReference[kClipSamples + kGuardSize];
+static int16_t _clipBuffer[kClipSamples + kGuardSize];
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+static uint32_t getTimeUs() {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// loops as found in SystemStub_SDL before the blitter kernels
+
+static void copyRect_loop(uint32_t *dst, const uint8_t *buf, bool transparent) {
+	buf += kH * kW;
+	for (int h = kH; h--; ) {
+		buf -= kW;
+		for (int i = 0; i < kW; ++i) {
+			if (!transparent || buf[i] != 0) {
+				dst[i] = _palette[buf[i]];
+			}
+		}
+		dst += kW;
+	}
+}
+
+static void fillRect_loop(uint32_t *dst, uint32_t color) {
+	for (int h = kH; h--; ) {
+		for (int i = 0; i < kW; ++i) {
+			dst[i] = color;
+		}
+		dst += kW;
+	}
+}
+
+static void darkenRect_loop(uint32_t *dst) {
+	const uint32_t redBlueMask = 0xFF00FF;
+	const uint32_t greenMask = 0xFF00;
+	for (int h = kH; h--; ) {
+		for (int i = 0; i < kW; ++i) {
+			uint32_t color = ((dst[i] & redBlueMask) >> 1) & redBlueMask;
+			color |= ((dst[i] & greenMask) >> 1) & greenMask;
+			dst[i] = color;
+		}
+		dst += kW;
+	}
+}
+
+static void copyRect_blitter(const Blitter *b, uint32_t *dst, const uint8_t *buf, bool transparent) {
+	buf += kH * kW;
+	for (int h = kH; h--; ) {
+		buf -= kW;
+		if (transparent) {
+			b->expandPaletteTransparent(dst, buf, kW, _palette);
+		} else {
+			b->expandPalette(dst, buf, kW, _palette);
+		}
+		dst += kW;
+	}
+}
+
+static void fillRect_blitter(const Blitter *b, uint32_t *dst, uint32_t color) {
+	for (int h = kH; h--; ) {
+		b->fill32(dst, kW, color);
+		dst += kW;
+	}
+}
+
+static void darkenRect_blitter(const Blitter *b, uint32_t *dst) {
+	const uint32_t mask = getDarkenMask(0xFF00FF, 0xFF00);
+	for (int h = kH; h--; ) {
+		b->darken32(dst, kW, mask);
+		dst += kW;
+	}
+}
+
+static void clipS16_loop(int16_t *dst, const int32_t *src, int count) {
+	for (int i = 0; i < count; ++i) {
+		dst[i] = (int16_t)CLIP(src[i], -32768, 32767);
+	}
+}
+
+static void resetScreen(uint32_t *dst) {
+	for (int i = 0; i < kW * kH; ++i) {
+		dst[i] = i * 2654435761u;
+	}
+}
+
+static void report(const char *name, const char *impl, uint32_t t, int count, const char *unit, bool match) {
+	printf("%-24s %-8s %8.1f us/%s %s\n", name, impl, t / (float)count, unit, match ? "" : "MISMATCH");
+}
+
+static void bench(const char *name, const Blitter *b, int test) {
+	resetScreen(_referenceBuffer);
+	resetScreen(_screenBuffer);
+	uint32_t t0 = getTimeUs();
+	for (int n = 0; n < kIterations; ++n) {
+		switch (test) {
+		case 0: copyRect_loop(_referenceBuffer, _indexedBuffer, false); break;
+		case 1: copyRect_loop(_referenceBuffer, _indexedBuffer, true); break;
+		case 2: fillRect_loop(_referenceBuffer, _palette[n & 255]); break;
+		case 3: darkenRect_loop(_referenceBuffer); break;
+		}
+	}
+	const uint32_t loopTime = getTimeUs() - t0;
+	t0 = getTimeUs();
+	for (int n = 0; n < kIterations; ++n) {
+		switch (test) {
+		case 0: copyRect_blitter(b, _screenBuffer, _indexedBuffer, false); break;
+		case 1: copyRect_blitter(b, _screenBuffer, _indexedBuffer, true); break;
+		case 2: fillRect_blitter(b, _screenBuffer, _palette[n & 255]); break;
+		case 3: darkenRect_blitter(b, _screenBuffer); break;
+		}
+	}
+	const uint32_t blitterTime = getTimeUs() - t0;
+	const bool match = memcmp(_referenceBuffer, _screenBuffer, sizeof(_screenBuffer)) == 0;
+	report(name, "loop", loopTime, kIterations, "frame", true);
+	report(name, b->name, blitterTime, kIterations, "frame", match);
+}
+
+// mix sums of several channels, beyond the 16 bits range and up to the int32 limits
+static int32_t generateMixSample() {
+	switch (getRandomNumber(8)) {
+	case 0: {
+			static const int32_t values[] = { -32769, -32768, -32767, -1, 0, 32766, 32767, 32768, (int32_t)0x80000000, 0x7FFFFFFF };
+			return values[getRandomNumber(ARRAYSIZE(values))];
+		}
+	case 1:
+		return (int32_t)((getRandomNumber(0x10000) << 16) | getRandomNumber(0x10000));
+	default:
+		return getRandomNumber(4 * 65536) - 2 * 65536;
+	}
+}
+
+// compares the kernel with the scalar version on random counts and alignments, the samples past count are left untouched
+static bool checkClipS16(const Blitter *b, const Blitter *reference) {
+	for (int n = 0; n < kClipChecks; ++n) {
+		const int offset = getRandomNumber(16);
+		const int count = getRandomNumber(kClipSamples - offset + 1);
+		for (int i = 0; i < count; ++i) {
+			_mixBuffer[offset + i] = generateMixSample();
+		}
+		memset(_clipReference, 0x55, sizeof(_clipReference));
+		memset(_clipBuffer, 0x55, sizeof(_clipBuffer));
+		reference->clipS16(_clipReference + offset, _mixBuffer + offset, count);
+		b->clipS16(_clipBuffer + offset, _mixBuffer + offset, count);
+		if (memcmp(_clipReference, _clipBuffer, sizeof(_clipBuffer)) != 0) {
+			printf("clipS16 %s offset %d count %d MISMATCH\n", b->name, offset, count);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void benchClipS16(const Blitter *b, const Blitter *reference) {
+	const bool match = checkClipS16(b, reference);
+	for (int i = 0; i < kClipSamples; ++i) {
+		_mixBuffer[i] = generateMixSample();
+	}
+	uint32_t t0 = getTimeUs();
+	for (int n = 0; n < kIterations; ++n) {
+		clipS16_loop(_clipReference, _mixBuffer, kClipSamples);
+	}
+	const uint32_t loopTime = getTimeUs() - t0;
+	t0 = getTimeUs();
+	for (int n = 0; n < kIterations; ++n) {
+		b->clipS16(_clipBuffer, _mixBuffer, kClipSamples);
+	}
+	const uint32_t blitterTime = getTimeUs() - t0;
+	report("clipS16", "loop", loopTime, kIterations, "block", true);
+	report("clipS16", b->name, blitterTime, kIterations, "block", match);
+}
+
+// keeps the audio callback set by the mixer, called directly by the benchmark
+struct AudioStub : SystemStub {
+	AudioCallback _callback;
+	void *_param;
+
+	AudioStub() : _callback(0), _param(0) {}
+
+	virtual void init(const char *title, int w, int h, bool fullscreen, int screenMode) {}
+	virtual void destroy() {}
+	virtual void setIcon(const uint8_t *data, int size) {}
+	virtual void showCursor(bool show) {}
+	virtual void setPalette(const uint8_t *pal, int n) {}
+	virtual void fillRect(int x, int y, int w, int h, uint8_t color) {}
+	virtual void copyRect(int x, int y, int w, int h, const uint8_t *buf, int pitch, bool transparent) {}
+	virtual void darkenRect(int x, int y, int w, int h) {}
+	virtual void copyRectWidescreen(int w, int h, const uint8_t *buf, int pitch) {}
+	virtual void clearWidescreen() {}
+	virtual void updateScreen() {}
+	virtual void setYUV(bool flag, int w, int h) {}
+	virtual uint8_t *lockYUV(int *pitch) { return 0; }
+	virtual void unlockYUV() {}
+	virtual void processEvents() {}
+	virtual void waitEvents(int timeout) {}
+	virtual void sleep(int duration) {}
+	virtual uint32_t getTimeStamp() { return 0; }
+	virtual void lockAudio() {}
+	virtual void unlockAudio() {}
+	virtual void startAudio(AudioCallback callback, void *param) {
+		_callback = callback;
+		_param = param;
+	}
+	virtual void stopAudio() {
+		_callback = 0;
+	}
+	virtual int getOutputSampleRate() { return kMixerRate; }
+	virtual Mixer *getMixer() { return 0; }
+};
+
+struct WavSound {
+	int sampleRate;
+	int bitsPerSample;
+	int channels;
+	uint8_t *file;
+	uint32_t fileSize;
+	const uint8_t *data;
+	uint32_t dataSize;
+};
+
+static WavSound _wavSounds[] = {
+	{ 11025, 8, 1 },
+	{ 22050, 16, 1 },
+	{ 22050, 16, 2 },
+	{ 44100, 8, 2 }
+};
+
+static void writeUint16LE(uint8_t *p, uint16_t n) {
+	p[0] = n & 255;
+	p[1] = n >> 8;
+}
+
+static void writeUint32LE(uint8_t *p, uint32_t n) {
+	writeUint16LE(p, n & 0xFFFF);
+	writeUint16LE(p + 2, n >> 16);
+}
+
+// the 4 channels sum to less than 32768, the mixers do not clip
+static void generateWav(WavSound *ws) {
+	const int blockAlign = ws->channels * ws->bitsPerSample / 8;
+	ws->dataSize = ws->sampleRate * kSoundDuration * blockAlign;
+	ws->fileSize = 44 + ws->dataSize;
+	ws->file = (uint8_t *)malloc(ws->fileSize);
+	uint8_t *p = ws->file;
+	memcpy(p, "RIFF", 4);
+	writeUint32LE(p + 4, ws->fileSize - 8);
+	memcpy(p + 8, "WAVEfmt ", 8);
+	writeUint32LE(p + 16, 16);
+	writeUint16LE(p + 20, 1);
+	writeUint16LE(p + 22, ws->channels);
+	writeUint32LE(p + 24, ws->sampleRate);
+	writeUint32LE(p + 28, ws->sampleRate * blockAlign);
+	writeUint16LE(p + 32, blockAlign);
+	writeUint16LE(p + 34, ws->bitsPerSample);
+	memcpy(p + 36, "data", 4);
+	writeUint32LE(p + 40, ws->dataSize);
+	ws->data = p + 44;
+	uint8_t *data = p + 44;
+	if (ws->bitsPerSample == 8) {
+		for (uint32_t i = 0; i < ws->dataSize; ++i) {
+			data[i] = 128 - 30 + getRandomNumber(61);
+		}
+	} else {
+		for (uint32_t i = 0; i < ws->dataSize; i += 2) {
+			writeUint16LE(data + i, getRandomNumber(2 * 7000 + 1) - 7000);
+		}
+	}
+}
+
+// wav channel as found in MixerSoftware before the block mixing, clamped after each sample of each channel
+struct PerSampleWavChannel {
+	const WavSound *_ws;
+	uint32_t _bufReadOffset;
+	uint32_t _bufReadStep;
+
+	void reset(const WavSound *ws) {
+		_ws = ws;
+		_bufReadOffset = 0;
+		_bufReadStep = (ws->sampleRate << 8) / kMixerRate;
+	}
+
+	static void mixSample(int16_t &dst, int sample, int volume) {
+		int pcm = dst + ((sample * volume) >> 8);
+		if (pcm < -32768) {
+			pcm = -32768;
+		} else if (pcm > 32767) {
+			pcm = 32767;
+		}
+		dst = (int16_t)pcm;
+	}
+
+	bool readSample(int16_t &sample) {
+		switch (_ws->bitsPerSample) {
+		case 8:
+			if ((_bufReadOffset >> 8) >= _ws->dataSize) {
+				return false;
+			}
+			sample = (_ws->data[_bufReadOffset >> 8] << 8) ^ 0x8000;
+			break;
+		case 16:
+			if ((_bufReadOffset >> 8) * 2 >= _ws->dataSize) {
+				return false;
+			}
+			sample = READ_LE_UINT16(&_ws->data[(_bufReadOffset >> 8) * 2]);
+			break;
+		}
+		_bufReadOffset += _bufReadStep;
+		return true;
+	}
+
+	int read(int16_t *dst, int samples) {
+		for (int i = 0; i < samples; ++i) {
+			int16_t sampleL = 0, sampleR;
+			if (!readSample(sampleL)) {
+				return i;
+			}
+			sampleR = sampleL;
+			if (_ws->channels == 2 && !readSample(sampleR)) {
+				return i;
+			}
+			mixSample(*dst++, sampleL, 256);
+			mixSample(*dst++, sampleR, 256);
+		}
+		return samples;
+	}
+};
+
+static int16_t _perSampleMixBuffer[kMixerCallbackSamples * 2];
+static int16_t _blockMixBuffer[kMixerCallbackSamples * 2];
+
+static void mixPerSample(PerSampleWavChannel *channels, int channelsCount) {
+	memset(_perSampleMixBuffer, 0, sizeof(_perSampleMixBuffer));
+	for (int i = 0; i < channelsCount; ++i) {
+		channels[i].read(_perSampleMixBuffer, kMixerCallbackSamples);
+	}
+}
+
+static Mixer *startBlockMixer(AudioStub *stub) {
+	Mixer *mixer = Mixer_Software_create(stub);
+	mixer->open();
+	for (int i = 0; i < (int)ARRAYSIZE(_wavSounds); ++i) {
+		File f((const uint8_t *)_wavSounds[i].file, _wavSounds[i].fileSize);
+		int id;
+		mixer->playSound(&f, &id);
+	}
+	return mixer;
+}
+
+// times the audio callback of MixerSoftware against the per sample mixing it replaced, with 4 wav channels playing
+static void benchMixer() {
+	for (int i = 0; i < (int)ARRAYSIZE(_wavSounds); ++i) {
+		generateWav(&_wavSounds[i]);
+	}
+	const int channelsCount = ARRAYSIZE(_wavSounds);
+	PerSampleWavChannel channels[ARRAYSIZE(_wavSounds)];
+	AudioStub stub;
+	bool match = true;
+	uint32_t perSampleTime = 0;
+	uint32_t blockTime = 0;
+	for (int n = 0; n < kMixerRounds; ++n) {
+		for (int i = 0; i < channelsCount; ++i) {
+			channels[i].reset(&_wavSounds[i]);
+		}
+		uint32_t t0 = getTimeUs();
+		for (int i = 0; i < kMixerCallbacks; ++i) {
+			mixPerSample(channels, channelsCount);
+		}
+		perSampleTime += getTimeUs() - t0;
+
+		Mixer *mixer = startBlockMixer(&stub);
+		t0 = getTimeUs();
+		for (int i = 0; i < kMixerCallbacks; ++i) {
+			stub._callback(stub._param, (uint8_t *)_blockMixBuffer, sizeof(_blockMixBuffer));
+		}
+		blockTime += getTimeUs() - t0;
+		delete mixer;
+	}
+	// compare the outputs on a last round, callback by callback
+	for (int i = 0; i < channelsCount; ++i) {
+		channels[i].reset(&_wavSounds[i]);
+	}
+	Mixer *mixer = startBlockMixer(&stub);
+	for (int i = 0; i < kMixerCallbacks && match; ++i) {
+		mixPerSample(channels, channelsCount);
+		stub._callback(stub._param, (uint8_t *)_blockMixBuffer, sizeof(_blockMixBuffer));
+		match = memcmp(_perSampleMixBuffer, _blockMixBuffer, sizeof(_blockMixBuffer)) == 0;
+	}
+	delete mixer;
+	for (int i = 0; i < channelsCount; ++i) {
+		free(_wavSounds[i].file);
+	}
+	report("mix (4 wav channels)", "sample", perSampleTime, kMixerRounds * kMixerCallbacks, "callback", true);
+	report("mix (4 wav channels)", "block", blockTime, kMixerRounds * kMixerCallbacks, "callback", match);
+}
+
+int main(int argc, char *argv[]) {
+	for (int i = 0; i < 256; ++i) {
+		_palette[i] = (i * 0x10101) ^ 0x5A3C96;
+	}
+	// sprite like content, runs of transparent pixels
+	for (int i = 0; i < kW * kH; ++i) {
+		_indexedBuffer[i] = ((i / 37) & 1) ? 0 : (i * 7) & 255;
+	}
+	static const char *names[] = { "scalar", "sse2", "avx2", 0 };
+	for (int i = 0; names[i]; ++i) {
+		const Blitter *b = findBlitter(names[i]);
+		if (!b) {
+			printf("'%s' not supported\n", names[i]);
+			continue;
+		}
+		bench("copyRect", b, 0);
+		bench("copyRect (transparent)", b, 1);
+		bench("fillRect", b, 2);
+		bench("darkenRect", b, 3);
+		benchClipS16(b, findBlitter("scalar"));
+	}
+	benchMixer();
+	return 0;
+}
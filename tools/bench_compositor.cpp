@@ -0,0 +1,209 @@
+#include <sys/time.h>
+#include "../blitter.h"
+#include "../compositor.h"
+#include "../systemstub.h"
+#include "../thread.h"
+
+enum {
+	kW = 640,
+	kH = 480,
+	kSpritesCount = 96,
+	kIterations = 200
+};
+
+// only expands the game buffer, as SystemStub_SDL does
+struct BenchStub : SystemStub {
+	const Blitter *_blitter;
+	uint32_t _palette[256];
+	uint32_t _screenBuffer[kW * kH];
+
+	BenchStub() : _blitter(getBlitter()) {}
+
+	virtual void init(const char *title, int w, int h, bool fullscreen, int screenMode) {}
+	virtual void destroy() {}
+	virtual void setIcon(const uint8_t *data, int size) {}
+	virtual void showCursor(bool show) {}
+	virtual void setPalette(const uint8_t *pal, int n) {}
+	virtual void fillRect(int x, int y, int w, int h, uint8_t color) {}
+	virtual void copyRect(int x, int y, int w, int h, const uint8_t *buf, int pitch, bool transparent) {
+		uint32_t *p = _screenBuffer + y * kW + x;
+		buf += h * pitch;
+		while (h--) {
+			buf -= pitch;
+			_blitter->expandPalette(p, buf, w, _palette);
+			p += kW;
+		}
+	}
+	virtual void darkenRect(int x, int y, int w, int h) {}
+	virtual void copyRectWidescreen(int w, int h, const uint8_t *buf, int pitch) {}
+	virtual void clearWidescreen() {}
+	virtual void updateScreen() {}
+	virtual void setYUV(bool flag, int w, int h) {}
+	virtual uint8_t *lockYUV(int *pitch) { return 0; }
+	virtual void unlockYUV() {}
+	virtual void processEvents() {}
+	virtual void waitEvents(int timeout) {}
+	virtual void sleep(int duration) {}
+	virtual uint32_t getTimeStamp() { return 0; }
+	virtual void lockAudio() {}
+	virtual void unlockAudio() {}
+	virtual void startAudio(AudioCallback callback, void *param) {}
+	virtual void stopAudio() {}
+	virtual int getOutputSampleRate() { return 22050; }
+	virtual Mixer *getMixer() { return 0; }
+};
+
+struct Sprite {
+	int x, y;
+	uint8_t *data;
+	uint16_t *spans;
+	bool flip;
+	int depthLevel;
+};
+
+static uint8_t _backgroundBuffer[kW * kH];
+static uint8_t _gameBuffer[kW * kH];
+static uint8_t _referenceGameBuffer[kW * kH];
+static uint32_t _referenceScreenBuffer[kW * kH];
+static uint8_t _depthMask[kW * kH];
+static Sprite _spritesTable[kSpritesCount];
+static BenchStub _stub;
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+static uint32_t getTimeUs() {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// same layout as the spans built by Game::decodeSceneObjectFrame
+static uint16_t *encodeSpans(const uint8_t *data) {
+	const int w = READ_LE_UINT16(data) + 1;
+	const int h = READ_LE_UINT16(data + 2) + 1;
+	const uint8_t *src = data + 4;
+	uint16_t *spans = (uint16_t *)malloc((h + w * h) * sizeof(uint16_t));
+	int size = 0;
+	for (int j = 0; j < h; ++j) {
+		const int countOffset = size++;
+		int count = 0;
+		for (int i = 0; i < w; ) {
+			if (src[i] == 0) {
+				++i;
+				continue;
+			}
+			const int start = i;
+			while (i < w && src[i] != 0) {
+				++i;
+			}
+			spans[size] = start;
+			spans[size + 1] = i - start;
+			size += 2;
+			++count;
+		}
+		spans[countOffset] = count;
+		src += w;
+	}
+	return spans;
+}
+
+static void initScene() {
+	for (int i = 0; i < kW * kH; ++i) {
+		_backgroundBuffer[i] = (i * 7) & 255;
+	}
+	// a few foreground boxes
+	memset(_depthMask, 255, sizeof(_depthMask));
+	for (int n = 0; n < 6; ++n) {
+		const int x = getRandomNumber(kW - 100);
+		const int y = getRandomNumber(kH - 100);
+		const int w = 40 + getRandomNumber(60);
+		const int h = 40 + getRandomNumber(60);
+		for (int j = 0; j < h; ++j) {
+			memset(_depthMask + (y + j) * kW + x, n & 3, w);
+		}
+	}
+	for (int n = 0; n < kSpritesCount; ++n) {
+		Sprite *spr = &_spritesTable[n];
+		const int w = 16 + getRandomNumber(144);
+		const int h = 16 + getRandomNumber(144);
+		spr->data = (uint8_t *)malloc(4 + w * h);
+		spr->data[0] = (w - 1) & 255;
+		spr->data[1] = (w - 1) >> 8;
+		spr->data[2] = (h - 1) & 255;
+		spr->data[3] = (h - 1) >> 8;
+		for (int i = 0; i < w * h; ++i) {
+			// sprite like content, runs of transparent pixels
+			spr->data[4 + i] = (((i % w) / 11 + i / w / 9) & 1) ? 0 : 1 + (i + n) % 255;
+		}
+		spr->x = getRandomNumber(kW + w) - w;
+		spr->y = getRandomNumber(kH + h) - h;
+		spr->spans = (n & 1) ? encodeSpans(spr->data) : 0;
+		spr->flip = (n & 2) != 0;
+		spr->depthLevel = getRandomNumber(5);
+	}
+	for (int i = 0; i < 256; ++i) {
+		_stub._palette[i] = (i * 0x10101) ^ 0x5A3C96;
+	}
+}
+
+static void drawFrame(Compositor *c, SceneBitmap *dst, const SceneBitmap *background, bool restore) {
+	c->beginSprites(dst, _depthMask);
+	for (int n = 0; n < kSpritesCount; ++n) {
+		const Sprite *spr = &_spritesTable[n];
+		c->addSprite(spr->x, spr->y, spr->data, spr->spans, spr->flip, spr->depthLevel);
+	}
+	c->flushSprites();
+	Rect r;
+	r.x = r.y = 0;
+	r.w = kW;
+	r.h = kH;
+	c->updateRects(&_stub, dst, background, &r, 1, &r, restore ? 1 : 0);
+}
+
+static void bench(int bandsCount, uint32_t *singleTime) {
+	ThreadPool threadPool;
+	threadPool.init(bandsCount);
+	Compositor c;
+	c.init(&threadPool, bandsCount);
+	SceneBitmap background = { kW - 1, kH - 1, kW, _backgroundBuffer };
+	SceneBitmap dst = { kW - 1, kH - 1, kW, _gameBuffer };
+	memcpy(_gameBuffer, _backgroundBuffer, sizeof(_gameBuffer));
+
+	// compare the sprites layer and the expanded screen, before the background is restored
+	drawFrame(&c, &dst, &background, false);
+	if (bandsCount == 1) {
+		memcpy(_referenceGameBuffer, _gameBuffer, sizeof(_gameBuffer));
+		memcpy(_referenceScreenBuffer, _stub._screenBuffer, sizeof(_referenceScreenBuffer));
+	}
+	const bool match = memcmp(_referenceGameBuffer, _gameBuffer, sizeof(_gameBuffer)) == 0 && memcmp(_referenceScreenBuffer, _stub._screenBuffer, sizeof(_referenceScreenBuffer)) == 0;
+	memcpy(_gameBuffer, _backgroundBuffer, sizeof(_gameBuffer));
+
+	const uint32_t t0 = getTimeUs();
+	for (int n = 0; n < kIterations; ++n) {
+		drawFrame(&c, &dst, &background, true);
+	}
+	const uint32_t t = getTimeUs() - t0;
+	if (bandsCount == 1) {
+		*singleTime = t;
+	}
+	printf("%d bands (%d threads) %8.1f us/frame x%.2f %s\n", c._bandsCount, threadPool._threadsCount, t / (float)kIterations, t ? *singleTime / (float)t : 0.f, match ? "" : "MISMATCH");
+	threadPool.fini();
+}
+
+int main(int argc, char *argv[]) {
+	initScene();
+	uint32_t singleTime = 0;
+	for (int bandsCount = 1; bandsCount <= Compositor::kMaxBands; bandsCount *= 2) {
+		bench(bandsCount, &singleTime);
+	}
+	for (int n = 0; n < kSpritesCount; ++n) {
+		free(_spritesTable[n].data);
+		free(_spritesTable[n].spans);
+	}
+	return 0;
+}
@@ -0,0 +1,255 @@
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "../file.h"
+#include "../game.h"
+#include "../systemstub.h"
+
+// switches between two generated scenes and counts the file reads with the
+// read ahead buffer and with the stdio buffering only
+
+enum {
+	kMoviesCount = 8,
+	kMotionsCount = 10,
+	kFramesPerMotion = 8,
+	kObjectsCount = 6,
+	kBoxesCount = 4,
+	kStatementsCount = 256,
+	kSwitchesCount = 20
+};
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+static int getRandomRange(int min, int max) {
+	return min + getRandomNumber(max - min + 1);
+}
+
+static void writeUint32LE(uint8_t *p, uint32_t n) {
+	p[0] = n & 255;
+	p[1] = (n >> 8) & 255;
+	p[2] = (n >> 16) & 255;
+	p[3] = n >> 24;
+}
+
+static uint32_t getTimeUs() {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// read system calls made by the process, 0 if not available
+static uint32_t getReadSyscallsCount() {
+	uint32_t count = 0;
+	FILE *fp = fopen("/proc/self/io", "r");
+	if (fp) {
+		char buf[64];
+		while (fgets(buf, sizeof(buf), fp)) {
+			if (sscanf(buf, "syscr: %u", &count) == 1) {
+				break;
+			}
+		}
+		fclose(fp);
+	}
+	return count;
+}
+
+static char _dataPath[64];
+
+static void writeFile(const char *name, File *f) {
+	char path[128];
+	snprintf(path, sizeof(path), "%s/%s", _dataPath, name);
+	char *sep = strrchr(path, '/');
+	*sep = 0;
+	mkdir(path, 0755);
+	*sep = '/';
+	if (!f->open(path, "wb")) {
+		error("Unable to create '%s'", path);
+	}
+}
+
+static void writeString(File *f, const char *s) {
+	const int len = strlen(s) + 1;
+	f->writeUint16LE(len);
+	f->write((void *)s, len);
+}
+
+static void generateSprites(const char *name) {
+	File f;
+	writeFile(name, &f);
+	f.writeUint16LE(0x3553);
+	static uint8_t frameData[4096];
+	for (int i = 0; i < kMotionsCount; ++i) {
+		f.writeUint16LE(kFramesPerMotion);
+		for (int j = 0; j < kFramesPerMotion; ++j) {
+			// the frames are not decoded
+			const int len = getRandomRange(200, 3000);
+			f.writeUint16LE(len);
+			f.write(frameData, len);
+			f.writeUint16LE(j);
+			f.writeUint16LE(getRandomRange(16, 120));
+			f.writeUint16LE(getRandomRange(16, 120));
+			f.writeUint16LE(getRandomRange(-20, 20));
+			f.writeUint16LE(getRandomRange(-20, 20));
+		}
+	}
+	f.writeUint16LE(0);
+	f.close();
+}
+
+static void generateMovie(int scene, int movie) {
+	char name[64];
+	snprintf(name, sizeof(name), "MOV/S%dM%d.MOV", scene, movie);
+	File f;
+	writeFile(name, &f);
+	f.writeUint16LE(0x354D);
+	snprintf(name, sizeof(name), "S%dM%d.SPR", scene, movie);
+	writeString(&f, name);
+	snprintf(name, sizeof(name), "..\\WGP\\S%d.WGP", scene);
+	writeString(&f, name);
+	f.writeUint16LE(100);
+	f.writeUint16LE(2);
+	for (int i = 0; i < kBoxesCount; ++i) {
+		f.writeUint16LE(1 + (movie * kBoxesCount + i) % 10); // the scene screen clears the first 10 boxes banks
+		f.writeByte(1);
+		const int x = getRandomRange(0, 500);
+		const int y = getRandomRange(0, 400);
+		f.writeUint16LE(x);
+		f.writeUint16LE(y);
+		f.writeUint16LE(x + getRandomRange(1, 100));
+		f.writeUint16LE(y + getRandomRange(1, 60));
+	}
+	f.writeUint16LE(0);
+	for (int i = 0; i < kObjectsCount; ++i) {
+		f.writeUint16LE(3);
+		snprintf(name, sizeof(name), "S%dM%dO%d", scene, movie, i);
+		writeString(&f, name);
+		f.writeUint16LE(2000);
+		writeString(&f, "CLASS");
+		f.writeUint16LE(3500);
+		f.writeUint16LE(getRandomRange(0, 600));
+		f.writeUint16LE(getRandomRange(0, 440));
+		f.writeUint16LE(4000);
+		f.writeUint16LE(getRandomNumber(100));
+		f.writeUint16LE(5500);
+		f.writeUint16LE(1 + getRandomNumber(kMotionsCount));
+		f.writeUint16LE(0);
+	}
+	f.writeUint16LE(5);
+	f.writeUint16LE(0);
+	// statements without conditions nor operators
+	f.writeUint16LE(4);
+	f.writeUint16LE(kStatementsCount * 4);
+	for (int i = 0; i < kStatementsCount; ++i) {
+		f.writeUint16LE((i + 1) * 4);
+		f.writeUint16LE(0);
+	}
+	f.close();
+	snprintf(name, sizeof(name), "MOV/S%dM%d.SPR", scene, movie);
+	generateSprites(name);
+}
+
+static void generateBackground(int scene) {
+	char name[64];
+	snprintf(name, sizeof(name), "WGP/S%d.WGP", scene);
+	File f;
+	writeFile(name, &f);
+	// uncompressed, as _10.SCN
+	static uint8_t bitmap[kOffsetBitmapBits + kGameScreenWidth * kGameScreenHeight];
+	memset(bitmap, 0, sizeof(bitmap));
+	writeUint32LE(bitmap, 40);
+	writeUint32LE(bitmap + 4, kGameScreenWidth);
+	writeUint32LE(bitmap + 8, kGameScreenHeight);
+	f.writeUint16LE(0x4D42);
+	f.writeUint32LE(sizeof(bitmap) + 14);
+	f.writeUint32LE(0);
+	f.writeUint32LE(0);
+	f.write(bitmap, sizeof(bitmap));
+	f.close();
+}
+
+static void generateScene(int scene) {
+	char name[64];
+	snprintf(name, sizeof(name), "SCN/S%d.SCN", scene);
+	File f;
+	writeFile(name, &f);
+	char buf[128];
+	snprintf(buf, sizeof(buf), "SceneNumber %d\r\nScreen ..\\WGP\\S%d.WGP\r\nMovies\r\n", scene + 1, scene);
+	f.write(buf, strlen(buf));
+	for (int i = 0; i < kMoviesCount; ++i) {
+		snprintf(buf, sizeof(buf), "..\\MOV\\S%dM%d.MOV\r\n", scene, i);
+		f.write(buf, strlen(buf));
+		generateMovie(scene, i);
+	}
+	snprintf(buf, sizeof(buf), "MoviesEnd\r\nEnd\r\n");
+	f.write(buf, strlen(buf));
+	f.close();
+	generateBackground(scene);
+}
+
+static void createDataDirectory() {
+	snprintf(_dataPath, sizeof(_dataPath), "/tmp/bench_sceneXXXXXX");
+	if (!mkdtemp(_dataPath)) {
+		error("Unable to create data directory");
+	}
+	// the engine looks for the startup scene and the dialogues
+	static const char *files[] = { "SCN/_01.SCN", "TEXT/02_0.DLG", 0 };
+	for (int i = 0; files[i]; ++i) {
+		File f;
+		writeFile(files[i], &f);
+		f.write((void *)"test", 4);
+		f.close();
+	}
+	for (int i = 0; i < 2; ++i) {
+		generateScene(i);
+	}
+}
+
+static void removeDataDirectory() {
+	char cmd[128];
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", _dataPath);
+	system(cmd);
+}
+
+static void benchSceneSwitch(Game *g, uint32_t readBufferSize) {
+	File::_readBufferSize = readBufferSize;
+	// the statistics file reads are not counted
+	const uint32_t syscallsOverhead = getReadSyscallsCount() - getReadSyscallsCount();
+	uint32_t readsCount = 0;
+	uint32_t ioReadsCount = 0;
+	uint32_t syscallsCount = 0;
+	uint32_t t = 0;
+	for (int i = 0; i < kSwitchesCount; ++i) {
+		const uint32_t reads = File::_readsCount;
+		const uint32_t ioReads = File::_ioReadsCount;
+		const uint32_t syscalls = getReadSyscallsCount();
+		const uint32_t t0 = getTimeUs();
+		g->parseSCN((i & 1) ? "S1.SCN" : "S0.SCN");
+		t += getTimeUs() - t0;
+		syscallsCount += getReadSyscallsCount() - syscalls - syscallsOverhead;
+		readsCount += File::_readsCount - reads;
+		ioReadsCount += File::_ioReadsCount - ioReads;
+	}
+	printf("read buffer %3dKB: %5d file reads, %5d io reads, %5d read syscalls, %5dus per scene switch\n",
+		readBufferSize / 1024, readsCount / kSwitchesCount, ioReadsCount / kSwitchesCount, syscallsCount / kSwitchesCount, t / kSwitchesCount);
+}
+
+int main(int argc, char *argv[]) {
+	createDataDirectory();
+	SystemStub *stub = SystemStub_Null_create(0, 0, 0);
+	Game *g = new Game(stub, _dataPath, _dataPath, _dataPath);
+	g->allocateTables();
+	const uint32_t readBufferSize = File::_readBufferSize;
+	// loads the files in the page cache, each switch then reloads all the movies
+	g->parseSCN("S0.SCN");
+	g->parseSCN("S1.SCN");
+	benchSceneSwitch(g, 0);
+	benchSceneSwitch(g, readBufferSize);
+	g->clearSceneData(-1);
+	g->deallocateTables();
+	removeDataDirectory();
+	return 0;
+}
@@ -0,0 +1,1836 @@
+/*
+ * Bermuda Syndrome engine rewrite
+ * Copyright (C) 2007-2011 Gregory Montoir
+ */
+
+#include "../game.h"
+#include "../decoder.h"
+#include "../systemstub.h"
+
+// the object scripts interpreter as it was before the operands were decoded statically :
+// the opcodes consume their operands from the data stream. It is kept unchanged as the
+// reference the engine interpreter and the compiled scripts are checked against.
+
+struct ReferenceInterpreter {
+	Game *_g;
+
+	ReferenceInterpreter(Game *g) : _g(g) {}
+
+	const char *fetchNextString() {
+		Script *s = &_g->_objectScript;
+		const int len = s->fetchNextWord();
+		assert(len >= 1);
+		const char *str = (const char *)s->data + s->dataOffset;
+		s->dataOffset += len;
+		return str;
+	}
+
+	const char *getString() const {
+		return _g->_objectScript.getString(_g->_objectScript.dataOffset);
+	}
+
+	bool run(int endOfDataOffset);
+	int findObjectByName(int currentObjectNum, int defaultObjectNum, bool *objectFlag);
+	int16_t getObjectTransformXPos(int object);
+	int16_t getObjectTransformYPos(int object);
+	bool comparePrevObjectTransformXPos(int object, bool fetchCmp = true, int cmpX = -1);
+	bool compareObjectTransformXPos(int object, bool fetchCmp = true, int cmpX = -1);
+	bool comparePrevObjectTransformYPos(int object, bool fetchCmp = true, int cmpY = -1);
+	bool compareObjectTransformYPos(int object, bool fetchCmp = true, int cmpY = -1);
+	void setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2);
+	bool executeConditionOpcode(int num);
+	void executeOperatorOpcode(int num);
+	void evalExpr(int16_t *val);
+	bool testExpr(int16_t val);
+	bool cop_true();
+	bool cop_isInRandomRange();
+	bool cop_isKeyPressed();
+	bool cop_isKeyNotPressed();
+	bool cop_testMouseButtons();
+	bool cop_isObjectInScene();
+	bool cop_testObjectPrevState();
+	bool cop_testObjectState();
+	bool cop_isObjectInRect();
+	bool cop_testPrevObjectTransformXPos();
+	bool cop_testObjectTransformXPos();
+	bool cop_testPrevObjectTransformYPos();
+	bool cop_testObjectTransformYPos();
+	bool cop_testObjectPrevFlip();
+	bool cop_testObjectFlip();
+	bool cop_testObjectPrevFrameNum();
+	bool cop_testObjectFrameNum();
+	bool cop_testPrevMotionNum();
+	bool cop_testMotionNum();
+	bool cop_testObjectVar();
+	bool cop_testObjectAndObjectXPos();
+	bool cop_testObjectAndObjectYPos();
+	bool cop_testObjectMotionYPos();
+	bool cop_testVar();
+	bool cop_isCurrentBagAction();
+	bool cop_isObjectInBox();
+	bool cop_isObjectNotInBox();
+	bool cop_isObjectNotIntersectingBox();
+	bool cop_isCurrentBagObject();
+	bool cop_isLifeBarDisplayed();
+	bool cop_isLifeBarNotDisplayed();
+	bool cop_testLastDialogue();
+	bool cop_isNextScene();
+	void oop_initializeObject();
+	void oop_evalCurrentObjectX();
+	void oop_evalCurrentObjectY();
+	void oop_evalObjectX();
+	void oop_evalObjectY();
+	void oop_evalObjectZ();
+	void oop_setObjectFlip();
+	void oop_adjustObjectPos_vv0000();
+	void oop_adjustObjectPos_vv1v00();
+	void oop_adjustObjectPos_vv1v1v();
+	void oop_setupObjectPos_121();
+	void oop_setupObjectPos_122();
+	void oop_setupObjectPos_123();
+	void oop_adjustObjectPos_1v0000();
+	void oop_adjustObjectPos_1v1v1v();
+	void oop_setupObjectPos_021();
+	void oop_setupObjectPos_022();
+	void oop_setupObjectPos_023();
+	void oop_evalObjectVar();
+	void oop_translateObjectXPos();
+	void oop_translateObjectYPos();
+	void oop_setObjectMode();
+	void oop_setObjectInitPos();
+	void oop_setObjectTransformInitPos();
+	void oop_evalObjectXInit();
+	void oop_evalObjectYInit();
+	void oop_evalObjectZInit();
+	void oop_setObjectFlipInit();
+	void oop_setObjectCel();
+	void oop_resetObjectCel();
+	void oop_evalVar();
+	void oop_getSceneNumberInVar();
+	void oop_disableBox();
+	void oop_enableBox();
+	void oop_evalBoxesXPos();
+	void oop_evalBoxesYPos();
+	void oop_setBoxToObject();
+	void oop_clipBoxes();
+	void oop_saveObjectStatus();
+	void oop_addObjectToBag();
+	void oop_removeObjectFromBag();
+	void oop_playSoundLowerEqualPriority();
+	void oop_playSoundLowerPriority();
+	void oop_startDialogue();
+	void oop_switchSceneClearBoxes();
+	void oop_switchSceneCopyBoxes();
+};
+
+int ReferenceInterpreter::findObjectByName(int currentObjectNum, int defaultObjectNum, bool *objectFlag) {
+	int index = -1;
+	*objectFlag = true;
+	int16_t len = _g->_objectScript.fetchNextWord();
+	debug(DBG_GAME, "ReferenceInterpreter::findObjectByName() len = %d", len);
+	if (len == -1) {
+		index = defaultObjectNum;
+	} else if (len == 0) {
+		*objectFlag = false;
+		index = currentObjectNum;
+	} else {
+		debug(DBG_GAME, "ReferenceInterpreter::findObjectByName() name = '%s' len = %d", getString(), len);
+		for (int i = 0; i < _g->_sceneObjectsCount; ++i) {
+			if (strcmp(_g->_sceneObjectsTable[i].name, getString()) == 0) {
+				index = i;
+				break;
+			}
+		}
+		_g->_objectScript.dataOffset += len;
+	}
+	return index;
+}
+
+int16_t ReferenceInterpreter::getObjectTransformXPos(int object) {
+	debug(DBG_GAME, "ReferenceInterpreter::getObjectTransformXPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int w = _g->derefSceneObjectFrame(so->frameNumPrev)->hdr.w;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+
+	int16_t dx = a0 * w / a2 + a4;
+	if (so->flipPrev == 2) {
+		dx = w - dx - 1;
+	}
+	return so->xPrev + dx;
+}
+
+int16_t ReferenceInterpreter::getObjectTransformYPos(int object) {
+	debug(DBG_GAME, "ReferenceInterpreter::getObjectTransformYPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int h = _g->derefSceneObjectFrame(so->frameNumPrev)->hdr.h;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+
+	int16_t dy = a0 * h / a2 + a4;
+	if (so->flipPrev == 1) {
+		dy = h - dy - 1;
+	}
+	return so->yPrev + dy;
+}
+
+bool ReferenceInterpreter::comparePrevObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
+	debug(DBG_GAME, "ReferenceInterpreter::comparePrevObjectTransformXPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int w = _g->derefSceneObjectFrame(so->frameNumPrev)->hdr.w;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+	int16_t a6 = _g->_objectScript.fetchNextWord();
+	int16_t a8 = _g->_objectScript.fetchNextWord();
+	int16_t aA = _g->_objectScript.fetchNextWord();
+	if (fetchCmp) {
+		cmpX = _g->_objectScript.fetchNextWord();
+	}
+
+	int16_t xmin = a0 * w / a2 + a4;
+	int16_t xmax = a6 * w / a8 + aA;
+	if (so->flipPrev == 2) {
+		xmin = w - xmin;
+		xmax = w - xmax;
+	}
+	if (xmax < xmin) {
+		SWAP(xmax, xmin);
+	}
+	return so->statePrev != 0 && so->xPrev + xmin <= cmpX && so->xPrev + xmax >= cmpX;
+}
+
+bool ReferenceInterpreter::compareObjectTransformXPos(int object, bool fetchCmp, int cmpX) {
+	debug(DBG_GAME, "ReferenceInterpreter::compareObjectTransformXPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int w = _g->derefSceneObjectFrame(so->frameNum)->hdr.w;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+	int16_t a6 = _g->_objectScript.fetchNextWord();
+	int16_t a8 = _g->_objectScript.fetchNextWord();
+	int16_t aA = _g->_objectScript.fetchNextWord();
+	if (fetchCmp) {
+		cmpX = _g->_objectScript.fetchNextWord();
+	}
+
+	int16_t xmin = a0 * w / a2 + a4;
+	int16_t xmax = a6 * w / a8 + aA;
+	if (so->flip == 2) {
+		xmin = w - xmin;
+		xmax = w - xmax;
+	}
+	if (xmax < xmin) {
+		SWAP(xmax, xmin);
+	}
+	return so->state != 0 && so->x + xmin <= cmpX && so->x + xmax >= cmpX;
+}
+
+bool ReferenceInterpreter::comparePrevObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
+	debug(DBG_GAME, "ReferenceInterpreter::comparePrevObjectTransformYPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int h = _g->derefSceneObjectFrame(so->frameNumPrev)->hdr.h;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+	int16_t a6 = _g->_objectScript.fetchNextWord();
+	int16_t a8 = _g->_objectScript.fetchNextWord();
+	int16_t aA = _g->_objectScript.fetchNextWord();
+	if (fetchCmp) {
+		cmpY = _g->_objectScript.fetchNextWord();
+	}
+
+	int16_t ymin = a0 * h / a2 + a4;
+	int16_t ymax = a6 * h / a8 + aA;
+	if (so->flipPrev == 1) {
+		ymin = h - ymin;
+		ymax = h - ymax;
+	}
+	if (ymax < ymin) {
+		SWAP(ymax, ymin);
+	}
+	return so->statePrev != 0 && so->yPrev + ymin <= cmpY && so->yPrev + ymax >= cmpY;
+}
+
+bool ReferenceInterpreter::compareObjectTransformYPos(int object, bool fetchCmp, int cmpY) {
+	debug(DBG_GAME, "ReferenceInterpreter::compareObjectTransformYPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	const int h = _g->derefSceneObjectFrame(so->frameNum)->hdr.h;
+
+	int16_t a0 = _g->_objectScript.fetchNextWord();
+	int16_t a2 = _g->_objectScript.fetchNextWord();
+	int16_t a4 = _g->_objectScript.fetchNextWord();
+	int16_t a6 = _g->_objectScript.fetchNextWord();
+	int16_t a8 = _g->_objectScript.fetchNextWord();
+	int16_t aA = _g->_objectScript.fetchNextWord();
+	if (fetchCmp) {
+		cmpY = _g->_objectScript.fetchNextWord();
+	}
+
+	int16_t ymin = a0 * h / a2 + a4;
+	int16_t ymax = a6 * h / a8 + aA;
+	if (so->flip == 1) {
+		ymin = h - ymin;
+		ymax = h - ymax;
+	}
+	if (ymax < ymin) {
+		SWAP(ymax, ymin);
+	}
+	return so->state != 0 && so->y + ymin <= cmpY && so->y + ymax >= cmpY;
+}
+
+void ReferenceInterpreter::setupObjectPos(int object, int object2, int useObject2, int useData, int type1, int type2) {
+	debug(DBG_GAME, "ReferenceInterpreter::setupObjectPos(%d)", object);
+	SceneObject *so = _g->derefSceneObject(object);
+	SceneObjectFrame *sof = _g->derefSceneObjectFrame(so->frameNumPrev);
+	int16_t a0, a2, a4;
+	int16_t dy = 0, dx = 0, xmin = 0, xmax, ymin = 0, ymax, _ax;
+	if (so->statePrev != 0) {
+		if (type1 == 2) {
+			a0 = _g->_objectScript.fetchNextWord();
+			a2 = _g->_objectScript.fetchNextWord();
+			a4 = _g->_objectScript.fetchNextWord();
+			xmin = a0 * sof->hdr.w / a2 + a4;
+			a0 = _g->_objectScript.fetchNextWord();
+			a2 = _g->_objectScript.fetchNextWord();
+			a4 = _g->_objectScript.fetchNextWord();
+			xmax = a0 * sof->hdr.w / a2 + a4;
+			if (xmax < xmin) {
+				SWAP(xmin, xmax);
+			}
+			dx = xmax - xmin;
+		}
+		if (type2 == 2) {
+			a0 = _g->_objectScript.fetchNextWord();
+			a2 = _g->_objectScript.fetchNextWord();
+			a4 = _g->_objectScript.fetchNextWord();
+			ymin = a0 * sof->hdr.h / a2 + a4;
+			a0 = _g->_objectScript.fetchNextWord();
+			a2 = _g->_objectScript.fetchNextWord();
+			a4 = _g->_objectScript.fetchNextWord();
+			ymax = a0 * sof->hdr.h / a2 + a4;
+			if (ymax < ymin) {
+				SWAP(ymin, ymax);
+			}
+			dy = ymax - ymin;
+		}
+
+		if (useObject2 == 0) {
+			_ax = _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstMotionIndex;
+		} else {
+			_ax = _g->_sceneObjectsTable[object2].motionInit;
+		}
+		so->motionNum2 = _ax + _g->_objectScript.fetchNextWord() - 1;
+		if (useData == 0) {
+			so->frameNum = _g->_sceneObjectMotionsTable[so->motionNum2].firstFrameIndex;
+		} else {
+			so->frameNum = _g->_sceneObjectMotionsTable[so->motionNum2].firstFrameIndex + _g->_objectScript.fetchNextWord() - 1;
+		}
+
+		int16_t _si = _g->_sceneObjectFramesTable[so->frameNum].hdr.xPos - sof->hdr.xPos;
+		if (type1 == 2) {
+			 _si = ((xmin - dx + 1) / dx) * dx + _si % dx;
+			if (_si < xmin) {
+				_si += dx;
+			}
+		} else if (type1 == 3) {
+			a0 = _g->_objectScript.fetchNextWord();
+			_g->_objectScript.fetchNextWord();
+			_si = a0 - sof->hdr.xPos;
+		}
+
+		int16_t _di = _g->_sceneObjectFramesTable[so->frameNum].hdr.yPos - sof->hdr.yPos;
+		if (type2 == 2) {
+			_di = ((ymin - dy + 1) / dy) * dy + _di % dy;
+			if (_di < ymin) {
+				_di += dy;
+			}
+		} else if (type2 == 3) {
+			_g->_objectScript.fetchNextWord();
+			a2 = _g->_objectScript.fetchNextWord();
+			_di = a2 - sof->hdr.yPos;
+		}
+
+		if (so->flipPrev == 2) {
+			_ax = so->xPrev - _si;
+			_ax += _g->_sceneObjectFramesTable[so->frameNumPrev].hdr.w;
+			_ax -= _g->_sceneObjectFramesTable[so->frameNum].hdr.w;
+		} else {
+			_ax = so->xPrev + _si;
+		}
+		so->x = _ax;
+		so->y = so->yPrev + _di;
+	}
+}
+
+bool ReferenceInterpreter::executeConditionOpcode(int num) {
+	switch (num) {
+	case    10: return cop_true();
+	case   100: return cop_isInRandomRange();
+	case   500: return cop_isKeyPressed();
+	case   510: return cop_isKeyNotPressed();
+	case  1100: return cop_testMouseButtons();
+	case  2500: return cop_isObjectInScene();
+	case  3000: return cop_testObjectPrevState();
+	case  3010: return cop_testObjectState();
+	case  3050: return cop_isObjectInRect();
+	case  3100: return cop_testPrevObjectTransformXPos();
+	case  3105: return cop_testObjectTransformXPos();
+	case  3110: return cop_testPrevObjectTransformYPos();
+	case  3150: return cop_testObjectTransformYPos();
+	case  3300: return cop_testObjectPrevFlip();
+	case  3310: return cop_testObjectFlip();
+	case  3400: return cop_testObjectPrevFrameNum();
+	case  3410: return cop_testObjectFrameNum();
+	case  3500: return cop_testPrevMotionNum();
+	case  3510: return cop_testMotionNum();
+	case  3600: return cop_testObjectVar();
+	case  3700: return cop_testObjectAndObjectXPos();
+	case  3710: return cop_testObjectAndObjectYPos();
+	case  4110: return cop_testObjectMotionYPos();
+	case  6000: return cop_testVar();
+	case  6500: return cop_isCurrentBagAction();
+	case  7000: return cop_isObjectInBox();
+	case  7500: return cop_isObjectNotInBox();
+	case  8500: return cop_isObjectNotIntersectingBox();
+	case 10000: return cop_isCurrentBagObject();
+	case 20000: return cop_isLifeBarDisplayed();
+	case 20010: return cop_isLifeBarNotDisplayed();
+	case 25000: return cop_testLastDialogue();
+	case 30000: return cop_isNextScene();
+	default:
+		error("Invalid condition %d", num);
+	}
+	return false;
+}
+
+void ReferenceInterpreter::executeOperatorOpcode(int num) {
+	switch (num) {
+	case  3000: return oop_initializeObject();
+	case  3100: return oop_evalCurrentObjectX();
+	case  3110: return oop_evalCurrentObjectY();
+	case  3120: return oop_evalObjectX();
+	case  3130: return oop_evalObjectY();
+	case  3200: return oop_evalObjectZ();
+	case  3300: return oop_setObjectFlip();
+	case  3400: return oop_adjustObjectPos_vv0000();
+	case  3410: return oop_adjustObjectPos_vv1v00();
+	case  3430: return oop_adjustObjectPos_vv1v1v();
+	case  3440: return oop_setupObjectPos_121();
+	case  3460: return oop_setupObjectPos_122();
+	case  3480: return oop_setupObjectPos_123();
+	case  3500: return oop_adjustObjectPos_1v0000();
+	case  3530: return oop_adjustObjectPos_1v1v1v();
+	case  3540: return oop_setupObjectPos_021();
+	case  3560: return oop_setupObjectPos_022();
+	case  3580: return oop_setupObjectPos_023();
+	case  4000: return oop_evalObjectVar();
+	case  4100: return oop_translateObjectXPos();
+	case  4200: return oop_translateObjectYPos();
+	case  5000: return oop_setObjectMode();
+	case  5100: return oop_setObjectInitPos();
+	case  5110: return oop_setObjectTransformInitPos();
+	case  5112: return oop_evalObjectXInit();
+	case  5114: return oop_evalObjectYInit();
+	case  5200: return oop_evalObjectZInit();
+	case  5300: return oop_setObjectFlipInit();
+	case  5400: return oop_setObjectCel();
+	case  5500: return oop_resetObjectCel();
+	case  6000: return oop_evalVar();
+	case  6100: return oop_getSceneNumberInVar();
+	case  7000: return oop_disableBox();
+	case  7010: return oop_enableBox();
+	case  7100: return oop_evalBoxesXPos();
+	case  7110: return oop_evalBoxesYPos();
+	case  7200: return oop_setBoxToObject();
+	case  7300: return oop_clipBoxes();
+	case  8000: return oop_saveObjectStatus();
+	case 10000: return oop_addObjectToBag();
+	case 11000: return oop_removeObjectFromBag();
+	case 20000: return oop_playSoundLowerEqualPriority();
+	case 20010: return oop_playSoundLowerPriority();
+	case 25000: return oop_startDialogue();
+	case 30000: return oop_switchSceneClearBoxes();
+	case 30010: return oop_switchSceneCopyBoxes();
+	default:
+		error("Invalid operator %d", num);
+	}
+}
+
+void ReferenceInterpreter::evalExpr(int16_t *val) {
+	int16_t op = _g->_objectScript.fetchNextWord();
+	int16_t arg = _g->_objectScript.fetchNextWord();
+	switch (op) {
+	case 0:
+		*val = arg;
+		break;
+	case 1:
+		*val += arg;
+		break;
+	case 2:
+		*val -= arg;
+		break;
+	case 3:
+		*val *= arg;
+		break;
+	case 4:
+		*val /= arg;
+		break;
+	default:
+		error("Invalid eval op %d", op);
+		break;
+	}
+}
+
+bool ReferenceInterpreter::testExpr(int16_t val) {
+	bool ret = false;
+	int16_t op = _g->_objectScript.fetchNextWord();
+	if (op == -1) {
+		int count = _g->_objectScript.fetchNextWord();
+		while (count--) {
+			int16_t cmp1 = _g->_objectScript.fetchNextWord();
+			int16_t cmp2 = _g->_objectScript.fetchNextWord();
+			if (cmp1 > cmp2) {
+				warning("testExpr cmp %d,%d", cmp1, cmp2);
+			}
+			if (cmp1 <= val && cmp2 >= val) {
+				ret = true;
+			}
+		}
+	} else {
+		int16_t arg = _g->_objectScript.fetchNextWord();
+		switch (op) {
+		case 0:
+			if (arg == val) {
+				ret = true;
+			}
+			break;
+		case 1:
+			if (arg != val) {
+				ret = true;
+			}
+			break;
+		case 2:
+			if (arg > val) {
+				ret = true;
+			}
+			break;
+		case 3:
+			if (arg < val) {
+				ret = true;
+			}
+			break;
+		case 4:
+			if (arg >= val) {
+				ret = true;
+			}
+			break;
+		case 5:
+			if (arg <= val) {
+				ret = true;
+			}
+			break;
+		default:
+			error("Invalid eval op %d", op);
+			break;
+		}
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_true() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_true");
+	return true;
+}
+
+bool ReferenceInterpreter::cop_isInRandomRange() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isInRandomRange");
+	int16_t rnd = _g->_rnd.getNumber();
+	int t = (int16_t)_g->_objectScript.fetchNextWord();
+	return ((((t * rnd) / 0x8000) & 0xFFFF) == 0);
+}
+
+bool ReferenceInterpreter::cop_isKeyPressed() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isKeyPressed");
+	int key = _g->_objectScript.fetchNextWord();
+	return _g->_keysPressed[key] != 0;
+}
+
+bool ReferenceInterpreter::cop_isKeyNotPressed() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isKeyNotPressed");
+	int key = _g->_objectScript.fetchNextWord();
+	return _g->_keysPressed[key] == 0;
+}
+
+bool ReferenceInterpreter::cop_testMouseButtons() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testMouseButtons");
+	bool ret = true;
+	int t = _g->_objectScript.fetchNextWord();
+	switch (t) {
+	case 0:
+		ret = (_g->_mouseButtonsPressed & kLeftMouseButton) != 0;
+		break;
+	case 1:
+		ret = (_g->_mouseButtonsPressed & kRightMouseButton) != 0;
+		break;
+	case 2:
+		ret = (_g->_mouseButtonsPressed & kLeftMouseButton) == 0;
+		break;
+	case 3:
+		ret = (_g->_mouseButtonsPressed & kRightMouseButton) == 0;
+		break;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_isObjectInScene() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isObjectInScene");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		if (index != _g->_objectScript.currentObjectNum) {
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectPrevState() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectPrevState");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t state = _g->_objectScript.fetchNextWord();
+		if (so->statePrev != state) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectState() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectState");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t state = _g->_objectScript.fetchNextWord();
+		if (so->state != state) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_isObjectInRect() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isObjectInRect");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	int16_t var1E = _g->_objectScript.fetchNextWord(); // x1
+	int16_t var22 = _g->_objectScript.fetchNextWord(); // y1
+	int16_t var20 = _g->_objectScript.fetchNextWord(); // x2
+	int16_t var24 = _g->_objectScript.fetchNextWord(); // y2
+	assert(var1E <= var20);
+	assert(var22 <= var24);
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->state != 0) {
+			int xObj = so->xPrev + _g->_sceneObjectFramesTable[so->frameNumPrev].hdr.w;
+			if (xObj >= var1E && so->xPrev <= var20) {
+				int yObj = so->yPrev + _g->_sceneObjectFramesTable[so->frameNumPrev].hdr.h;
+				if (yObj >= var22 && so->yPrev <= var24) {
+					return ret;
+				}
+			}
+		}
+		ret = false;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testPrevObjectTransformXPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testPrevObjectTransformXPos");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret && _g->derefSceneObject(index)->statePrev != 0) {
+		if (!comparePrevObjectTransformXPos(index)) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 14;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectTransformXPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectTransformXPos");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret && _g->derefSceneObject(index)->state != 0) {
+		if (!compareObjectTransformXPos(index)) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 14;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testPrevObjectTransformYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testPrevObjectTransformYPos");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret && _g->derefSceneObject(index)->statePrev != 0) {
+		if (!comparePrevObjectTransformYPos(index)) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 14;
+	}
+	return ret;
+
+}
+
+bool ReferenceInterpreter::cop_testObjectTransformYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectTransformYPos");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret && _g->derefSceneObject(index)->state != 0) {
+		if (!compareObjectTransformYPos(index)) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 14;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectPrevFlip() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectPrevFlip");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t flip = _g->_objectScript.fetchNextWord();
+		if (flip != so->flipPrev) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectFlip() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectFlip");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t flip = _g->_objectScript.fetchNextWord();
+		if (flip != so->flip) {
+			ret = false;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectPrevFrameNum() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectPrevFrameNum");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t val = so->frameNumPrev - _g->_sceneObjectMotionsTable[so->motionNum1].firstFrameIndex + 1;
+			if (testExpr(val)) {
+				return true;
+			}
+		}
+		ret = false;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectFrameNum() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectFrameNum");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t val = so->frameNum - _g->_sceneObjectMotionsTable[so->motionNum2].firstFrameIndex + 1;
+			if (testExpr(val)) {
+				return true;
+			}
+		}
+		ret = false;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testPrevMotionNum() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testPrevMotionNum");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t _dx = so->motionNum1 - _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstMotionIndex;
+			int16_t _ax = 0;
+			if (_g->_objectScript.objectFound) {
+				if (_g->_sceneObjectMotionsTable[so->motionNum1].animNum != _g->_sceneObjectMotionsTable[so->motionInit].animNum) {
+					_ax = _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].unk26;
+				}
+			}
+			if (testExpr(_ax + _dx + 1)) {
+				return true;
+			}
+		}
+		ret = false;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testMotionNum() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testMotionNum");
+	bool ret = true;
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t _dx = so->motionNum2 - _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstMotionIndex;
+			int16_t _ax = 0;
+			if (_g->_objectScript.objectFound) {
+				if (_g->_sceneObjectMotionsTable[so->motionNum1].animNum != _g->_sceneObjectMotionsTable[so->motionInit].animNum) {
+					_ax = _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].unk26;
+				}
+			}
+			if (testExpr(_ax + _dx + 1)) {
+				return true;
+			}
+		}
+		ret = false;
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectVar() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectVar()");
+	bool ret = true;
+	int var = _g->_objectScript.fetchNextWord();
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		assert(var >= 0 && var < 10);
+		if (!testExpr(so->varsTable[var])) {
+			ret = false;
+		}
+	}
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_testObjectAndObjectXPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectAndObjectXPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t var1E = getObjectTransformXPos(index);
+			int16_t var20 = getObjectTransformXPos(index);
+			int var18 = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+			if (var18 != -1) {
+				so = _g->derefSceneObject(var18);
+				if (so->statePrev == 0) {
+					return false;
+				}
+				int16_t var22 = getObjectTransformXPos(var18);
+				int16_t var24 = getObjectTransformXPos(var18);
+				int16_t _dx = MIN(var1E, var20);
+				int16_t _ax = MAX(var22, var24);
+				if (_dx <= _ax) {
+					_dx = MAX(var1E, var20);
+					_ax = MIN(var22, var24);
+					if (_dx >= _ax) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_testObjectAndObjectYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectAndObjectYPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t var22 = getObjectTransformYPos(index);
+			int16_t var24 = getObjectTransformYPos(index);
+			int var18 = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+			if (var18 != -1) {
+				so = _g->derefSceneObject(var18);
+				if (so->statePrev == 0) {
+					return false;
+				}
+				int16_t var1E = getObjectTransformYPos(var18);
+				int16_t var20 = getObjectTransformYPos(var18);
+				int16_t _dx = MIN(var22, var24);
+				int16_t _ax = MAX(var1E, var20);
+				if (_dx <= _ax) {
+					_dx = MAX(var22, var24);
+					_ax = MIN(var1E, var20);
+					if (_dx >= _ax) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_testObjectMotionYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testObjectMotionYPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int num = so->motionNum + so->motionInit;
+		int16_t var1A = _g->_sceneObjectMotionsTable[num].firstFrameIndex + so->motionFrameNum;
+		int _ax = so->yPrev - so->yInit;
+		_ax -= _g->_sceneObjectFramesTable[so->frameNumPrev].hdr.yPos;
+		_ax += _g->_sceneObjectFramesTable[var1A].hdr.yPos;
+		int16_t div = _g->_objectScript.fetchNextWord();
+		var1A = _ax % div;
+		if (var1A < 0) {
+			var1A += div;
+		}
+		int16_t cmp = _g->_objectScript.fetchNextWord();
+		if (var1A == cmp && so->state == 1) {
+			return true;
+		}
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_testVar() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testVar()");
+	int var = _g->_objectScript.fetchNextWord();
+	bool ret = testExpr(_g->_varsTable[var]);
+	return ret;
+}
+
+bool ReferenceInterpreter::cop_isCurrentBagAction() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isCurrentBagAction()");
+	int16_t num = _g->_objectScript.fetchNextWord();
+	return num == _g->_currentBagAction;
+}
+
+bool ReferenceInterpreter::cop_isObjectInBox() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isObjectInBox()");
+	bool ret = true;
+	int16_t var1A = _g->_objectScript.fetchNextWord(); // boxNum
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound); // var18
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t var1E = getObjectTransformXPos(index); // x1
+			int16_t var20 = getObjectTransformXPos(index); // x2
+			int16_t var22 = getObjectTransformYPos(index); // y1
+			int16_t var24 = getObjectTransformYPos(index); // y2
+			bool foundBox = false;
+			for (int i = 0; i < _g->_boxesCountTable[var1A]; ++i) {
+				Box *box = _g->derefBox(var1A, i);
+				if (boxInRect(box, var1E, var20, var22, var24) && box->state == 1) {
+					foundBox = true;
+					break;
+				}
+			}
+			if (foundBox) {
+				return true;
+			}
+			foundBox = false;
+			for (int i = 0; i < _g->_boxesCountTable[10 + var1A]; ++i) {
+				Box *box = _g->derefBox(10 + var1A, i);
+				if (boxInRect(box, var1E, var20, var22, var24) && box->state == 1) {
+					foundBox = true;
+					break;
+				}
+			}
+			if (foundBox) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_isObjectNotInBox() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isObjectNotInBox()");
+	bool ret = true;
+	int16_t var1A = _g->_objectScript.fetchNextWord(); // boxNum
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound); // var18
+	if (index == -1) {
+		ret = false;
+	}
+	if (ret) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t var1E = getObjectTransformXPos(index);
+			int16_t var20 = getObjectTransformXPos(index);
+			int16_t var22 = getObjectTransformYPos(index);
+			int16_t var24 = getObjectTransformYPos(index);
+			bool foundBox = false;
+			for (int i = 0; i < _g->_boxesCountTable[var1A]; ++i) {
+				Box *box = _g->derefBox(var1A, i);
+				if (boxInRect(box, var1E, var20, var22, var24) && box->state == 1) {
+					foundBox = true;
+					break;
+				}
+			}
+			if (foundBox) {
+				return false;
+			}
+			foundBox = false;
+			for (int i = 0; i < _g->_boxesCountTable[10 + var1A]; ++i) {
+				Box *box = _g->derefBox(10 + var1A, i);
+				if (boxInRect(box, var1E, var20, var22, var24) && box->state == 1) {
+					foundBox = true;
+					break;
+				}
+			}
+			if (foundBox) {
+				return false;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_isObjectNotIntersectingBox() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isObjectNotIntersectingBox()");
+	int16_t var1A = _g->_objectScript.fetchNextWord();
+	int var18 = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (var18 != -1) {
+		SceneObject *so = _g->derefSceneObject(var18);
+		if (so->statePrev != 0) {
+			int16_t var1E = getObjectTransformXPos(var18);
+			int16_t var22 = getObjectTransformYPos(var18);
+			var18 = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+			if (var18 != -1) {
+				so = _g->derefSceneObject(var18);
+				if (so->statePrev != 0) {
+					int16_t var20 = getObjectTransformXPos(var18);
+					int16_t var24 = getObjectTransformYPos(var18);
+					bool foundBox = false;
+					for (int i = 0; i < _g->_boxesCountTable[var1A]; ++i) {
+						if (_g->intersectsBox(var1A, i, var1E, var22, var20, var24)) {
+							foundBox = true;
+							break;
+						}
+					}
+					if (foundBox) {
+						return false;
+					}
+					foundBox = false;
+					for (int i = 0; i < _g->_boxesCountTable[10 + var1A]; ++i) {
+						if (_g->intersectsBox(10 + var1A, i, var1E, var22, var20, var24)) {
+							foundBox = true;
+							break;
+						}
+					}
+					if (foundBox) {
+						return false;
+					}
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool ReferenceInterpreter::cop_isCurrentBagObject() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isCurrentBagObject");
+	const char *name = fetchNextString();
+	int index = _g->findBagObjectByName(name);
+	return index != -1 && _g->_currentBagObject == index;
+}
+
+bool ReferenceInterpreter::cop_isLifeBarDisplayed() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isLifeBarDisplayed");
+	return _g->_lifeBarDisplayed;
+}
+
+bool ReferenceInterpreter::cop_isLifeBarNotDisplayed() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isLifeBarNotDisplayed");
+	return !_g->_lifeBarDisplayed;
+}
+
+bool ReferenceInterpreter::cop_testLastDialogue() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_testLastDialogue");
+	return testExpr(_g->_lastDialogueEndedId) && _g->_dialogueEndedFlag != 0;
+}
+
+bool ReferenceInterpreter::cop_isNextScene() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::cop_isNextScene");
+	int scene = _g->_objectScript.fetchNextWord();
+	for (int i = 0; i < _g->_sceneConditionsCount; ++i) {
+		if (_g->_nextScenesTable[i].num == scene) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void ReferenceInterpreter::oop_initializeObject() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_initializeObject");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t op = _g->_objectScript.fetchNextWord();
+		if (op == 0) {
+			if (so->state != 0) {
+				so->x = so->xPrev;
+				so->y = so->yPrev;
+				so->frameNum = so->frameNumPrev;
+				if (so->state == 2) {
+					SceneObjectFrame *sof = _g->derefSceneObjectFrame(so->frameNum);
+					_g->copyBufferToBuffer(so->x, _g->_bitmapBuffer1.h + 1 - so->y - sof->hdr.h, sof->hdr.w, sof->hdr.h, &_g->_bitmapBuffer3, &_g->_bitmapBuffer1);
+				}
+				so->state = -1;
+			}
+		} else if (op == 1) {
+			int16_t mode = so->mode;
+			so->mode = 1;
+			_g->reinitializeObject(index);
+			so->mode = mode;
+			if (so->state == 2) {
+				so->state = 1;
+			}
+		} else if (op == 2) {
+			if (so->state == 1) {
+				so->x = so->xPrev;
+				so->y = so->yPrev;
+				so->frameNum = so->frameNumPrev;
+				so->state = 2;
+			} else {
+				int16_t mode = so->mode;
+				so->mode = 3;
+				_g->reinitializeObject(index);
+				so->mode = mode;
+			}
+		}
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+}
+
+void ReferenceInterpreter::oop_evalCurrentObjectX() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalCurrentObjectX()");
+	SceneObject *so = _g->derefSceneObject(_g->_objectScript.currentObjectNum);
+	if (so->state != 0) {
+		_g->_objectScript.dataOffset += 6;
+		evalExpr(&so->x);
+	} else {
+		_g->_objectScript.dataOffset += 6 + 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalCurrentObjectY() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalCurrentObjectY()");
+	SceneObject *so = _g->derefSceneObject(_g->_objectScript.currentObjectNum);
+	if (so->state != 0) {
+		_g->_objectScript.dataOffset += 6;
+		evalExpr(&so->y);
+	} else {
+		_g->_objectScript.dataOffset += 6 + 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectX() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectX()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->x);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectY() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectY()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->y);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectZ() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectZ()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->z);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectFlip() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectFlip()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->flip = _g->_objectScript.fetchNextWord();
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+}
+
+void ReferenceInterpreter::oop_adjustObjectPos_vv0000() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_adjustObjectPos_vv0000()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		_g->changeObjectMotionFrame(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, a2, a0, 0, 0, 0, 0);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_adjustObjectPos_vv1v00() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_adjustObjectPos_vv1v00()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		int16_t a4 = _g->_objectScript.fetchNextWord();
+		_g->_objectScript.fetchNextWord();
+		_g->changeObjectMotionFrame(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, a2, a0, 1, a4, 0, 0);
+	} else {
+		_g->_objectScript.dataOffset += 8;
+	}
+}
+
+void ReferenceInterpreter::oop_adjustObjectPos_vv1v1v() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_adjustObjectPos_vv1v1v()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		int16_t a4 = _g->_objectScript.fetchNextWord();
+		int16_t a6 = _g->_objectScript.fetchNextWord();
+		_g->changeObjectMotionFrame(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, a2, a0, 1, a4, 1, a6);
+	} else {
+		_g->_objectScript.dataOffset += 8;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_121() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_121()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 1, 2, 1);
+	} else {
+		_g->_objectScript.dataOffset += 16;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_122() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_122()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 1, 2, 2);
+	} else {
+		_g->_objectScript.dataOffset += 28;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_123() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_123()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 1, 2, 3);
+	} else {
+		_g->_objectScript.dataOffset += 20;
+	}
+}
+
+void ReferenceInterpreter::oop_adjustObjectPos_1v0000() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_adjustObjectPos_1v0000()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		_g->changeObjectMotionFrame(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 1, a0, 0, 0, 0, 0);
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+}
+
+void ReferenceInterpreter::oop_adjustObjectPos_1v1v1v() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_adjustObjectPos_1v1v1v()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		int16_t a4 = _g->_objectScript.fetchNextWord();
+		_g->changeObjectMotionFrame(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 1, a0, 1, a2, 1, a4);
+	} else {
+		_g->_objectScript.dataOffset += 6;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_021() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_021()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 0, 2, 1);
+	} else {
+		_g->_objectScript.dataOffset += 14;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_022() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_022()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 0, 2, 2);
+	} else {
+		_g->_objectScript.dataOffset += 26;
+	}
+}
+
+void ReferenceInterpreter::oop_setupObjectPos_023() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setupObjectPos_023()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		setupObjectPos(_g->_objectScript.currentObjectNum, index, _g->_objectScript.objectFound, 0, 2, 3);
+	} else {
+		_g->_objectScript.dataOffset += 18;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectVar() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectVar()");
+	int var = _g->_objectScript.fetchNextWord();
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		assert(var >= 0 && var < 10);
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->varsTable[var]);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_translateObjectXPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_translateObjectXPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		int16_t a4 = _g->_objectScript.fetchNextWord();
+		int16_t a6 = _g->_objectScript.fetchNextWord();
+		int16_t var1A = _g->getObjectTranslateXPos(index, a0, a2, a4);
+		if (a2 / 2 >= var1A) {
+			so->x -= MIN<int16_t>(a6, var1A);
+		} else {
+			so->x += MIN<int16_t>(a6, a2 - var1A);
+		}
+	} else {
+		_g->_objectScript.dataOffset += 8;
+	}
+}
+
+void ReferenceInterpreter::oop_translateObjectYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_translateObjectYPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		int16_t a0 = _g->_objectScript.fetchNextWord();
+		int16_t a2 = _g->_objectScript.fetchNextWord();
+		int16_t a4 = _g->_objectScript.fetchNextWord();
+		int16_t a6 = _g->_objectScript.fetchNextWord();
+		int16_t var1A = _g->getObjectTranslateYPos(index, a0, a2, a4);
+		if (a2 / 2 >= var1A) {
+			so->y -= MIN<int16_t>(a6, var1A);
+		} else {
+			so->y += MIN<int16_t>(a6, a2 - var1A);
+		}
+	} else {
+		_g->_objectScript.dataOffset += 8;
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectMode() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectMode()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	int mode = _g->_objectScript.fetchNextWord();
+	int modeRndMul = 0;
+	if (mode == 2) {
+		modeRndMul = _g->_objectScript.fetchNextWord();
+	}
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->mode = mode;
+		if (mode == 2) {
+			so->modeRndMul = modeRndMul;
+		}
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectInitPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectInitPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->xInit = _g->_objectScript.fetchNextWord();
+		so->yInit = _g->_objectScript.fetchNextWord();
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectTransformInitPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectTransformInitPos()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->xInit = getObjectTransformXPos(_g->_objectScript.currentObjectNum);
+		so->yInit = getObjectTransformYPos(_g->_objectScript.currentObjectNum);
+	} else {
+		_g->_objectScript.dataOffset += 12;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectXInit() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectXInit()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->xInit);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectYInit() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectYInit()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->yInit);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_evalObjectZInit() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalObjectZInit()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		evalExpr(&so->zInit);
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectFlipInit() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectFlipInit()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->flipInit = _g->_objectScript.fetchNextWord();
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+}
+
+void ReferenceInterpreter::oop_setObjectCel() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setObjectCel()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->motionNum = _g->_objectScript.fetchNextWord() - 1;
+		so->motionFrameNum = _g->_objectScript.fetchNextWord() - 1;
+	} else {
+		_g->_objectScript.dataOffset += 4;
+	}
+}
+
+void ReferenceInterpreter::oop_resetObjectCel() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_resetObjectCel()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		so->motionNum = _g->_objectScript.fetchNextWord() - 1;
+		so->motionFrameNum = 0;
+	} else {
+		_g->_objectScript.dataOffset += 2;
+	}
+}
+
+void ReferenceInterpreter::oop_evalVar() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalVar()");
+	int var = _g->_objectScript.fetchNextWord();
+	assert(var >= 0 && var < Game::NUM_VARS);
+	evalExpr(&_g->_varsTable[var]);
+}
+
+void ReferenceInterpreter::oop_getSceneNumberInVar() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_getSceneNumberInVar()");
+	int var = _g->_objectScript.fetchNextWord();
+	assert(var >= 0 && var < Game::NUM_VARS);
+	_g->_varsTable[var] = _g->_sceneNumber;
+}
+
+void ReferenceInterpreter::oop_disableBox() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_disableBox()");
+	int box = _g->_objectScript.fetchNextWord();
+	int index = _g->_objectScript.fetchNextWord();
+	// FIXME: workaround no box for using raft (C2_17.SCN, FLY*.SCN)
+	if (_g->_objectScript.currentObjectNum == 0 && (_g->_objectScript.statementNum == 38 || _g->_objectScript.statementNum == 39)) {
+		return;
+	}
+	_g->derefBox(box, index)->state = 0;
+}
+
+void ReferenceInterpreter::oop_enableBox() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_enableBox()");
+	int box = _g->_objectScript.fetchNextWord();
+	int index = _g->_objectScript.fetchNextWord();
+	_g->derefBox(box, index)->state = 1;
+}
+
+void ReferenceInterpreter::oop_evalBoxesXPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalBoxesXPos()");
+	for (int b = 0; b < 10; ++b) {
+		for (int i = 0; i < _g->_boxesCountTable[b]; ++i) {
+			Box *box = _g->derefBox(b, i);
+			evalExpr(&box->x1);
+			_g->_objectScript.dataOffset -= 4;
+			evalExpr(&box->x2);
+			_g->_objectScript.dataOffset -= 4;
+		}
+	}
+	_g->_objectScript.dataOffset += 4;
+}
+
+void ReferenceInterpreter::oop_evalBoxesYPos() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_evalBoxesYPos()");
+	for (int b = 0; b < 10; ++b) {
+		for (int i = 0; i < _g->_boxesCountTable[b]; ++i) {
+			Box *box = _g->derefBox(b, i);
+			evalExpr(&box->y1);
+			_g->_objectScript.dataOffset -= 4;
+			evalExpr(&box->y2);
+			_g->_objectScript.dataOffset -= 4;
+		}
+	}
+	_g->_objectScript.dataOffset += 4;
+}
+
+void ReferenceInterpreter::oop_setBoxToObject() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_setBoxToObject()");
+	int16_t var1A = _g->_objectScript.fetchNextWord();
+	int16_t var1C = _g->_objectScript.fetchNextWord();
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (so->statePrev != 0) {
+			int16_t var1E = getObjectTransformXPos(index);
+			int16_t var20 = getObjectTransformXPos(index);
+			int16_t var22 = getObjectTransformYPos(index);
+			int16_t var24 = getObjectTransformYPos(index);
+			Box *box = _g->derefBox(var1A, var1C);
+			box->x1 = MIN(var1E, var20);
+			box->x2 = MAX(var1E, var20);
+			box->y1 = MIN(var24, var22);
+			box->y2 = MAX(var24, var22);
+			return;
+		}
+	}
+	_g->_objectScript.dataOffset += 24;
+}
+
+void ReferenceInterpreter::oop_clipBoxes() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_clipBoxes()");
+	int16_t x1 = _g->_objectScript.fetchNextWord();
+	int16_t y1 = _g->_objectScript.fetchNextWord();
+	int16_t x2 = _g->_objectScript.fetchNextWord();
+	int16_t y2 = _g->_objectScript.fetchNextWord();
+	for (int b = 0; b < 10; ++b) {
+		for (int i = 0; i < _g->_boxesCountTable[b]; ++i) {
+			Box *box = _g->derefBox(b, i);
+			box->x1 = CLIP(box->x1, x1, x2);
+			box->x2 = CLIP(box->x2, x1, x2);
+			box->y1 = CLIP(box->y1, y1, y2);
+			box->y2 = CLIP(box->y2, y1, y2);
+		}
+	}
+}
+
+void ReferenceInterpreter::oop_saveObjectStatus() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_saveObjectStatus()");
+	SceneObject *so = _g->derefSceneObject(_g->_objectScript.currentObjectNum);
+	int xPrev;
+	if (so->flipPrev == 2) {
+		xPrev = so->xPrev + _g->_sceneObjectFramesTable[so->frameNumPrev].hdr.w - 1;
+	} else {
+		xPrev = so->xPrev;
+	}
+	int index = _g->_objectScript.fetchNextWord();
+	SceneObjectStatus *stat = _g->derefSceneObjectStatus(index);
+	stat->x = xPrev;
+	stat->y = so->yPrev;
+	stat->z = so->zPrev;
+	stat->motionNum = so->motionNum1 - _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstMotionIndex;
+	stat->frameNum = so->frameNumPrev - _g->_sceneObjectMotionsTable[so->motionNum1].firstFrameIndex;
+	stat->flip = so->flipPrev;
+}
+
+void ReferenceInterpreter::oop_addObjectToBag() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_addObjectToBag()");
+	int index = findObjectByName(_g->_objectScript.currentObjectNum, _g->_objectScript.testObjectNum, &_g->_objectScript.objectFound);
+	if (index != -1) {
+		SceneObject *so = _g->derefSceneObject(index);
+		if (_g->findBagObjectByName(so->name) == -1) {
+			assert(_g->_bagObjectsCount < Game::NUM_BAG_OBJECTS);
+			BagObject *bo = &_g->_bagObjectsTable[_g->_bagObjectsCount];
+			strcpy(bo->name, so->name);
+
+			SceneObjectFrame *sof = &_g->_sceneObjectFramesTable[so->frameNumPrev];
+			uint32_t size = sof->hdr.w * sof->hdr.h + 4;
+			bo->data = (uint8_t *)malloc(size);
+			if (bo->data) {
+				bo->dataSize = decodeLzss(sof->data, bo->data);
+				assert(bo->dataSize == size);
+			}
+
+			++_g->_bagObjectsCount;
+			if (_g->_bagObjectsCount != 0 && _g->_currentBagObject == -1) {
+				_g->_currentBagObject = 0;
+			}
+		}
+	}
+}
+
+void ReferenceInterpreter::oop_removeObjectFromBag() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_removeObjectFromBag()");
+	const char *name = fetchNextString();
+	int index = _g->findBagObjectByName(name);
+	if (index != -1) {
+		if (_g->_currentBagObject == index) {
+			if (_g->_bagObjectsCount >= 1) {
+				_g->_currentBagObject = 0;
+			} else {
+				_g->_currentBagObject = -1;
+			}
+		} else {
+			if (_g->_currentBagObject > index) {
+				--_g->_currentBagObject;
+			}
+		}
+		free(_g->_bagObjectsTable[index].data);
+		int count = _g->_bagObjectsCount - index - 1;
+		if (count != 0) {
+			memmove(&_g->_bagObjectsTable[index], &_g->_bagObjectsTable[index + 1], count * sizeof(BagObject));
+		}
+		--_g->_bagObjectsCount;
+	}
+}
+
+void ReferenceInterpreter::oop_playSoundLowerEqualPriority() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_playSoundLowerEqualPriority()");
+	int num = _g->_objectScript.fetchNextWord();
+	int priority = _g->_objectScript.fetchNextWord();
+	if (priority > _g->_currentPlayingSoundPriority) {
+		if (_g->win16_sndPlaySound(22) == 0) {
+			return;
+		}
+	}
+	SceneObject *so = _g->derefSceneObject(_g->_objectScript.currentObjectNum);
+	num += _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstSoundBufferIndex - 1;
+	assert(num >= 0 && num < _g->_soundBuffersCount);
+	_g->win16_sndPlaySound(3, _g->_soundBuffersTable[num].filename); // _g->win16_sndPlaySound(7, _g->_soundBuffersTable[num].buffer);
+	_g->_currentPlayingSoundPriority = priority;
+}
+
+void ReferenceInterpreter::oop_playSoundLowerPriority() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_playSoundLowerPriority()");
+	int num = _g->_objectScript.fetchNextWord();
+	int priority = _g->_objectScript.fetchNextWord();
+	if (priority >= _g->_currentPlayingSoundPriority) {
+		if (_g->win16_sndPlaySound(22) == 0) {
+			return;
+		}
+	}
+	SceneObject *so = _g->derefSceneObject(_g->_objectScript.currentObjectNum);
+	num += _g->_animationsTable[_g->_sceneObjectMotionsTable[so->motionNum1].animNum].firstSoundBufferIndex - 1;
+	assert(num >= 0 && num < _g->_soundBuffersCount);
+	_g->win16_sndPlaySound(3, _g->_soundBuffersTable[num].filename); // _g->win16_sndPlaySound(7, _g->_soundBuffersTable[num].buffer);
+	_g->_currentPlayingSoundPriority = priority;
+}
+
+void ReferenceInterpreter::oop_startDialogue() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_startDialogue()");
+	_g->_scriptDialogId = fetchNextString();
+	_g->_scriptDialogFileName = fetchNextString();
+	_g->_scriptDialogSprite1 = fetchNextString();
+	_g->_scriptDialogSprite2 = fetchNextString();
+	_g->_startDialogue = true;
+}
+
+void ReferenceInterpreter::oop_switchSceneClearBoxes() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_switchSceneClearBoxes()");
+	bool foundScene = false;
+	int num = _g->_objectScript.fetchNextWord();
+	for (int i = 0; i < _g->_sceneConditionsCount; ++i) {
+		if (_g->_nextScenesTable[i].num == num) {
+			_g->_objectScript.nextScene = i;
+			foundScene = true;
+			break;
+		}
+	}
+	if (foundScene) {
+		for (int i = 0; i < 10; ++i) {
+			_g->_boxesCountTable[10 + i]  = 0;
+		}
+	}
+}
+
+void ReferenceInterpreter::oop_switchSceneCopyBoxes() {
+	debug(DBG_OPCODES, "ReferenceInterpreter::oop_switchSceneCopyBoxes()");
+	bool foundScene = false;
+	int num = _g->_objectScript.fetchNextWord();
+	for (int i = 0; i < _g->_sceneConditionsCount; ++i) {
+		if (_g->_nextScenesTable[i].num == num) {
+			_g->_objectScript.nextScene = i;
+			foundScene = true;
+			break;
+		}
+	}
+	if (foundScene) {
+		for (int i = 0; i < 10; ++i) {
+			_g->_boxesCountTable[10 + i] = _g->_boxesCountTable[i];
+			if (_g->_boxesCountTable[i] != 0) {
+				memcpy(&_g->_boxesTable[10 + i][0], &_g->_boxesTable[i][0], sizeof(Box) * _g->_boxesCountTable[i]);
+			}
+		}
+	}
+}
+
+// as the inner loop of Game::runObjectsScript, returns true if the script was stopped
+bool ReferenceInterpreter::run(int endOfDataOffset) {
+	Script *s = &_g->_objectScript;
+	s->dataOffset = 0;
+	int statement = 0;
+	while (s->dataOffset < endOfDataOffset) {
+		s->statementNum = statement;
+		int endOfStatementDataOffset = s->fetchNextWord();
+		s->testObjectNum = -1;
+		s->testDataOffset = endOfStatementDataOffset;
+		bool loop = true;
+		while (loop) {
+			int op = s->fetchNextWord();
+			if (op == 0) {
+				break;
+			}
+			loop = executeConditionOpcode(op);
+		}
+		if (loop) {
+			while (s->dataOffset < endOfStatementDataOffset) {
+				int op = s->fetchNextWord();
+				if (op == 100) { // &Game::oop_breakObjectScript
+					return true;
+				}
+				executeOperatorOpcode(op);
+			}
+		}
+		s->dataOffset = endOfStatementDataOffset;
+		++statement;
+	}
+	return false;
+}
+
+bool runReferenceObjectScript(Game *g, int size) {
+	ReferenceInterpreter ri(g);
+	return ri.run(size);
+}
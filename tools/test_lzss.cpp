@@ -0,0 +1,301 @@
+#include "../decoder.h"
+
+// compares decodeLzss with the bit by bit decodeLzssReference on generated streams
+
+enum {
+	kBlockSize = 0x1000,
+	kMaxBlocks = 64,
+	kMaxOutputSize = 512 * 1024,
+	kGuardSize = 64
+};
+
+static void writeUint32LE(uint8_t *p, uint32_t n) {
+	p[0] = n & 255;
+	p[1] = (n >> 8) & 255;
+	p[2] = (n >> 16) & 255;
+	p[3] = n >> 24;
+}
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+// writes the streams as read by the decoders : the control words are interleaved
+// with the bytes and the next one is reserved once the 16 bits of the current are used
+struct LzssEncoder {
+	uint8_t _data[8 + kMaxBlocks * kBlockSize];
+	uint8_t _output[kMaxOutputSize];
+	int _outputSize;
+	int _blocksCount;
+	int _blockStart;
+	int _pos;
+	int _slot;
+	int _bitsCount;
+
+	void reset() {
+		memset(_data, 0, sizeof(_data));
+		_outputSize = 0;
+		_blocksCount = 0;
+		startBlock();
+	}
+
+	void startBlock() {
+		_blockStart = 8 + _blocksCount * kBlockSize;
+		++_blocksCount;
+		_pos = _blockStart + 2;
+		reserveControlWord();
+	}
+
+	void endBlock() {
+		uint16_t sum = 0;
+		const uint8_t *p = _data + _blockStart + 2;
+		for (int i = 0; i < 256 * 8 - 1; ++i) {
+			sum = ((sum & 1) << 15) | (sum >> 1);
+			sum ^= READ_LE_UINT16(p); p += 2;
+		}
+		_data[_blockStart] = sum & 255;
+		_data[_blockStart + 1] = sum >> 8;
+	}
+
+	void reserveControlWord() {
+		_slot = _pos;
+		_pos += 2;
+		_bitsCount = 0;
+	}
+
+	void putBit(int bit) {
+		if (bit) {
+			_data[_slot + (_bitsCount >> 3)] |= 1 << (_bitsCount & 7);
+		}
+		++_bitsCount;
+		if (_bitsCount == 16) {
+			reserveControlWord();
+		}
+	}
+
+	void putByte(int b) {
+		_data[_pos++] = b;
+	}
+
+	void putWord(int w) {
+		putByte(w & 255);
+		putByte(w >> 8);
+	}
+
+	bool hasRoom(int size) const {
+		return _outputSize + size <= kMaxOutputSize && _blocksCount < kMaxBlocks;
+	}
+
+	void checkBlockRoom() {
+		// a command is at most 3 bytes and 2 control words, the block end marker the same
+		if (_pos - _blockStart > kBlockSize - 16) {
+			putCode(2);
+			endBlock();
+			startBlock();
+		}
+	}
+
+	void putCode(int code) {
+		putBit(0);
+		putBit(1);
+		putWord(0);
+		putByte(code);
+	}
+
+	void putLiteral(int b) {
+		checkBlockRoom();
+		putBit(1);
+		putByte(b);
+		_output[_outputSize++] = b;
+	}
+
+	void putNop() {
+		checkBlockRoom();
+		putCode(1);
+	}
+
+	// distance in [1,256], size in [2,5]
+	void putShortMatch(int distance, int size) {
+		checkBlockRoom();
+		putBit(0);
+		putBit(0);
+		putBit(((size - 2) >> 1) & 1);
+		putBit((size - 2) & 1);
+		putByte(256 - distance);
+		copyMatch(distance, size);
+	}
+
+	// distance in [1,0x2000], size in [3,256]
+	void putLongMatch(int distance, int size) {
+		checkBlockRoom();
+		putBit(0);
+		putBit(1);
+		const int offset = 0x2000 - distance;
+		int code = ((offset & 0x1F00) << 3) | (offset & 0xFF);
+		if (size <= 9 && (size < 4 || getRandomNumber(2))) {
+			putWord(code | ((size - 2) << 8));
+		} else {
+			putWord(code);
+			putByte(size - 1);
+		}
+		copyMatch(distance, size);
+	}
+
+	void copyMatch(int distance, int size) {
+		for (int i = 0; i < size; ++i) {
+			_output[_outputSize] = _output[_outputSize - distance];
+			++_outputSize;
+		}
+	}
+
+	int finish() {
+		putCode(0);
+		endBlock();
+		writeUint32LE(_data, _outputSize);
+		writeUint32LE(_data + 4, _blocksCount * 256);
+		return _outputSize;
+	}
+};
+
+static LzssEncoder _encoder;
+static uint8_t _referenceBuffer[kMaxOutputSize + kGuardSize];
+static uint8_t _decodeBuffer[kMaxOutputSize + kGuardSize];
+
+static void generateRandom(LzssEncoder *e, int commandsCount) {
+	for (int i = 0; i < commandsCount && e->hasRoom(256); ++i) {
+		const int pos = e->_outputSize;
+		switch (getRandomNumber(8)) {
+		case 0:
+			e->putNop();
+			break;
+		case 1:
+		case 2: {
+				// runs of literals crossing the control words
+				const int count = 1 + getRandomNumber(40);
+				for (int j = 0; j < count; ++j) {
+					e->putLiteral(getRandomNumber(256));
+				}
+			}
+			break;
+		case 3:
+			if (pos != 0) {
+				e->putShortMatch(1 + getRandomNumber(MIN(pos, 256)), 2 + getRandomNumber(4));
+			}
+			break;
+		case 4:
+			if (pos != 0) {
+				e->putLongMatch(1 + getRandomNumber(MIN(pos, 0x2000)), 3 + getRandomNumber(254));
+			}
+			break;
+		case 5:
+			// overlapping match
+			if (pos != 0) {
+				const int distance = 1 + getRandomNumber(MIN(pos, 8));
+				e->putLongMatch(distance, distance + 2 + getRandomNumber(255 - distance));
+			}
+			break;
+		case 6:
+			// repeated byte
+			if (pos != 0) {
+				e->putLongMatch(1, 3 + getRandomNumber(254));
+			}
+			break;
+		case 7:
+			if (pos != 0) {
+				e->putShortMatch(1 + getRandomNumber(MIN(pos, 4)), 5);
+			}
+			break;
+		}
+	}
+}
+
+// generates the edge case stream num, returns 0 past the last one
+static const char *generateEdgeCase(LzssEncoder *e, int num) {
+	switch (num) {
+	case 0:
+		return "empty";
+	case 1:
+		for (int i = 0; i < 16 * 100; ++i) {
+			e->putLiteral(i & 255);
+		}
+		return "literals only";
+	case 2:
+		e->putLiteral(0x55);
+		e->putLongMatch(1, 256);
+		return "repeated byte at end";
+	case 3:
+		for (int i = 0; i < 8; ++i) {
+			e->putLiteral(i);
+		}
+		e->putLongMatch(8, 256);
+		e->putShortMatch(3, 5);
+		return "overlapping matches at end";
+	case 4:
+		for (int i = 0; i < 0x2000; ++i) {
+			e->putLiteral(i * 7);
+		}
+		e->putLongMatch(0x2000, 256);
+		e->putShortMatch(256, 2);
+		return "maximum distances";
+	case 5:
+		e->putLiteral(1);
+		while (e->hasRoom(256) && e->_blocksCount < 8) {
+			e->putLongMatch(1, 256);
+		}
+		return "several blocks of matches";
+	case 6:
+		// 15 literals then a match, the match flag is the last bit of the control word
+		for (int n = 0; n < 200; ++n) {
+			for (int i = 0; i < 15; ++i) {
+				e->putLiteral(n + i);
+			}
+			e->putLongMatch(15, 3);
+			e->putNop();
+		}
+		return "control word boundaries";
+	}
+	return 0;
+}
+
+static bool check(const char *name) {
+	const int size = _encoder.finish();
+	memset(_referenceBuffer, 0xCC, sizeof(_referenceBuffer));
+	memset(_decodeBuffer, 0xCC, sizeof(_decodeBuffer));
+	const int referenceSize = decodeLzssReference(_encoder._data, _referenceBuffer);
+	const int decodeSize = decodeLzss(_encoder._data, _decodeBuffer);
+	bool ok = (referenceSize == size && decodeSize == size);
+	ok = ok && memcmp(_referenceBuffer, _encoder._output, size) == 0;
+	ok = ok && memcmp(_decodeBuffer, _referenceBuffer, size + kGuardSize) == 0;
+	if (!ok) {
+		printf("%-32s %7d bytes %3d blocks MISMATCH\n", name, size, _encoder._blocksCount);
+	}
+	return ok;
+}
+
+int main(int argc, char *argv[]) {
+	int failed = 0;
+	int count = 0;
+	for (int i = 0; ; ++i) {
+		_encoder.reset();
+		const char *name = generateEdgeCase(&_encoder, i);
+		if (!name) {
+			break;
+		}
+		failed += check(name) ? 0 : 1;
+		++count;
+	}
+	const int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+	for (int i = 0; i < iterations; ++i) {
+		_encoder.reset();
+		generateRandom(&_encoder, 1 + getRandomNumber(4000));
+		char name[32];
+		snprintf(name, sizeof(name), "random #%d", i);
+		failed += check(name) ? 0 : 1;
+		++count;
+	}
+	printf("%d/%d streams decoded identically\n", count - failed, count);
+	return failed != 0;
+}
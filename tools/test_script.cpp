@@ -0,0 +1,632 @@
+#include <sys/stat.h>
+#include "../game.h"
+#include "../systemstub.h"
+
+// runs randomly generated object scripts on random scene states with the original word
+// stream interpreter, the engine interpreter and the compiled code, and compares the
+// resulting game states
+
+enum {
+	kFramesCount = 64,
+	kMotionsCount = 40,
+	kAnimationsCount = 4,
+	kObjectsCount = 8,
+	kNextScenesCount = 4,
+	kBagObjectsCount = 3,
+	kMaxScriptSize = 4096,
+	kIterations = 20000
+};
+
+// script_reference.cpp
+extern bool runReferenceObjectScript(Game *g, int size);
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+static int getRandomRange(int min, int max) {
+	return min + getRandomNumber(max - min + 1);
+}
+
+// the operands layouts are more precise than the engine tables, to generate values the
+// opcodes can use without failing an assertion or dividing by zero :
+// 'n' object name, 'x' any word, 'k' key, 'c' motion or frame count, 'd' divisor,
+// 'f' flip, 'v' game var, 'o' object var, 'b' box type, 'B' box type and bank, 'i' box index,
+// 'S' object status, 'q' scene, 'T' transform (3 words), 'C' transform compare (7 words),
+// 'R' ordered rect, 'I' initialize operation, 's' string, 't' test, 'e' eval, 'm' mode,
+// 'P' setupObjectPos operands
+struct OpcodeLayout {
+	int num;
+	const char *operands;
+};
+
+static const OpcodeLayout _conditions[] = {
+	{    10, "" },
+	{   100, "x" },
+	{   500, "k" },
+	{   510, "k" },
+	{  1100, "x" },
+	{  2500, "n" },
+	{  3000, "nx" },
+	{  3010, "nx" },
+	{  3050, "nR" },
+	{  3100, "nC" },
+	{  3105, "nC" },
+	{  3110, "nC" },
+	{  3150, "nC" },
+	{  3300, "nf" },
+	{  3310, "nf" },
+	{  3400, "nt" },
+	{  3410, "nt" },
+	{  3500, "nt" },
+	{  3510, "nt" },
+	{  3600, "ont" },
+	{  3700, "nTTnTT" },
+	{  3710, "nTTnTT" },
+	{  4110, "ndx" },
+	{  6000, "vt" },
+	{  6500, "x" },
+	{  7000, "bnTTTT" },
+	{  7500, "bnTTTT" },
+	{  8500, "bnTTnTT" },
+	{ 10000, "s" },
+	{ 20000, "" },
+	{ 20010, "" },
+	{ 25000, "t" },
+	{ 30000, "q" },
+	{ -1, 0 }
+};
+
+// the bag object frames decoding and the sounds playback are not exercised
+static const OpcodeLayout _operators[] = {
+	{  3000, "nI" },
+	{  3100, "xxxe" },
+	{  3110, "xxxe" },
+	{  3120, "ne" },
+	{  3130, "ne" },
+	{  3200, "ne" },
+	{  3300, "nf" },
+	{  3400, "ncc" },
+	{  3410, "nccxx" },
+	{  3430, "nccxx" },
+	{  3440, "nP" },
+	{  3460, "nP" },
+	{  3480, "nP" },
+	{  3500, "nc" },
+	{  3530, "ncxx" },
+	{  3540, "nP" },
+	{  3560, "nP" },
+	{  3580, "nP" },
+	{  4000, "one" },
+	{  4100, "nxdxx" },
+	{  4200, "nxdxx" },
+	{  5000, "nm" },
+	{  5100, "nxx" },
+	{  5110, "nTT" },
+	{  5112, "ne" },
+	{  5114, "ne" },
+	{  5200, "ne" },
+	{  5300, "nf" },
+	{  5400, "ncc" },
+	{  5500, "nc" },
+	{  6000, "ve" },
+	{  6100, "v" },
+	{  7000, "Bi" },
+	{  7010, "Bi" },
+	{  7100, "e" },
+	{  7110, "e" },
+	{  7200, "BinTTTT" },
+	{  7300, "R" },
+	{  8000, "S" },
+	{ 11000, "s" },
+	{ 25000, "ssss" },
+	{ 30000, "q" },
+	{ 30010, "q" },
+	{ -1, 0 }
+};
+
+static const char *_strings[] = { "BAG0", "bag1", "BAG2", "BAG3", "DIALOG", "A" };
+
+struct ScriptWriter {
+	uint8_t _data[kMaxScriptSize];
+	int _size;
+
+	void putWord(int w) {
+		_data[_size++] = w & 255;
+		_data[_size++] = (w >> 8) & 255;
+	}
+
+	void setWord(int offset, int w) {
+		_data[offset] = w & 255;
+		_data[offset + 1] = (w >> 8) & 255;
+	}
+
+	void putString(const char *s) {
+		const int len = strlen(s) + 1;
+		putWord(len);
+		memcpy(_data + _size, s, len);
+		_size += len;
+	}
+
+	void putName() {
+		switch (getRandomNumber(4)) {
+		case 0:
+			putWord(-1);
+			break;
+		case 1:
+			putWord(0);
+			break;
+		default: {
+				// the last ones are not in the scene
+				char name[8];
+				snprintf(name, sizeof(name), "OBJ%d", getRandomNumber(kObjectsCount + 2));
+				putString(name);
+			}
+			break;
+		}
+	}
+
+	void putTransform() {
+		putWord(getRandomRange(-20, 20));
+		putWord(getRandomNumber(2) ? getRandomRange(1, 8) : -getRandomRange(1, 8));
+		putWord(getRandomRange(-20, 20));
+	}
+
+	// type1 is always 2 in the opcodes, xmin and xmax (ymin and ymax) must differ
+	void putSetupObjectPos(int num, bool operandsAsOpcodes) {
+		const int useData = (num < 3500) ? 1 : 0;
+		const int type2 = (num % 100) / 20 - 1;
+		const int count = 6 + (type2 == 2 ? 6 : 0) + 1 + useData + (type2 == 3 ? 2 : 0);
+		if (operandsAsOpcodes) {
+			// the object state is not set, the opcode does not consume these words
+			// and they are executed as the following operators
+			int remaining = count;
+			while (remaining != 0) {
+				if (remaining == 3 || (remaining > 4 && getRandomNumber(2))) {
+					putWord(7010);
+					putWord(getRandomNumber(Game::NUM_BOXES));
+					putWord(getRandomNumber(10));
+					remaining -= 3;
+				} else {
+					putWord(6100);
+					putWord(getRandomRange(1, Game::NUM_VARS - 1));
+					remaining -= 2;
+				}
+			}
+			return;
+		}
+		for (int i = 0; i < (type2 == 2 ? 2 : 1); ++i) {
+			const int a = getRandomRange(-20, 20);
+			putWord(0); putWord(1); putWord(a);
+			putWord(0); putWord(1); putWord(a + getRandomRange(1, 20));
+		}
+		putWord(getRandomRange(1, 4));
+		if (useData) {
+			putWord(getRandomRange(1, 4));
+		}
+		if (type2 == 3) {
+			putWord(getRandomRange(-20, 20));
+			putWord(getRandomRange(-20, 20));
+		}
+	}
+
+	void putOperands(int num, const char *operands, bool operandsAsOpcodes) {
+		for (; *operands; ++operands) {
+			switch (*operands) {
+			case 'n':
+				putName();
+				break;
+			case 'x':
+				putWord(getRandomRange(-40, 40));
+				break;
+			case 'k':
+				putWord(getRandomNumber(128));
+				break;
+			case 'c':
+				putWord(getRandomRange(1, 4));
+				break;
+			case 'd':
+				putWord(getRandomNumber(2) ? getRandomRange(1, 16) : -getRandomRange(1, 16));
+				break;
+			case 'f':
+				putWord(getRandomNumber(3));
+				break;
+			case 'v':
+				putWord(getRandomNumber(Game::NUM_VARS));
+				break;
+			case 'o':
+				putWord(getRandomNumber(10));
+				break;
+			case 'b':
+				putWord(getRandomNumber(10));
+				break;
+			case 'B':
+				putWord(getRandomNumber(Game::NUM_BOXES));
+				break;
+			case 'i':
+				putWord(getRandomNumber(10));
+				break;
+			case 'S':
+				putWord(getRandomNumber(Game::NUM_SCENE_OBJECT_STATUS));
+				break;
+			case 'q':
+				putWord(getRandomRange(1, kNextScenesCount + 2));
+				break;
+			case 'T':
+				putTransform();
+				break;
+			case 'C':
+				putTransform();
+				putTransform();
+				putWord(getRandomRange(-40, 80));
+				break;
+			case 'R': {
+					const int x = getRandomRange(-40, 80);
+					const int y = getRandomRange(-40, 80);
+					putWord(x);
+					putWord(y);
+					putWord(x + getRandomNumber(60));
+					putWord(y + getRandomNumber(60));
+				}
+				break;
+			case 'I':
+				// 0 copies the object bitmap, the buffers are not allocated
+				putWord(getRandomRange(1, 3));
+				break;
+			case 's':
+				putString(_strings[getRandomNumber(ARRAYSIZE(_strings))]);
+				break;
+			case 't': {
+					const int op = getRandomRange(-1, 5);
+					putWord(op);
+					if (op == -1) {
+						const int count = getRandomNumber(4);
+						putWord(count);
+						for (int i = 0; i < count; ++i) {
+							const int cmp = getRandomRange(-10, 10);
+							putWord(cmp);
+							putWord(cmp + getRandomNumber(10));
+						}
+					} else {
+						putWord(getRandomRange(-10, 10));
+					}
+				}
+				break;
+			case 'e': {
+					const int op = getRandomNumber(5);
+					putWord(op);
+					// the boxes coordinates must stay ordered
+					putWord((op >= 3) ? getRandomRange(1, 3) : getRandomRange(-10, 10));
+				}
+				break;
+			case 'm': {
+					const int mode = getRandomNumber(4);
+					putWord(mode);
+					if (mode == 2) {
+						putWord(getRandomNumber(8));
+					}
+				}
+				break;
+			case 'P':
+				putSetupObjectPos(num, operandsAsOpcodes);
+				break;
+			}
+		}
+	}
+
+	// statePrev is 0 for the current object, the object is not reinitialized
+	void generate(bool currentObjectNotSet) {
+		_size = 0;
+		const int statementsCount = getRandomRange(1, 8);
+		for (int i = 0; i < statementsCount; ++i) {
+			const int statementOffset = _size;
+			putWord(0);
+			const int conditionsCount = getRandomNumber(3);
+			for (int j = 0; j < conditionsCount; ++j) {
+				const OpcodeLayout *op = &_conditions[getRandomNumber(ARRAYSIZE(_conditions) - 1)];
+				putWord(op->num);
+				putOperands(op->num, op->operands, false);
+			}
+			putWord(0);
+			const int operatorsCount = getRandomNumber(6);
+			for (int j = 0; j < operatorsCount; ++j) {
+				const OpcodeLayout *op = &_operators[getRandomNumber(ARRAYSIZE(_operators) - 1)];
+				if (op->num == 3000 && currentObjectNotSet) {
+					continue;
+				}
+				putWord(op->num);
+				putOperands(op->num, op->operands, currentObjectNotSet);
+			}
+			if (getRandomNumber(8) == 0) {
+				putWord(100);
+			}
+			setWord(statementOffset, _size);
+		}
+	}
+};
+
+// the game state the opcodes read and write
+struct ScriptState {
+	SceneObject sceneObjectsTable[kObjectsCount];
+	int16_t varsTable[Game::NUM_VARS];
+	Box boxesTable[Game::NUM_BOXES][10];
+	int boxesCountTable[Game::NUM_BOXES];
+	SceneObjectStatus sceneObjectStatusTable[Game::NUM_SCENE_OBJECT_STATUS];
+	BagObject bagObjectsTable[kBagObjectsCount];
+	int bagObjectsCount;
+	int currentBagObject;
+	uint32_t randomSeed;
+	int nextScene;
+	bool startDialogue;
+	const char *scriptDialog[4];
+	int currentPlayingSoundPriority;
+	bool breakScript;
+
+	void save(const Game *g) {
+		memcpy(sceneObjectsTable, g->_sceneObjectsTable, sizeof(sceneObjectsTable));
+		memcpy(varsTable, g->_varsTable, sizeof(varsTable));
+		memcpy(boxesTable, g->_boxesTable, sizeof(boxesTable));
+		memcpy(boxesCountTable, g->_boxesCountTable, sizeof(boxesCountTable));
+		memcpy(sceneObjectStatusTable, g->_sceneObjectStatusTable, sizeof(sceneObjectStatusTable));
+		memcpy(bagObjectsTable, g->_bagObjectsTable, sizeof(bagObjectsTable));
+		bagObjectsCount = g->_bagObjectsCount;
+		currentBagObject = g->_currentBagObject;
+		randomSeed = g->_rnd._randomSeed;
+		nextScene = g->_objectScript.nextScene;
+		startDialogue = g->_startDialogue;
+		scriptDialog[0] = g->_scriptDialogId;
+		scriptDialog[1] = g->_scriptDialogFileName;
+		scriptDialog[2] = g->_scriptDialogSprite1;
+		scriptDialog[3] = g->_scriptDialogSprite2;
+		currentPlayingSoundPriority = g->_currentPlayingSoundPriority;
+	}
+
+	void load(Game *g) const {
+		memcpy(g->_sceneObjectsTable, sceneObjectsTable, sizeof(sceneObjectsTable));
+		memcpy(g->_varsTable, varsTable, sizeof(varsTable));
+		memcpy(g->_boxesTable, boxesTable, sizeof(boxesTable));
+		memcpy(g->_boxesCountTable, boxesCountTable, sizeof(boxesCountTable));
+		memcpy(g->_sceneObjectStatusTable, sceneObjectStatusTable, sizeof(sceneObjectStatusTable));
+		memcpy(g->_bagObjectsTable, bagObjectsTable, sizeof(bagObjectsTable));
+		g->_bagObjectsCount = bagObjectsCount;
+		g->_currentBagObject = currentBagObject;
+		g->_rnd._randomSeed = randomSeed;
+		g->_objectScript.nextScene = nextScene;
+		g->_startDialogue = startDialogue;
+		g->_scriptDialogId = scriptDialog[0];
+		g->_scriptDialogFileName = scriptDialog[1];
+		g->_scriptDialogSprite1 = scriptDialog[2];
+		g->_scriptDialogSprite2 = scriptDialog[3];
+		g->_currentPlayingSoundPriority = currentPlayingSoundPriority;
+	}
+
+	bool equals(const ScriptState &s) const {
+		return memcmp(sceneObjectsTable, s.sceneObjectsTable, sizeof(sceneObjectsTable)) == 0 &&
+			memcmp(varsTable, s.varsTable, sizeof(varsTable)) == 0 &&
+			memcmp(boxesTable, s.boxesTable, sizeof(boxesTable)) == 0 &&
+			memcmp(boxesCountTable, s.boxesCountTable, sizeof(boxesCountTable)) == 0 &&
+			memcmp(sceneObjectStatusTable, s.sceneObjectStatusTable, sizeof(sceneObjectStatusTable)) == 0 &&
+			memcmp(bagObjectsTable, s.bagObjectsTable, sizeof(bagObjectsTable)) == 0 &&
+			bagObjectsCount == s.bagObjectsCount && currentBagObject == s.currentBagObject &&
+			randomSeed == s.randomSeed && nextScene == s.nextScene && startDialogue == s.startDialogue &&
+			memcmp(scriptDialog, s.scriptDialog, sizeof(scriptDialog)) == 0 &&
+			currentPlayingSoundPriority == s.currentPlayingSoundPriority && breakScript == s.breakScript;
+	}
+};
+
+static void randomizeScene(Game *g) {
+	g->_sceneObjectFramesCount = kFramesCount;
+	for (int i = 0; i < kFramesCount; ++i) {
+		SceneObjectFrame *sof = &g->_sceneObjectFramesTable[i];
+		memset(sof, 0, sizeof(SceneObjectFrame));
+		sof->hdr.num = i;
+		sof->hdr.w = getRandomRange(1, 40);
+		sof->hdr.h = getRandomRange(1, 40);
+		sof->hdr.xPos = getRandomRange(-10, 10);
+		sof->hdr.yPos = getRandomRange(-10, 10);
+	}
+	g->_animationsCount = kAnimationsCount;
+	for (int i = 0; i < kAnimationsCount; ++i) {
+		SceneAnimation *sa = &g->_animationsTable[i];
+		memset(sa, 0, sizeof(SceneAnimation));
+		snprintf(sa->name, sizeof(sa->name), "ANIM%d", i);
+		sa->firstMotionIndex = getRandomNumber(kMotionsCount - 8);
+		sa->unk26 = getRandomNumber(4);
+	}
+	g->_sceneObjectMotionsCount = kMotionsCount;
+	for (int i = 0; i < kMotionsCount; ++i) {
+		SceneObjectMotion *som = &g->_sceneObjectMotionsTable[i];
+		som->firstFrameIndex = getRandomNumber(kFramesCount - 8);
+		som->count = 4;
+		som->animNum = getRandomNumber(kAnimationsCount);
+	}
+	g->_sceneObjectsCount = kObjectsCount;
+	for (int i = 0; i < kObjectsCount; ++i) {
+		SceneObject *so = &g->_sceneObjectsTable[i];
+		memset(so, 0, sizeof(SceneObject));
+		snprintf(so->name, sizeof(so->name), "OBJ%d", i);
+		so->xInit = getRandomRange(-40, 80);
+		so->yInit = getRandomRange(-40, 80);
+		so->x = getRandomRange(-40, 80);
+		so->y = getRandomRange(-40, 80);
+		so->xPrev = getRandomRange(-40, 80);
+		so->yPrev = getRandomRange(-40, 80);
+		so->zInit = getRandomNumber(100);
+		so->z = so->zPrev = getRandomNumber(100);
+		so->frameNum = getRandomNumber(kFramesCount);
+		so->frameNumPrev = getRandomNumber(kFramesCount);
+		so->flipInit = getRandomNumber(3);
+		so->flip = getRandomNumber(3);
+		so->flipPrev = getRandomNumber(3);
+		so->motionInit = getRandomNumber(kMotionsCount - 8);
+		so->motionNum = getRandomNumber(4);
+		so->motionNum1 = getRandomNumber(kMotionsCount);
+		so->motionNum2 = getRandomNumber(kMotionsCount);
+		so->motionFrameNum = getRandomNumber(4);
+		so->mode = getRandomNumber(4);
+		so->modeRndMul = getRandomNumber(8);
+		so->statePrev = getRandomNumber(3);
+		so->state = getRandomRange(-1, 2);
+		for (int j = 0; j < 10; ++j) {
+			so->varsTable[j] = getRandomRange(-10, 10);
+		}
+	}
+	for (int i = 0; i < Game::NUM_VARS; ++i) {
+		g->_varsTable[i] = getRandomRange(-10, 10);
+	}
+	for (int i = 0; i < Game::NUM_BOXES; ++i) {
+		g->_boxesCountTable[i] = getRandomNumber(11);
+		for (int j = 0; j < 10; ++j) {
+			Box *box = &g->_boxesTable[i][j];
+			memset(box, 0, sizeof(Box));
+			box->x1 = getRandomRange(-40, 80);
+			box->x2 = box->x1 + getRandomNumber(60);
+			box->y1 = getRandomRange(-40, 80);
+			box->y2 = box->y1 + getRandomNumber(60);
+			box->state = getRandomNumber(2);
+		}
+	}
+	memset(g->_sceneObjectStatusTable, 0, sizeof(g->_sceneObjectStatusTable));
+	g->_sceneConditionsCount = kNextScenesCount;
+	for (int i = 0; i < kNextScenesCount; ++i) {
+		g->_nextScenesTable[i].num = i + 1;
+		snprintf(g->_nextScenesTable[i].name, sizeof(g->_nextScenesTable[i].name), "SCENE%d.SCN", i + 1);
+	}
+	g->_bagObjectsCount = kBagObjectsCount;
+	for (int i = 0; i < kBagObjectsCount; ++i) {
+		BagObject *bo = &g->_bagObjectsTable[i];
+		memset(bo, 0, sizeof(BagObject));
+		snprintf(bo->name, sizeof(bo->name), "BAG%d", i);
+	}
+	g->_currentBagObject = getRandomRange(-1, kBagObjectsCount - 1);
+	for (int i = 0; i < 128; ++i) {
+		g->_keysPressed[i] = getRandomNumber(2);
+	}
+	g->_mouseButtonsPressed = getRandomNumber(4);
+	g->_currentBagAction = getRandomNumber(4);
+	g->_lifeBarDisplayed = getRandomNumber(2) != 0;
+	g->_lastDialogueEndedId = getRandomRange(-10, 10);
+	g->_dialogueEndedFlag = getRandomNumber(2);
+	g->_currentPlayingSoundPriority = getRandomNumber(4);
+	g->_startDialogue = false;
+	g->_scriptDialogId = g->_scriptDialogFileName = g->_scriptDialogSprite1 = g->_scriptDialogSprite2 = 0;
+	g->_objectScript.nextScene = -1;
+	g->_rnd.setSeed(getRandomNumber(0x10000));
+	++g->_sceneObjectsGeneration;
+}
+
+// as Game::runObjectsScript does for the scripts it cannot compile
+static bool interpretScript(Game *g, int size) {
+	g->_objectScript.code = 0;
+	g->_objectScript.dataOffset = 0;
+	int statement = 0;
+	while (g->_objectScript.dataOffset < size) {
+		g->_objectScript.statementNum = statement;
+		const int endOfStatementDataOffset = g->_objectScript.fetchNextWord();
+		g->_objectScript.testObjectNum = -1;
+		g->_objectScript.testDataOffset = endOfStatementDataOffset;
+		if (g->executeObjectScriptConditions() && !g->executeObjectScriptOperators(endOfStatementDataOffset)) {
+			return true;
+		}
+		g->_objectScript.dataOffset = endOfStatementDataOffset;
+		++statement;
+	}
+	return false;
+}
+
+static char _dataPath[64];
+
+static void createDataDirectory() {
+	// the engine looks for the startup scene and the dialogues
+	snprintf(_dataPath, sizeof(_dataPath), "/tmp/test_scriptXXXXXX");
+	if (!mkdtemp(_dataPath)) {
+		error("Unable to create data directory");
+	}
+	static const char *files[] = { "SCN/_01.SCN", "TEXT/02_0.DLG", 0 };
+	for (int i = 0; files[i]; ++i) {
+		char path[128];
+		snprintf(path, sizeof(path), "%s/%s", _dataPath, files[i]);
+		char *sep = strrchr(path, '/');
+		*sep = 0;
+		mkdir(path, 0755);
+		*sep = '/';
+		FILE *fp = fopen(path, "wb");
+		if (fp) {
+			fputs("test", fp);
+			fclose(fp);
+		}
+	}
+}
+
+static void removeDataDirectory() {
+	char cmd[128];
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", _dataPath);
+	system(cmd);
+}
+
+static ScriptWriter _writer;
+
+int main(int argc, char *argv[]) {
+	const int iterations = (argc > 1) ? atoi(argv[1]) : kIterations;
+	createDataDirectory();
+	SystemStub *stub = SystemStub_Null_create(0, 0, 0);
+	Game *g = new Game(stub, _dataPath, _dataPath, _dataPath);
+	int failed = 0;
+	int uncompiled = 0;
+	for (int n = 0; n < iterations; ++n) {
+		randomizeScene(g);
+		const int object = getRandomNumber(kObjectsCount);
+		SceneObject *so = &g->_sceneObjectsTable[object];
+		const bool notSet = getRandomNumber(5) == 0;
+		so->statePrev = notSet ? 0 : getRandomRange(1, 2);
+		_writer.generate(notSet);
+		g->_objectScript.currentObjectNum = object;
+		g->_objectScript.data = _writer._data;
+		g->_objectScript.dataSize = _writer._size;
+
+		ScriptState initial;
+		initial.save(g);
+		ScriptState reference;
+		reference.breakScript = runReferenceObjectScript(g, _writer._size);
+		reference.save(g);
+
+		initial.load(g);
+		ScriptState interpreted;
+		interpreted.breakScript = interpretScript(g, _writer._size);
+		interpreted.save(g);
+		if (!interpreted.equals(reference)) {
+			printf("#%d object %d script %d bytes interpreter MISMATCH\n", n, object, _writer._size);
+			++failed;
+			continue;
+		}
+
+		initial.load(g);
+		g->_sceneArena.clear();
+		ObjectScriptCode *code = g->compileObjectScript(_writer._data, _writer._size);
+		if (!code) {
+			++uncompiled;
+			continue;
+		}
+		g->resolveObjectScriptNames(code, _writer._data);
+		g->_objectScript.code = code;
+		ScriptState compiled;
+		compiled.breakScript = false;
+		for (int i = 0; i < code->statementsCount; ++i) {
+			if (!g->executeObjectScriptStatement(code, i)) {
+				compiled.breakScript = true;
+				break;
+			}
+		}
+		compiled.save(g);
+		if (!compiled.equals(reference)) {
+			printf("#%d object %d script %d bytes compiled MISMATCH\n", n, object, _writer._size);
+			++failed;
+		}
+	}
+	printf("%d/%d scripts executed identically, %d not compiled\n", iterations - failed - uncompiled, iterations, uncompiled);
+	removeDataDirectory();
+	return (failed != 0 || uncompiled != 0);
+}
@@ -0,0 +1,99 @@
+#include "../compositor.h"
+
+// compares drawObjectSpans with the per pixel drawObject and drawObjectVerticalFlip
+// on random sprites and positions, clipped on every side of the destination bitmap
+
+enum {
+	kW = 96,
+	kH = 64,
+	kMaxSpriteW = 160,
+	kMaxSpriteH = 100,
+	kGuardSize = 64,
+	kIterations = 20000
+};
+
+static uint8_t _spriteBuffer[4 + kMaxSpriteW * kMaxSpriteH];
+static uint16_t _spansBuffer[kMaxSpriteH + kMaxSpriteW * kMaxSpriteH];
+static uint8_t _depthMask[kW * kH];
+static uint8_t _referenceBuffer[kW * kH + kGuardSize];
+static uint8_t _spansDrawBuffer[kW * kH + kGuardSize];
+
+static uint32_t _randomSeed = 0x1234;
+
+static int getRandomNumber(int count) {
+	_randomSeed = _randomSeed * 1103515245 + 12345;
+	return (_randomSeed >> 16) % count;
+}
+
+static void generateSprite(int w, int h) {
+	_spriteBuffer[0] = (w - 1) & 255;
+	_spriteBuffer[1] = (w - 1) >> 8;
+	_spriteBuffer[2] = (h - 1) & 255;
+	_spriteBuffer[3] = (h - 1) >> 8;
+	uint8_t *p = _spriteBuffer + 4;
+	const int density = getRandomNumber(4);
+	for (int i = 0; i < w * h; ++i) {
+		switch (density) {
+		case 0: // opaque
+			p[i] = 1 + getRandomNumber(255);
+			break;
+		case 1: // transparent
+			p[i] = 0;
+			break;
+		default: // runs
+			p[i] = (getRandomNumber(density * 3) == 0) ? 0 : 1 + getRandomNumber(255);
+			break;
+		}
+	}
+}
+
+static void generateDepthMask() {
+	for (int i = 0; i < kW * kH; ++i) {
+		_depthMask[i] = getRandomNumber(5);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	const int iterations = (argc > 1) ? atoi(argv[1]) : kIterations;
+	int failed = 0;
+	for (int n = 0; n < iterations; ++n) {
+		const int w = 1 + getRandomNumber(kMaxSpriteW);
+		const int h = 1 + getRandomNumber(kMaxSpriteH);
+		generateSprite(w, h);
+		const int spansSize = encodeObjectSpans(_spriteBuffer, 0);
+		assert(spansSize <= (int)ARRAYSIZE(_spansBuffer));
+		encodeObjectSpans(_spriteBuffer, _spansBuffer);
+
+		// destination smaller than the pitch, positions around all the edges
+		const int dstW = 1 + getRandomNumber(kW);
+		const int dstH = 1 + getRandomNumber(kH);
+		const int x = getRandomNumber(dstW + 2 * w + 2) - w - 1;
+		const int y = getRandomNumber(dstH + 2 * h + 2) - h - 1;
+		const bool flip = getRandomNumber(2) != 0;
+		const bool masked = getRandomNumber(2) != 0;
+		const int depthLevel = getRandomNumber(5);
+		if (masked) {
+			generateDepthMask();
+		}
+
+		for (int i = 0; i < kW * kH + kGuardSize; ++i) {
+			_referenceBuffer[i] = _spansDrawBuffer[i] = i * 7;
+		}
+		SceneBitmap reference = { (uint16_t)(dstW - 1), (uint16_t)(dstH - 1), kW, _referenceBuffer };
+		SceneBitmap spansDraw = { (uint16_t)(dstW - 1), (uint16_t)(dstH - 1), kW, _spansDrawBuffer };
+		const uint8_t *depthMask = masked ? _depthMask : 0;
+		if (flip) {
+			drawObjectVerticalFlip(x, y, _spriteBuffer, &reference, depthMask, depthLevel);
+		} else {
+			drawObject(x, y, _spriteBuffer, &reference, depthMask, depthLevel);
+		}
+		drawObjectSpans(x, y, _spriteBuffer, _spansBuffer, &spansDraw, flip, depthMask, depthLevel);
+
+		if (memcmp(_referenceBuffer, _spansDrawBuffer, sizeof(_referenceBuffer)) != 0) {
+			printf("#%d sprite %dx%d at %d,%d in %dx%d flip %d mask %d level %d MISMATCH\n", n, w, h, x, y, dstW, dstH, flip, masked, depthLevel);
+			++failed;
+		}
+	}
+	printf("%d/%d sprites drawn identically\n", iterations - failed, iterations);
+	return failed != 0;
+}
@@ -18,9 +18,13 @@ int Game::win16_sndPlaySound(int op, void *data) {
 		break;
 	case 3: {
 			const char *fileName = (const char *)data;
+			if (_mixer->playCachedSound(fileName, &_mixerSoundId)) {
+				break;
+			}
 			File *f = _fs.openFile(fileName, false);
 			if (f) {
-				_mixer->playSound(f, &_mixerSoundId);
+				// keep the scene sounds decoded, the dialogue speech files are played once
+				_mixer->playSound(f, &_mixerSoundId, isSceneSoundBuffer(fileName) ? fileName : 0);
 				_fs.closeFile(f);
 			} else {
 				warning("Unable to open wav file '%s'", fileName);
@@ -38,6 +42,15 @@ int Game::win16_sndPlaySound(int op, void *data) {
 	return 0;
 }
 
+bool Game::isSceneSoundBuffer(const char *fileName) const {
+	for (int i = 0; i < _soundBuffersCount; ++i) {
+		if (strcmp(_soundBuffersTable[i].filename, fileName) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void Game::win16_stretchBits(SceneBitmap *bits, int srcHeight, int srcWidth, int srcY, int srcX, int dstHeight, int dstWidth, int dstY, int dstX) {
 	debug(DBG_WIN16, "win16_stretchBits() %d,%d %d,%d", srcX, srcY, srcWidth, srcHeight);
 	assert(srcWidth == dstWidth && srcHeight == dstHeight);